@@ -14,7 +14,7 @@
 
 #include "BLE2902.h"
 
-BLE2902::BLE2902() : BLEDescriptor(BLEUUID((uint16_t) 0x2902)) {
+BLE2902::BLE2902() : BLEDescriptor(BLEUUID((uint16_t) 0x2902), 2) {
 	uint8_t data[2] = { 0, 0 };
 	setValue(data, 2);
 } // BLE2902
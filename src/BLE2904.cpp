@@ -15,7 +15,7 @@
 #include "BLE2904.h"
 
 
-BLE2904::BLE2904() : BLEDescriptor(BLEUUID((uint16_t) 0x2904)) {
+BLE2904::BLE2904() : BLEDescriptor(BLEUUID((uint16_t) 0x2904), sizeof(BLE2904_Data)) {
 	m_data.m_format      = 0;
 	m_data.m_exponent    = 0;
 	m_data.m_namespace   = 1;  // 1 = Bluetooth SIG Assigned Numbers
@@ -9,10 +9,7 @@
 
 #include "BLEAddress.h"
 #include <string>
-#include <sstream>
-#include <iomanip>
 #include <string.h>
-#include <stdio.h>
 #ifdef ARDUINO_ARCH_ESP32
 #include "esp32-hal-log.h"
 #endif
@@ -34,21 +31,22 @@ BLEAddress::BLEAddress(esp_bd_addr_t address) {
  * ```
  * 00:00:00:00:00:00
  * ```
- * which is 17 characters in length.
+ * which is 17 characters in length.  An invalid string gives the address 00:00:00:00:00:00.
  *
  * @param [in] stringAddress The hex representation of the address.
  */
-BLEAddress::BLEAddress(std::string stringAddress) {
-	if (stringAddress.length() != 17) return;
-
-	int data[6];
-	sscanf(stringAddress.c_str(), "%x:%x:%x:%x:%x:%x", &data[0], &data[1], &data[2], &data[3], &data[4], &data[5]);
-	m_address[0] = (uint8_t) data[0];
-	m_address[1] = (uint8_t) data[1];
-	m_address[2] = (uint8_t) data[2];
-	m_address[3] = (uint8_t) data[3];
-	m_address[4] = (uint8_t) data[4];
-	m_address[5] = (uint8_t) data[5];
+BLEAddress::BLEAddress(std::string stringAddress) : BLEAddress(stringAddress.c_str()) {
+} // BLEAddress
+
+
+/**
+ * @brief Create an address from a NUL terminated hex string, see BLEAddress(std::string).
+ * @param [in] stringAddress The hex representation of the address.
+ */
+BLEAddress::BLEAddress(const char* stringAddress) {
+	if (!parse(stringAddress, this)) {
+		memset(m_address, 0, ESP_BD_ADDR_LEN);
+	}
 } // BLEAddress
 
 
@@ -57,8 +55,8 @@ BLEAddress::BLEAddress(std::string stringAddress) {
  * @param [in] otherAddress The other address to compare against.
  * @return True if the addresses are equal.
  */
-bool BLEAddress::equals(BLEAddress otherAddress) {
-	return memcmp(otherAddress.getNative(), m_address, 6) == 0;
+bool BLEAddress::equals(const BLEAddress& otherAddress) const {
+	return *this == otherAddress;
 } // equals
 
 
@@ -71,6 +69,40 @@ esp_bd_addr_t *BLEAddress::getNative() {
 } // getNative
 
 
+/**
+ * @brief Value of a hex digit.
+ * @return 0 to 15 or -1 if the character is not a hex digit.
+ */
+static int hexValue(char c) {
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+} // hexValue
+
+
+/**
+ * @brief Parse an address of the form xx:xx:xx:xx:xx:xx.
+ * @param [in] stringAddress The NUL terminated string, upper or lower case hex.
+ * @param [out] pAddress Receives the address; unchanged if the string is not valid.
+ * @return True if the string is a valid address.
+ */
+/* STATIC */ bool BLEAddress::parse(const char* stringAddress, BLEAddress* pAddress) {
+	if (stringAddress == nullptr) return false;
+	uint8_t address[ESP_BD_ADDR_LEN];
+	for (int i = 0; i < ESP_BD_ADDR_LEN; i++) {
+		const char* p = stringAddress + i * 3;
+		int high = hexValue(p[0]);
+		int low  = high < 0 ? -1 : hexValue(p[1]);
+		if (low < 0) return false;
+		if (p[2] != (i < ESP_BD_ADDR_LEN - 1 ? ':' : 0)) return false;
+		address[i] = (high << 4) | low;
+	}
+	memcpy(pAddress->m_address, address, ESP_BD_ADDR_LEN);
+	return true;
+} // parse
+
+
 /**
  * @brief Convert a BLE address to a string.
  *
@@ -83,13 +115,25 @@ esp_bd_addr_t *BLEAddress::getNative() {
  * @return The string representation of the address.
  */
 std::string BLEAddress::toString() {
-	std::stringstream stream;
-	stream << std::setfill('0') << std::setw(2) << std::hex << (int) ((uint8_t*) (m_address))[0] << ':';
-	stream << std::setfill('0') << std::setw(2) << std::hex << (int) ((uint8_t*) (m_address))[1] << ':';
-	stream << std::setfill('0') << std::setw(2) << std::hex << (int) ((uint8_t*) (m_address))[2] << ':';
-	stream << std::setfill('0') << std::setw(2) << std::hex << (int) ((uint8_t*) (m_address))[3] << ':';
-	stream << std::setfill('0') << std::setw(2) << std::hex << (int) ((uint8_t*) (m_address))[4] << ':';
-	stream << std::setfill('0') << std::setw(2) << std::hex << (int) ((uint8_t*) (m_address))[5];
-	return stream.str();
+	char buffer[BLE_ADDRESS_STRING_LENGTH];
+	return std::string(toString(buffer), BLE_ADDRESS_STRING_LENGTH - 1);
+} // toString
+
+
+/**
+ * @brief Format the address into a caller supplied buffer, see toString().
+ * @param [out] pBuffer A buffer of at least BLE_ADDRESS_STRING_LENGTH (18) bytes.
+ * @return pBuffer.
+ */
+char* BLEAddress::toString(char* pBuffer) const {
+	static const char hexDigits[] = "0123456789abcdef";
+	char* p = pBuffer;
+	for (int i = 0; i < ESP_BD_ADDR_LEN; i++) {
+		*p++ = hexDigits[m_address[i] >> 4];
+		*p++ = hexDigits[m_address[i] & 0x0f];
+		*p++ = ':';
+	}
+	p[-1] = 0;
+	return pBuffer;
 } // toString
 #endif
@@ -11,24 +11,58 @@
 #if defined(CONFIG_BT_ENABLED)
 #include <esp_gap_ble_api.h> // ESP32 BLE
 #include <string>
+#include <functional>
 
+#define BLE_ADDRESS_STRING_LENGTH 18   // "xx:xx:xx:xx:xx:xx" + NUL.
 
 /**
  * @brief A %BLE device address.
  *
  * Every %BLE device has a unique address which can be used to identify it and form connections.
+ * The six bytes are held inline.  Addresses compare, order and hash as the 48 bit integer of
+ * toUint64(), so they can key std::map and std::unordered_map directly.  The order is the same as
+ * that of the strings returned by toString().
  */
 class BLEAddress {
 public:
 	BLEAddress(esp_bd_addr_t address);
 	BLEAddress(std::string stringAddress);
-	bool           equals(BLEAddress otherAddress);
+	BLEAddress(const char* stringAddress);
+	explicit constexpr BLEAddress(uint64_t address) : m_address{
+		(uint8_t) (address >> 40), (uint8_t) (address >> 32), (uint8_t) (address >> 24),
+		(uint8_t) (address >> 16), (uint8_t) (address >> 8), (uint8_t) address } {}
+	bool           equals(const BLEAddress& otherAddress) const;
 	esp_bd_addr_t* getNative();
 	std::string    toString();
+	char*          toString(char* pBuffer) const;
+	static bool    parse(const char* stringAddress, BLEAddress* pAddress);
+
+	constexpr uint64_t toUint64() const {
+		return ((uint64_t) m_address[0] << 40) | ((uint64_t) m_address[1] << 32) | ((uint64_t) m_address[2] << 24) |
+			((uint64_t) m_address[3] << 16) | ((uint64_t) m_address[4] << 8) | (uint64_t) m_address[5];
+	}
+	constexpr bool operator==(const BLEAddress& other) const {
+		return toUint64() == other.toUint64();
+	}
+	constexpr bool operator!=(const BLEAddress& other) const {
+		return toUint64() != other.toUint64();
+	}
+	constexpr bool operator<(const BLEAddress& other) const {
+		return toUint64() < other.toUint64();
+	}
 
 private:
 	esp_bd_addr_t m_address;
 };
 
+namespace std {
+template<> struct hash<BLEAddress> {
+	size_t operator()(const BLEAddress& address) const {
+		uint64_t value = address.toUint64();
+		return (size_t) (value ^ (value >> 32));
+	}
+};
+} // namespace std
+
 #endif /* CONFIG_BT_ENABLED */
 #endif /* COMPONENTS_CPP_UTILS_BLEADDRESS_H_ */
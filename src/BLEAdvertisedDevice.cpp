@@ -248,10 +248,9 @@ void BLEAdvertisedDevice::parseAdvertisement(uint8_t* payload, size_t total_len)
 			payload++;
 			length--;
 
-			char* pHex = BLEUtils::buildHexData(nullptr, payload, length);
+			char hex[BLE_HEX_LOG_MAX * 2 + 1];
 			ESP_LOGD(LOG_TAG, "Type: 0x%.2x (%s), length: %d, data: %s",
-					ad_type, BLEUtils::advTypeToString(ad_type), length, pHex);
-			free(pHex);
+					ad_type, BLEUtils::advTypeToString(ad_type), length, BLEUtils::buildHexData(hex, sizeof(hex), payload, length));
 
 			switch(ad_type) {
 				case ESP_BLE_AD_TYPE_NAME_CMPL: {   // Adv Data Type: 0x09
@@ -397,9 +396,9 @@ void BLEAdvertisedDevice::setAppearance(uint16_t appearance) {
 void BLEAdvertisedDevice::setManufacturerData(std::string manufacturerData) {
 	m_manufacturerData     = manufacturerData;
 	m_haveManufacturerData = true;
-	char* pHex = BLEUtils::buildHexData(nullptr, (uint8_t*) m_manufacturerData.data(), (uint8_t) m_manufacturerData.length());
-	ESP_LOGD(LOG_TAG, "- manufacturer data: %s", pHex);
-	free(pHex);
+	char hex[BLE_HEX_LOG_MAX * 2 + 1];
+	ESP_LOGD(LOG_TAG, "- manufacturer data: %s",
+		BLEUtils::buildHexData(hex, sizeof(hex), (const uint8_t*) m_manufacturerData.data(), m_manufacturerData.length()));
 } // setManufacturerData
 
 
@@ -496,9 +495,9 @@ std::string BLEAdvertisedDevice::toString() {
 		ss << ", appearance: " << getAppearance();
 	}
 	if (haveManufacturerData()) {
-		char *pHex = BLEUtils::buildHexData(nullptr, (uint8_t*)getManufacturerData().data(), getManufacturerData().length());
-		ss << ", manufacturer data: " << pHex;
-		free(pHex);
+		char hex[BLE_HEX_LOG_MAX * 2 + 1];
+		ss << ", manufacturer data: " <<
+			BLEUtils::buildHexData(hex, sizeof(hex), (const uint8_t*) m_manufacturerData.data(), m_manufacturerData.length());
 	}
 	if (haveServiceUUID()) {
 		ss << ", serviceUUID: " << getServiceUUID().toString();
@@ -22,6 +22,8 @@
 #include <esp_err.h>
 #include "BLEUtils.h"
 #include "GeneralUtils.h"
+#include "BLEDevice.h"
+#include <esp_timer.h>
 
 #if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_ARDUHAL_ESP_LOG)
 #include "esp32-hal-log.h"
@@ -67,10 +69,15 @@ BLEAdvertising::BLEAdvertising() {
 
 /**
  * @brief Add a service uuid to exposed list of services.
+ *
+ * Services are placed in the advertisement in the order they were added so the first service added has
+ * the highest priority.  Services that do not fit in the advertisement move to the scan response.
+ *
  * @param [in] serviceUUID The UUID of the service to expose.
  */
 void BLEAdvertising::addServiceUUID(BLEUUID serviceUUID) {
 	m_serviceUUIDs.push_back(serviceUUID);
+	m_configDirty = true;
 } // addServiceUUID
 
 
@@ -83,6 +90,15 @@ void BLEAdvertising::addServiceUUID(const char* serviceUUID) {
 } // addServiceUUID
 
 
+/**
+ * @brief Get the services that did not fit in the advertisement or the scan response at the last start().
+ * @return The services that are not being advertised.
+ */
+std::vector<BLEUUID> BLEAdvertising::getUnplacedServiceUUIDs() {
+	return m_unplacedServiceUUIDs;
+} // getUnplacedServiceUUIDs
+
+
 /**
  * @brief Set the device appearance in the advertising data.
  * The appearance attribute is of type 0x19.  The codes for distinct appearances can be found here:
@@ -92,6 +108,7 @@ void BLEAdvertising::addServiceUUID(const char* serviceUUID) {
  */
 void BLEAdvertising::setAppearance(uint16_t appearance) {
 	m_advData.appearance = appearance;
+	m_configDirty = true;
 } // setAppearance
 
 void BLEAdvertising::setMinInterval(uint16_t mininterval) {
@@ -104,14 +121,17 @@ void BLEAdvertising::setMaxInterval(uint16_t maxinterval) {
 
 void BLEAdvertising::setMinPreferred(uint16_t mininterval) {
 	m_advData.min_interval = mininterval;
+	m_configDirty = true;
 } // 
 
 void BLEAdvertising::setMaxPreferred(uint16_t maxinterval) {
 	m_advData.max_interval = maxinterval;
+	m_configDirty = true;
 } // 
 
 void BLEAdvertising::setScanResponse(bool set) {
 	m_scanResp = set;
+	m_configDirty = true;
 }
 
 /**
@@ -149,12 +169,50 @@ void BLEAdvertising::setScanFilter(bool scanRequestWhitelistOnly, bool connectWh
  * @param [in] advertisementData The data to be advertised.
  */
 void BLEAdvertising::setAdvertisementData(BLEAdvertisementData& advertisementData) {
-	ESP_LOGD(LOG_TAG, ">> setAdvertisementData");
-	esp_err_t errRc = ::esp_ble_gap_config_adv_data_raw(
-		(uint8_t*)advertisementData.getPayload().data(),
-		advertisementData.getPayload().length());
-	if (errRc != ESP_OK) {
-		ESP_LOGE(LOG_TAG, "esp_ble_gap_config_adv_data_raw: %d %s", errRc, GeneralUtils::errorToString(errRc));
+	setAdvertisementData((const uint8_t*) advertisementData.m_payload.data(), advertisementData.m_payload.length());
+} // setAdvertisementData
+
+
+/**
+ * @brief Set the advertisement data from a fixed buffer payload.
+ * @param [in] payload The payload to be advertised.  It is copied, so it may be discarded on return.
+ */
+void BLEAdvertising::setAdvertisementData(const BLEAdvertisementPayload& payload) {
+	if (payload.hasOverflowed()) {
+		ESP_LOGW(LOG_TAG, "setAdvertisementData: payload dropped %d bytes of fields that did not fit", payload.getOverflow());
+	}
+	setAdvertisementData(payload.getData(), payload.getLength());
+} // setAdvertisementData
+
+
+/**
+ * @brief Set the advertisement data from a raw encoded payload.
+ *
+ * The data is copied before the call returns so the buffer may live anywhere, including in flash as
+ * produced by BLEStaticAdvertisement.  It is handed to the ESP-IDF at once, or when a start sequence in
+ * flight completes so that the data it is setting is not replaced underneath it.
+ *
+ * @param [in] pData The encoded advertisement payload.
+ * @param [in] length The length of the payload; at most 31 bytes.
+ */
+void BLEAdvertising::setAdvertisementData(const uint8_t* pData, size_t length) {
+	ESP_LOGD(LOG_TAG, ">> setAdvertisementData: length: %d", length);
+	if (length > ESP_BLE_ADV_DATA_LEN_MAX) {
+		ESP_LOGE(LOG_TAG, "setAdvertisementData: payload of %d bytes exceeds %d", length, ESP_BLE_ADV_DATA_LEN_MAX);
+		return;
+	}
+	portENTER_CRITICAL(&m_payloadMux);
+	m_advPayload.clear();
+	m_advPayload.addRaw(pData, length);
+	m_pendingUpdate |= UPDATE_ADV;
+	portEXIT_CRITICAL(&m_payloadMux);
+	portENTER_CRITICAL(&m_startMux);
+	bool starting = isStarting();
+	portEXIT_CRITICAL(&m_startMux);
+	if (starting) {
+		ESP_LOGD(LOG_TAG, "setAdvertisementData: sent once the start sequence completes");
+	} else {
+		sendPayloads(UPDATE_ADV);
 	}
 	m_customAdvData = true;   // Set the flag that indicates we are using custom advertising data.
 	ESP_LOGD(LOG_TAG, "<< setAdvertisementData");
@@ -166,101 +224,632 @@ void BLEAdvertising::setAdvertisementData(BLEAdvertisementData& advertisementDat
  * @param [in] advertisementData The data to be advertised.
  */
 void BLEAdvertising::setScanResponseData(BLEAdvertisementData& advertisementData) {
-	ESP_LOGD(LOG_TAG, ">> setScanResponseData");
-	esp_err_t errRc = ::esp_ble_gap_config_scan_rsp_data_raw(
-		(uint8_t*)advertisementData.getPayload().data(),
-		advertisementData.getPayload().length());
-	if (errRc != ESP_OK) {
-		ESP_LOGE(LOG_TAG, "esp_ble_gap_config_scan_rsp_data_raw: %d %s", errRc, GeneralUtils::errorToString(errRc));
+	setScanResponseData((const uint8_t*) advertisementData.m_payload.data(), advertisementData.m_payload.length());
+} // setScanResponseData
+
+
+/**
+ * @brief Set the scan response data from a fixed buffer payload.
+ * @param [in] payload The payload to be published.  It is copied, so it may be discarded on return.
+ */
+void BLEAdvertising::setScanResponseData(const BLEAdvertisementPayload& payload) {
+	if (payload.hasOverflowed()) {
+		ESP_LOGW(LOG_TAG, "setScanResponseData: payload dropped %d bytes of fields that did not fit", payload.getOverflow());
+	}
+	setScanResponseData(payload.getData(), payload.getLength());
+} // setScanResponseData
+
+
+/**
+ * @brief Set the scan response data from a raw encoded payload.
+ *
+ * The data is copied and handed to the ESP-IDF as for setAdvertisementData().
+ *
+ * @param [in] pData The encoded scan response payload.
+ * @param [in] length The length of the payload; at most 31 bytes.
+ */
+void BLEAdvertising::setScanResponseData(const uint8_t* pData, size_t length) {
+	ESP_LOGD(LOG_TAG, ">> setScanResponseData: length: %d", length);
+	if (length > ESP_BLE_ADV_DATA_LEN_MAX) {
+		ESP_LOGE(LOG_TAG, "setScanResponseData: payload of %d bytes exceeds %d", length, ESP_BLE_ADV_DATA_LEN_MAX);
+		return;
+	}
+	portENTER_CRITICAL(&m_payloadMux);
+	m_scanResponsePayload.clear();
+	m_scanResponsePayload.addRaw(pData, length);
+	m_pendingUpdate |= UPDATE_SCAN_RSP;
+	portEXIT_CRITICAL(&m_payloadMux);
+	portENTER_CRITICAL(&m_startMux);
+	bool starting = isStarting();
+	portEXIT_CRITICAL(&m_startMux);
+	if (starting) {
+		ESP_LOGD(LOG_TAG, "setScanResponseData: sent once the start sequence completes");
+	} else {
+		sendPayloads(UPDATE_SCAN_RSP);
 	}
 	m_customScanResponseData = true;   // Set the flag that indicates we are using custom scan response data.
 	ESP_LOGD(LOG_TAG, "<< setScanResponseData");
 } // setScanResponseData
 
+/**
+ * @brief Return the shortest form of a UUID.
+ *
+ * A 128 bit UUID built on the Bluetooth base UUID is reduced to its 16 or 32 bit alias so that it costs
+ * 2 or 4 bytes in an advert instead of 16.
+ *
+ * @param [in] uuid The UUID to shorten.
+ * @return The shortest equivalent UUID.
+ */
+static BLEUUID shortestUUID(BLEUUID uuid) {
+	static const uint8_t baseUUID[12] = { 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00 };
+	if (uuid.bitSize() != 128) return uuid;
+	uint8_t* p = uuid.getNative()->uuid.uuid128;
+	if (memcmp(p, baseUUID, sizeof(baseUUID)) != 0) return uuid;
+	if (p[14] == 0 && p[15] == 0) {
+		return BLEUUID((uint16_t) (p[12] | (p[13] << 8)));
+	}
+	return BLEUUID((uint32_t) (p[12] | (p[13] << 8) | (p[14] << 16) | ((uint32_t) p[15] << 24)));
+} // shortestUUID
+
+
+/**
+ * @brief Pack service UUIDs into the advertisement and scan response.
+ *
+ * Each UUID is reduced to its shortest form and the UUIDs are grouped into 16, 32 and 128 bit service
+ * lists.  UUIDs are placed in priority order (first in the vector first): into the advertisement if there
+ * is room, otherwise into the scan response.  A list costs 2 header bytes in each payload that carries it.
+ * A list is marked complete only if every UUID of its size ended up in that one payload.
+ *
+ * @param [in] uuids The service UUIDs, highest priority first.
+ * @param [in] pAdvertisement The advertisement payload to pack into or nullptr.
+ * @param [in] pScanResponse The scan response payload to pack into or nullptr.
+ * @param [out] pUnplaced If not nullptr, receives the UUIDs that did not fit.
+ * @return The number of UUIDs that did not fit.
+ */
+/* STATIC */ size_t BLEAdvertising::packServiceUUIDs(std::vector<BLEUUID>& uuids, BLEAdvertisementPayload* pAdvertisement,
+		BLEAdvertisementPayload* pScanResponse, std::vector<BLEUUID>* pUnplaced) {
+	static const uint8_t widths[3]        = { 2, 4, 16 };
+	static const uint8_t completeTypes[3] = { ESP_BLE_AD_TYPE_16SRV_CMPL, ESP_BLE_AD_TYPE_32SRV_CMPL, ESP_BLE_AD_TYPE_128SRV_CMPL };
+	static const uint8_t partialTypes[3]  = { ESP_BLE_AD_TYPE_16SRV_PART, ESP_BLE_AD_TYPE_32SRV_PART, ESP_BLE_AD_TYPE_128SRV_PART };
+
+	BLEAdvertisementPayload* payloads[2] = { pAdvertisement, pScanResponse };
+	size_t  available[2];
+	uint8_t counts[2][3] = { { 0, 0, 0 }, { 0, 0, 0 } };
+	uint8_t totals[3]    = { 0, 0, 0 };
+	size_t  unplaced     = 0;
+	for (int i = 0; i < 2; i++) {
+		available[i] = payloads[i] == nullptr ? 0 : payloads[i]->getFree();
+	}
+	if (pUnplaced != nullptr) pUnplaced->clear();
+
+	// Decide where each UUID goes.  0 = advertisement, 1 = scan response, 2 = nowhere.
+	std::vector<uint8_t> placement(uuids.size(), 2);
+	std::vector<BLEUUID> shortUUIDs;
+	shortUUIDs.reserve(uuids.size());
+	for (size_t i = 0; i < uuids.size(); i++) {
+		shortUUIDs.push_back(shortestUUID(uuids[i]));
+		uint8_t bits = shortUUIDs[i].bitSize();
+		int sizeClass = bits == 16 ? 0 : (bits == 32 ? 1 : 2);
+		totals[sizeClass]++;
+		for (int p = 0; p < 2; p++) {
+			size_t cost = widths[sizeClass] + (counts[p][sizeClass] == 0 ? 2 : 0);
+			if (cost <= available[p]) {
+				available[p] -= cost;
+				counts[p][sizeClass]++;
+				placement[i] = p;
+				break;
+			}
+		}
+		if (placement[i] == 2) {
+			ESP_LOGW(LOG_TAG, "Service %s does not fit in the advertisement or scan response", uuids[i].toString().c_str());
+			unplaced++;
+			if (pUnplaced != nullptr) pUnplaced->push_back(uuids[i]);
+		}
+	}
+
+	// Emit one list per size per payload.
+	for (int p = 0; p < 2; p++) {
+		for (int sizeClass = 0; sizeClass < 3; sizeClass++) {
+			if (counts[p][sizeClass] == 0) continue;
+			uint8_t list[ESP_BLE_ADV_DATA_LEN_MAX];
+			size_t  length = 0;
+			for (size_t i = 0; i < uuids.size(); i++) {
+				if (placement[i] != p || shortUUIDs[i].bitSize() != widths[sizeClass] * 8) continue;
+				esp_bt_uuid_t* pNative = shortUUIDs[i].getNative();
+				switch (sizeClass) {
+					case 0:
+						memcpy(list + length, &pNative->uuid.uuid16, 2);
+						break;
+					case 1:
+						memcpy(list + length, &pNative->uuid.uuid32, 4);
+						break;
+					default:
+						memcpy(list + length, pNative->uuid.uuid128, 16);
+						break;
+				}
+				length += widths[sizeClass];
+			}
+			bool complete = counts[p][sizeClass] == totals[sizeClass];
+			payloads[p]->addField(complete ? completeTypes[sizeClass] : partialTypes[sizeClass], list, length);
+		}
+	}
+	return unplaced;
+} // packServiceUUIDs
+
+
+/**
+ * @brief Encode the advertisement and scan response from the current settings.
+ *
+ * The flags, appearance and preferred connection interval go in the advertisement.  The name and transmit
+ * power go in the scan response when one is enabled, otherwise in the advertisement.  A name that does not
+ * fit is truncated and sent as a short name.  The service UUIDs are then packed into the space that is left.
+ *
+ * @param [out] pAdvertisement The advertisement payload or nullptr if custom advertisement data is in use.
+ * @param [out] pScanResponse The scan response payload or nullptr if no generated scan response is wanted.
+ */
+void BLEAdvertising::buildPayloads(BLEAdvertisementPayload* pAdvertisement, BLEAdvertisementPayload* pScanResponse) {
+	if (pAdvertisement != nullptr) {
+		pAdvertisement->clear();
+		if (m_advData.flag != 0) {
+			pAdvertisement->setFlags(m_advData.flag);
+		}
+		if (m_advData.appearance != 0) {
+			pAdvertisement->setAppearance(m_advData.appearance);
+		}
+		if (m_advData.min_interval > 0 && m_advData.max_interval > 0) {
+			uint8_t range[4] = {
+				(uint8_t) m_advData.min_interval, (uint8_t) (m_advData.min_interval >> 8),
+				(uint8_t) m_advData.max_interval, (uint8_t) (m_advData.max_interval >> 8)
+			};
+			pAdvertisement->addField(ESP_BLE_AD_TYPE_INT_RANGE, range, sizeof(range));
+		}
+	}
+	if (pScanResponse != nullptr) {
+		pScanResponse->clear();
+	}
+
+	BLEAdvertisementPayload* pIdentity = m_scanResp ? pScanResponse : pAdvertisement;
+	if (pIdentity != nullptr) {
+		if (m_advData.include_txpower) {
+			// Power levels step by 3dBm starting at -12dBm.
+			pIdentity->setTxPower(-12 + 3 * (int) ::esp_ble_tx_power_get(ESP_BLE_PWR_TYPE_ADV));
+		}
+		std::string name = BLEDevice::getDeviceName();
+		if (m_advData.include_name && name.length() > 0) {
+			size_t room = pIdentity->getFree() > 2 ? pIdentity->getFree() - 2 : 0;
+			if (name.length() <= room) {
+				pIdentity->setName(name.data(), name.length());
+			} else if (room > 0) {
+				pIdentity->setShortName(name.data(), room);
+			}
+		}
+	}
+
+	packServiceUUIDs(m_serviceUUIDs, pAdvertisement, m_scanResp ? pScanResponse : nullptr, &m_unplacedServiceUUIDs);
+} // buildPayloads
+
+
 /**
  * @brief Start advertising.
- * Start advertising.
- * @return N/A.
+ *
+ * Advertising is started as a sequence of steps, each issued when the previous one has completed: the
+ * advertisement is configured (ESP_GAP_BLE_ADV_DATA_RAW_SET_COMPLETE_EVT), then the scan response
+ * (ESP_GAP_BLE_SCAN_RSP_DATA_RAW_SET_COMPLETE_EVT), then advertising is started
+ * (ESP_GAP_BLE_ADV_START_COMPLETE_EVT).  Steps with nothing new to configure are skipped.  The call blocks
+ * until advertising is live so no delay is needed before relying on the new payload.  When called from
+ * the Bluetooth task itself (for example from a server callback or the restart after a disconnect) it
+ * never blocks: it cannot wait for the events that task delivers, so it returns as soon as the sequence
+ * has been set off and the sequence completes in the background.
+ *
+ * A start() made while another start sequence is in flight is deferred and carried out when that sequence
+ * completes.  A waiting caller is released once all the start work queued so far is done.
+ *
+ * @return True if advertising is live (or the sequence was set off from the Bluetooth task).
  */
-void BLEAdvertising::start() {
+bool BLEAdvertising::start() {
 	ESP_LOGD(LOG_TAG, ">> start: customAdvData: %d, customScanResponseData: %d", m_customAdvData, m_customScanResponseData);
 
-	// We have a vector of service UUIDs that we wish to advertise.  In order to use the
-	// ESP-IDF framework, these must be supplied in a contiguous array of their 128bit (16 byte)
-	// representations.  If we have 1 or more services to advertise then we allocate enough
-	// storage to host them and then copy them in one at a time into the contiguous storage.
-	int numServices = m_serviceUUIDs.size();
-	if (numServices > 0) {
-		m_advData.service_uuid_len = 16 * numServices;
-		m_advData.p_service_uuid = new uint8_t[m_advData.service_uuid_len];
-		uint8_t* p = m_advData.p_service_uuid;
-		for (int i = 0; i < numServices; i++) {
-			ESP_LOGD(LOG_TAG, "- advertising service: %s", m_serviceUUIDs[i].toString().c_str());
-			BLEUUID serviceUUID128 = m_serviceUUIDs[i].to128();
-			memcpy(p, serviceUUID128.getNative()->uuid.uuid128, 16);
-			p += 16;
-		}
-	} else {
-		m_advData.service_uuid_len = 0;
-		ESP_LOGD(LOG_TAG, "- no services advertised");
+	// Encode the parts of the advertisement and scan response that the programmer has not supplied
+	// directly.  Both are handed to the ESP-IDF raw so that we decide where each service UUID goes.
+	// They are kept so that later updates can patch them in place.  The controller holds on to the
+	// data between advertising runs, so nothing is re-encoded or re-sent unless a setting changed
+	// since the last start() (or the controller was restarted).  A restart after a disconnect then
+	// costs only the start call.
+	bool buildAdvertisement  = !m_customAdvData;
+	bool buildScanResponse   = !m_customScanResponseData && m_scanResp;
+	uint8_t send = 0;
+	if (m_configDirty) {
+		BLEAdvertisementPayload advertisement;
+		BLEAdvertisementPayload scanResponse;
+		buildPayloads(buildAdvertisement ? &advertisement : nullptr, buildScanResponse ? &scanResponse : nullptr);
+		portENTER_CRITICAL(&m_payloadMux);
+		if (buildAdvertisement) m_advPayload = advertisement;
+		if (buildScanResponse) m_scanResponsePayload = scanResponse;
+		portEXIT_CRITICAL(&m_payloadMux);
+		send |= (buildAdvertisement ? UPDATE_ADV : 0) | (buildScanResponse ? UPDATE_SCAN_RSP : 0);
+		m_configDirty = false;
+	}
+	if (!m_configSent) {
+		// Custom data was handed over when it was set but has to be given again to a restarted controller.
+		send |= (buildAdvertisement || m_customAdvData ? UPDATE_ADV : 0) |
+			(buildScanResponse || m_customScanResponseData ? UPDATE_SCAN_RSP : 0);
+		m_configSent = true;
 	}
 
-	esp_err_t errRc;
+	bool btTask = ::xTaskGetCurrentTaskHandle() == m_btTask;
+	if (!btTask) {
+		m_semaphoreSetAdv.take("start");    // Only one application task waits at a time.
+	}
+	portENTER_CRITICAL(&m_startMux);
+	bool busy   = isStarting();
+	bool active = !busy && m_advState == ADV_STATE_ACTIVE;
+	if (busy) {
+		m_startDeferred  = true;
+		m_deferredSteps |= send;
+	} else if (!active) {
+		m_startSteps = send;
+		m_advState   = ADV_STATE_STARTING;   // Claims the sequence; nextStartStep() sets the real step.
+	}
+	if (!btTask && !active) m_startWaiting = true;
+	portEXIT_CRITICAL(&m_startMux);
+
+	if (active) {
+		// Already advertising: starting again would be refused by the controller, so only hand over
+		// the data that changed.
+		esp_err_t errRc = send != 0 ? sendPayloads(send) : ESP_OK;
+		if (!btTask) m_semaphoreSetAdv.give();
+		ESP_LOGD(LOG_TAG, "<< start: already advertising, rc=%d", errRc);
+		return errRc == ESP_OK;
+	}
+
+	// A fresh start begins the interval policy at its fast first step.
+	if (m_intervalStepCount > 0) {
+		applyIntervalStep(0);
+	}
+	m_advStartTime = esp_timer_get_time();
+	if (!busy) nextStartStep();
 
-	if (!m_customAdvData) {
-		// Set the configuration for advertising.
-		m_advData.set_scan_rsp = false;
-		m_advData.include_name = !m_scanResp;
-		m_advData.include_txpower = !m_scanResp;
-		errRc = ::esp_ble_gap_config_adv_data(&m_advData);
+	if (btTask) {
+		ESP_LOGD(LOG_TAG, "<< start: completing in the background");
+		return true;
+	}
+	esp_err_t rc = (esp_err_t) m_semaphoreSetAdv.wait("start");
+	ESP_LOGD(LOG_TAG, "<< start: rc=%d", rc);
+	return rc == ESP_OK;
+} // start
+
+
+/**
+ * @brief Issue the next step of the start sequence.
+ *
+ * Called by start() for the first step and by the GAP event handler as each step completes.
+ */
+void BLEAdvertising::nextStartStep() {
+	esp_err_t errRc;
+	if (m_startSteps & UPDATE_ADV) {
+		m_startSteps &= ~UPDATE_ADV;
+		m_advState = ADV_STATE_SETTING_DATA;
+		errRc = sendPayloads(UPDATE_ADV);
+	} else if (m_startSteps & UPDATE_SCAN_RSP) {
+		m_startSteps &= ~UPDATE_SCAN_RSP;
+		m_advState = ADV_STATE_SETTING_SCAN_RSP;
+		errRc = sendPayloads(UPDATE_SCAN_RSP);
+	} else {
+		m_advState = ADV_STATE_STARTING;
+		errRc = ::esp_ble_gap_start_advertising(&m_advParams);
 		if (errRc != ESP_OK) {
-			ESP_LOGE(LOG_TAG, "<< esp_ble_gap_config_adv_data: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-			return;
+			ESP_LOGE(LOG_TAG, "esp_ble_gap_start_advertising: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
 		}
 	}
+	if (errRc != ESP_OK) {
+		failStart(errRc);
+	}
+} // nextStartStep
 
-	if (!m_customScanResponseData && m_scanResp) {
-		m_advData.set_scan_rsp = true;
-		m_advData.include_name = m_scanResp;
-		m_advData.include_txpower = m_scanResp;
-		errRc = ::esp_ble_gap_config_adv_data(&m_advData);
-		if (errRc != ESP_OK) {
-			ESP_LOGE(LOG_TAG, "<< esp_ble_gap_config_adv_data (Scan response): rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-			return;
+
+/**
+ * @brief Abandon the start sequence and release start().
+ * @param [in] errRc The reason.
+ */
+void BLEAdvertising::failStart(esp_err_t errRc) {
+	if (m_advState == ADV_STATE_SETTING_DATA || m_advState == ADV_STATE_SETTING_SCAN_RSP) {
+		m_configSent = false;   // Hand the data over again next time.
+	}
+	m_advState   = ADV_STATE_IDLE;
+	m_startSteps = 0;
+	completeStart(errRc);
+} // failStart
+
+
+/**
+ * @brief Finish a start sequence.
+ *
+ * Runs a start() that was deferred while the sequence was in flight.  Otherwise releases the application
+ * task waiting in start(), if there is one; a sequence nobody waits for (a start() on the Bluetooth task
+ * or an interval policy restart) gives nothing.  Payloads set or updated during the sequence are sent.
+ *
+ * @param [in] errRc The outcome of the sequence.
+ */
+void BLEAdvertising::completeStart(esp_err_t errRc) {
+	portENTER_CRITICAL(&m_startMux);
+	bool    deferred = m_startDeferred;
+	uint8_t steps    = m_deferredSteps;
+	bool    restart  = m_deferredRestart;
+	m_startDeferred   = false;
+	m_deferredSteps   = 0;
+	m_deferredRestart = false;
+	bool    release  = m_startWaiting && (!deferred || m_advState == ADV_STATE_ACTIVE);
+	if (release) m_startWaiting = false;
+	if (deferred && m_advState != ADV_STATE_ACTIVE) {
+		m_startSteps = steps;
+		m_advState   = ADV_STATE_STARTING;
+	}
+	portEXIT_CRITICAL(&m_startMux);
+
+	if (deferred && m_advState == ADV_STATE_ACTIVE) {
+		// Already advertising: the deferred start only has to hand over its data, and restart
+		// if it was made for new advertising parameters.
+		if (steps != 0) errRc = sendPayloads(steps);
+		if (restart) {
+			m_restartPending = true;
+			stopAdvertising();
 		}
+	} else if (deferred) {
+		nextStartStep();    // Try again with the deferred start.
 	}
+	flushUpdate();   // Data set or patched while the sequence was in flight.
+	if (release) m_semaphoreSetAdv.give(errRc);
+} // completeStart
 
-	// If we had services to advertise then we previously allocated some storage for them.
-	// Here we release that storage.
-	if (m_advData.service_uuid_len > 0) {
-		delete[] m_advData.p_service_uuid;
-		m_advData.p_service_uuid = nullptr;
+
+/**
+ * @brief (Re)start advertising with the current parameters without blocking.
+ *
+ * The data held by the controller is kept.  Live advertising is stopped and restarted when the stop
+ * completes, idle advertising is started, and a start sequence in flight is followed by a restart.  Used
+ * by BLEAdvertisingScheduler, which runs on the timer task and must not wait for GAP events.
+ */
+void BLEAdvertising::restart() {
+	portENTER_CRITICAL(&m_startMux);
+	uint8_t state = m_advState;
+	bool    busy  = isStarting();
+	if (busy) {
+		m_startDeferred   = true;
+		m_deferredRestart = true;
+	} else if (state == ADV_STATE_ACTIVE) {
+		m_restartPending = true;
+	} else {
+		m_startSteps = 0;
+		m_advState   = ADV_STATE_STARTING;
 	}
+	portEXIT_CRITICAL(&m_startMux);
 
-	// Start advertising.
-	errRc = ::esp_ble_gap_start_advertising(&m_advParams);
-	if (errRc != ESP_OK) {
-		ESP_LOGE(LOG_TAG, "<< esp_ble_gap_start_advertising: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-		return;
+	if (busy) return;
+	if (state == ADV_STATE_ACTIVE) {
+		stopAdvertising();
+	} else {
+		nextStartStep();
 	}
-	ESP_LOGD(LOG_TAG, "<< start");
-} // start
+} // restart
+
+
+/**
+ * @brief Is a start sequence in flight?  Called with m_startMux held.
+ * @return True from the first step of a start (or an interval policy restart) until it completes.
+ */
+bool BLEAdvertising::isStarting() {
+	return m_advState == ADV_STATE_SETTING_DATA || m_advState == ADV_STATE_SETTING_SCAN_RSP ||
+		m_advState == ADV_STATE_STARTING || (m_advState == ADV_STATE_STOPPING && m_restartPending);
+} // isStarting
+
+
+/**
+ * @brief Is advertising live?
+ * @return True from the completion of start() until stop() or a connection.
+ */
+bool BLEAdvertising::isAdvertising() {
+	return m_advState == ADV_STATE_ACTIVE;
+} // isAdvertising
 
 
 /**
  * @brief Stop advertising.
- * Stop advertising.
+ *
+ * A start sequence in flight is abandoned, as are the starts deferred behind it, and a start() waiting
+ * for it is released with a failure.
  * @return N/A.
  */
 void BLEAdvertising::stop() {
 	ESP_LOGD(LOG_TAG, ">> stop");
+	portENTER_CRITICAL(&m_startMux);
+	bool starting     = isStarting();
+	m_restartPending  = false;
+	m_startDeferred   = false;
+	m_deferredSteps   = 0;
+	m_deferredRestart = false;
+	portEXIT_CRITICAL(&m_startMux);
+	if (m_policyTimer != nullptr) {
+		::xTimerStop(m_policyTimer, 0);
+	}
+	if (starting) {
+		failStart(ESP_FAIL);   // The step in flight completes into the stop and is ignored.
+	}
+	stopAdvertising();
+	ESP_LOGD(LOG_TAG, "<< stop");
+} // stop
+
+
+/**
+ * @brief Ask the controller to stop advertising.
+ */
+void BLEAdvertising::stopAdvertising() {
+	portENTER_CRITICAL(&m_startMux);
+	m_advState = ADV_STATE_STOPPING;
+	portEXIT_CRITICAL(&m_startMux);
 	esp_err_t errRc = ::esp_ble_gap_stop_advertising();
 	if (errRc != ESP_OK) {
 		ESP_LOGE(LOG_TAG, "esp_ble_gap_stop_advertising: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		portENTER_CRITICAL(&m_startMux);
+		m_advState       = ADV_STATE_IDLE;
+		m_restartPending = false;
+		portEXIT_CRITICAL(&m_startMux);
+	}
+} // stopAdvertising
+
+
+/**
+ * @brief Set the advertising interval policy.
+ *
+ * Each start() of advertising, which includes the restart after a disconnect, begins with the first step
+ * and moves on to the next step when the duration of the current one has passed.  A typical policy is a
+ * fast burst for a few seconds, so a central reconnects quickly, followed by a slow interval to save power.
+ * The policy replaces the intervals set by setMinInterval() and setMaxInterval().
+ *
+ * @param [in] pSteps The steps.  A step with a duration of 0 is held until advertising next starts.
+ * @param [in] count The number of steps (up to MAX_INTERVAL_STEPS); 0 removes the policy.
+ * @return True on success, false if there are too many steps.
+ */
+bool BLEAdvertising::setIntervalPolicy(const ble_adv_interval_step_t* pSteps, uint8_t count) {
+	if (count > MAX_INTERVAL_STEPS) {
+		ESP_LOGE(LOG_TAG, "setIntervalPolicy: %d steps, at most %d supported", count, MAX_INTERVAL_STEPS);
+		return false;
+	}
+	memcpy(m_intervalSteps, pSteps, count * sizeof(ble_adv_interval_step_t));
+	m_intervalStepCount = count;
+	m_intervalStep      = 0;
+	if (count == 0 && m_policyTimer != nullptr) {
+		::xTimerStop(m_policyTimer, 0);
+	}
+	return true;
+} // setIntervalPolicy
+
+
+/**
+ * @brief Set a two step fast then slow interval policy.
+ * @param [in] fastMin The minimum interval of the burst in units of 0.625ms.
+ * @param [in] fastMax The maximum interval of the burst in units of 0.625ms.
+ * @param [in] fastDuration How long the burst lasts in milliseconds.
+ * @param [in] slowMin The minimum interval after the burst in units of 0.625ms.
+ * @param [in] slowMax The maximum interval after the burst in units of 0.625ms.
+ */
+void BLEAdvertising::setIntervalPolicy(uint16_t fastMin, uint16_t fastMax, uint32_t fastDuration, uint16_t slowMin, uint16_t slowMax) {
+	ble_adv_interval_step_t steps[2] = {
+		{ fastMin, fastMax, fastDuration },
+		{ slowMin, slowMax, 0 }
+	};
+	setIntervalPolicy(steps, 2);
+} // setIntervalPolicy
+
+
+/**
+ * @brief Restart the interval policy at its fast first step, e.g. after a button press.
+ *
+ * Starts advertising if it is not running.  That goes through start(), so like start() the call then
+ * blocks until advertising is live unless it is made from the Bluetooth task.  Live advertising is only
+ * restarted with the fast intervals, which never blocks.
+ */
+void BLEAdvertising::boost() {
+	if (m_intervalStepCount == 0) return;
+	portENTER_CRITICAL(&m_startMux);
+	bool active  = m_advState == ADV_STATE_ACTIVE;
+	bool restart = active && m_intervalStep != 0;   // Already fast: just extend the burst.
+	if (restart) m_restartPending = true;           // New intervals take effect on a restart.
+	portEXIT_CRITICAL(&m_startMux);
+
+	if (!active) {
+		start();
 		return;
 	}
-	ESP_LOGD(LOG_TAG, "<< stop");
-} // stop
+	applyIntervalStep(0);
+	if (restart) stopAdvertising();
+} // boost
+
+
+/**
+ * @brief Get the interval policy step being advertised.
+ * @return The index of the step.
+ */
+uint8_t BLEAdvertising::getIntervalStep() {
+	return m_intervalStep;
+} // getIntervalStep
+
+
+/**
+ * @brief Get the observed time from the start of advertising to a connection.
+ * @return The connection metrics.
+ */
+ble_adv_connect_metrics_t BLEAdvertising::getConnectMetrics() {
+	return m_connectMetrics;
+} // getConnectMetrics
+
+
+/**
+ * @brief Use the intervals of a policy step and arm the timer for its duration.
+ * @param [in] step The index of the step.
+ */
+void BLEAdvertising::applyIntervalStep(uint8_t step) {
+	m_intervalStep          = step;
+	m_advParams.adv_int_min = m_intervalSteps[step].minInterval;
+	m_advParams.adv_int_max = m_intervalSteps[step].maxInterval;
+	uint32_t duration = m_intervalSteps[step].duration;
+	if (step + 1 >= m_intervalStepCount || duration == 0) {
+		if (m_policyTimer != nullptr) ::xTimerStop(m_policyTimer, 0);
+		return;
+	}
+	if (m_policyTimer == nullptr) {
+		m_policyTimer = ::xTimerCreate("advPolicy", 1, pdFALSE, this, policyTimerCallback);
+		if (m_policyTimer == nullptr) return;
+	}
+	TickType_t ticks = pdMS_TO_TICKS(duration);
+	::xTimerChangePeriod(m_policyTimer, ticks > 0 ? ticks : 1, 0);   // Also starts the timer.
+} // applyIntervalStep
+
+
+/**
+ * @brief Move to the next step of the interval policy.
+ *
+ * The controller only takes new intervals when advertising starts, so advertising is stopped and
+ * restarted (without handing over the data again) when the stop completes.
+ *
+ * @param [in] timer The timer that expired; its ID is the advertising object.
+ */
+/* STATIC */ void BLEAdvertising::policyTimerCallback(TimerHandle_t timer) {
+	BLEAdvertising* pAdvertising = (BLEAdvertising*) ::pvTimerGetTimerID(timer);
+	if (pAdvertising->m_intervalStep + 1 >= pAdvertising->m_intervalStepCount) return;
+	pAdvertising->applyIntervalStep(pAdvertising->m_intervalStep + 1);
+	portENTER_CRITICAL(&pAdvertising->m_startMux);
+	bool restart = pAdvertising->m_advState == ADV_STATE_ACTIVE;
+	if (restart) pAdvertising->m_restartPending = true;
+	portEXIT_CRITICAL(&pAdvertising->m_startMux);
+	if (restart) pAdvertising->stopAdvertising();
+} // policyTimerCallback
+
+
+/**
+ * @brief Note that a central has connected.
+ *
+ * The controller stops advertising when a connection is made.  Records the time since start() was called.
+ */
+void BLEAdvertising::onConnect() {
+	portENTER_CRITICAL(&m_startMux);
+	if (m_advState == ADV_STATE_ACTIVE) {
+		m_advState = ADV_STATE_IDLE;
+	}
+	portEXIT_CRITICAL(&m_startMux);
+	if (m_policyTimer != nullptr) {
+		::xTimerStop(m_policyTimer, 0);
+	}
+	if (m_advStartTime == 0) return;
+	uint32_t latency = esp_timer_get_time() - m_advStartTime;
+	m_advStartTime = 0;
+	if (m_connectMetrics.count == 0 || latency < m_connectMetrics.min) m_connectMetrics.min = latency;
+	if (latency > m_connectMetrics.max) m_connectMetrics.max = latency;
+	m_connectMetrics.last      = latency;
+	m_connectMetrics.total    += latency;
+	m_connectMetrics.lastStep  = m_intervalStep;
+	m_connectMetrics.count++;
+	ESP_LOGD(LOG_TAG, "Connected %d us after advertising started (interval step %d)", latency, m_intervalStep);
+} // onConnect
 
 /**
  * @brief Add data to the payload to be advertised.
@@ -268,6 +857,7 @@ void BLEAdvertising::stop() {
  */
 void BLEAdvertisementData::addData(std::string data) {
 	if ((m_payload.length() + data.length()) > ESP_BLE_ADV_DATA_LEN_MAX) {
+		ESP_LOGW(LOG_TAG, "addData: %d byte field does not fit in the %d bytes left; dropped", data.length(), ESP_BLE_ADV_DATA_LEN_MAX - m_payload.length());
 		return;
 	}
 	m_payload.append(data);
@@ -472,34 +1062,564 @@ std::string BLEAdvertisementData::getPayload() {
 	return m_payload;
 } // getPayload
 
+
+/**
+ * @brief Forget that the controller holds our advertising data.
+ *
+ * Called when the controller has been restarted so that the next start() hands over the cached
+ * advertisement and scan response again.
+ */
+void BLEAdvertising::invalidateConfig() {
+	m_configSent = false;
+} // invalidateConfig
+
+
+/**
+ * @brief Set the minimum time between two payload updates reaching the ESP-IDF.
+ *
+ * Updates made more often than this are applied to the cached payload at once but sent together, once the
+ * interval has passed since the previous update was sent.
+ *
+ * @param [in] ms The minimum interval in milliseconds.  0 sends every update immediately.
+ */
+void BLEAdvertising::setMinUpdateInterval(uint32_t ms) {
+	m_minUpdateInterval = ms;
+} // setMinUpdateInterval
+
+
+/**
+ * @brief Overwrite bytes of a field of the current advertisement or scan response in place.
+ *
+ * The field must already be present in the payload last handed to the ESP-IDF and the new bytes must lie
+ * within it, so the layout of the payload never changes.  The advertisement is searched first.  The updated
+ * payload is sent with a single raw configuration call, subject to the minimum update interval, while
+ * advertising carries on; advertising is neither stopped nor restarted.
+ *
+ * @param [in] type The AD type of the field to patch.
+ * @param [in] offset The offset of the first byte to overwrite within the field data.
+ * @param [in] pData The new bytes.
+ * @param [in] length The number of bytes to overwrite.
+ * @return ESP_OK if the update was applied (it may be sent later), ESP_ERR_NOT_FOUND if the field does not
+ * exist or ESP_ERR_INVALID_SIZE if the bytes do not lie within it.
+ */
+esp_err_t BLEAdvertising::updateField(uint8_t type, size_t offset, const uint8_t* pData, size_t length) {
+	size_t fieldLength;
+	uint8_t pending = 0;
+	portENTER_CRITICAL(&m_payloadMux);
+	if (m_advPayload.findField(type, nullptr, 0, &fieldLength) != nullptr) {
+		if (m_advPayload.patchField(type, offset, pData, length)) pending = UPDATE_ADV;
+	} else if (m_scanResponsePayload.findField(type, nullptr, 0, &fieldLength) != nullptr) {
+		if (m_scanResponsePayload.patchField(type, offset, pData, length)) pending = UPDATE_SCAN_RSP;
+	} else {
+		fieldLength = 0;
+	}
+	m_pendingUpdate |= pending;
+	portEXIT_CRITICAL(&m_payloadMux);
+
+	if (pending == 0) {
+		ESP_LOGE(LOG_TAG, "updateField: field 0x%.2x %s", type, fieldLength == 0 ? "not found" : "too short");
+		return fieldLength == 0 ? ESP_ERR_NOT_FOUND : ESP_ERR_INVALID_SIZE;
+	}
+	return flushUpdate();
+} // updateField
+
+
+/**
+ * @brief Overwrite bytes of the manufacturer data in place.
+ * @param [in] offset The offset within the manufacturer data (the company identifier is at offset 0).
+ * @param [in] pData The new bytes.
+ * @param [in] length The number of bytes to overwrite.
+ * @return ESP_OK, ESP_ERR_NOT_FOUND or ESP_ERR_INVALID_SIZE as for updateField().
+ */
+esp_err_t BLEAdvertising::updateManufacturerData(size_t offset, const uint8_t* pData, size_t length) {
+	return updateField(ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE, offset, pData, length);
+} // updateManufacturerData
+
+
+/**
+ * @brief Overwrite bytes of the service data of a service in place.
+ * @param [in] uuid The service whose data is to be updated.
+ * @param [in] offset The offset within the service data, after the UUID.
+ * @param [in] pData The new bytes.
+ * @param [in] length The number of bytes to overwrite.
+ * @return ESP_OK if the update was applied (it may be sent later) or ESP_ERR_NOT_FOUND if there is no
+ * service data for the service large enough to hold the bytes.
+ */
+esp_err_t BLEAdvertising::updateServiceData(BLEUUID uuid, size_t offset, const uint8_t* pData, size_t length) {
+	uint8_t pending = 0;
+	portENTER_CRITICAL(&m_payloadMux);
+	if (m_advPayload.patchServiceData(uuid, offset, pData, length)) {
+		pending = UPDATE_ADV;
+	} else if (m_scanResponsePayload.patchServiceData(uuid, offset, pData, length)) {
+		pending = UPDATE_SCAN_RSP;
+	}
+	m_pendingUpdate |= pending;
+	portEXIT_CRITICAL(&m_payloadMux);
+
+	if (pending == 0) {
+		ESP_LOGE(LOG_TAG, "updateServiceData: no service data for %s holding %d bytes at %d", uuid.toString().c_str(), length, offset);
+		return ESP_ERR_NOT_FOUND;
+	}
+	return flushUpdate();
+} // updateServiceData
+
+
+/**
+ * @brief Send the patched payloads to the ESP-IDF if the minimum update interval has passed.
+ *
+ * If it has not, a one shot timer is armed to send them when it does.  Further updates made in the meantime
+ * are carried by the same send.  Nothing is sent while a start sequence is in flight; completeStart()
+ * flushes the updates when it ends.
+ *
+ * @return ESP_OK or the error of the raw configuration call.
+ */
+esp_err_t BLEAdvertising::flushUpdate() {
+	portENTER_CRITICAL(&m_startMux);
+	bool starting = isStarting();
+	portEXIT_CRITICAL(&m_startMux);
+	if (starting) return ESP_OK;
+
+	uint32_t now     = FreeRTOS::getTimeSinceStart();
+	uint32_t elapsed = now - m_lastUpdateTime;
+	if (m_minUpdateInterval > 0 && m_lastUpdateTime != 0 && elapsed < m_minUpdateInterval) {
+		if (m_updateTimer == nullptr) {
+			m_updateTimer = ::xTimerCreate("advUpdate", 1, pdFALSE, this, updateTimerCallback);
+		}
+		if (m_updateTimer != nullptr && !::xTimerIsTimerActive(m_updateTimer)) {
+			TickType_t ticks = pdMS_TO_TICKS(m_minUpdateInterval - elapsed);
+			::xTimerChangePeriod(m_updateTimer, ticks > 0 ? ticks : 1, 0);   // Also starts the timer.
+		}
+		return ESP_OK;
+	}
+
+	portENTER_CRITICAL(&m_payloadMux);
+	uint8_t pending = m_pendingUpdate;
+	portEXIT_CRITICAL(&m_payloadMux);
+	if (pending == 0) return ESP_OK;   // Already sent by an earlier flush.
+
+	esp_err_t errRc = sendPayloads(pending);
+	m_lastUpdateTime = now != 0 ? now : 1;
+	return errRc;
+} // flushUpdate
+
+
+/**
+ * @brief Hand cached payloads to the ESP-IDF.
+ * @param [in] which The payloads to send (UPDATE_ADV | UPDATE_SCAN_RSP).
+ * @return ESP_OK or the error of the last failing raw configuration call.
+ */
+esp_err_t BLEAdvertising::sendPayloads(uint8_t which) {
+	BLEAdvertisementPayload advertisement;
+	BLEAdvertisementPayload scanResponse;
+	portENTER_CRITICAL(&m_payloadMux);
+	m_pendingUpdate &= ~which;
+	if (which & UPDATE_ADV) advertisement = m_advPayload;
+	if (which & UPDATE_SCAN_RSP) scanResponse = m_scanResponsePayload;
+	portEXIT_CRITICAL(&m_payloadMux);
+
+	esp_err_t errRc = ESP_OK;
+	esp_err_t rc;
+	if (which & UPDATE_ADV) {
+		rc = ::esp_ble_gap_config_adv_data_raw((uint8_t*) advertisement.getData(), advertisement.getLength());
+		if (rc != ESP_OK) {
+			ESP_LOGE(LOG_TAG, "esp_ble_gap_config_adv_data_raw: %d %s", rc, GeneralUtils::errorToString(rc));
+			errRc = rc;
+		}
+	}
+	if (which & UPDATE_SCAN_RSP) {
+		rc = ::esp_ble_gap_config_scan_rsp_data_raw((uint8_t*) scanResponse.getData(), scanResponse.getLength());
+		if (rc != ESP_OK) {
+			ESP_LOGE(LOG_TAG, "esp_ble_gap_config_scan_rsp_data_raw: %d %s", rc, GeneralUtils::errorToString(rc));
+			errRc = rc;
+		}
+	}
+	return errRc;
+} // sendPayloads
+
+
+/**
+ * @brief Send updates that were held back by the minimum update interval.
+ * @param [in] timer The timer that expired; its ID is the advertising object.
+ */
+/* STATIC */ void BLEAdvertising::updateTimerCallback(TimerHandle_t timer) {
+	((BLEAdvertising*) ::pvTimerGetTimerID(timer))->flushUpdate();
+} // updateTimerCallback
+
+
+/**
+ * @brief Construct an empty payload.
+ */
+BLEAdvertisementPayload::BLEAdvertisementPayload() {
+	m_length   = 0;
+	m_overflow = 0;
+} // BLEAdvertisementPayload
+
+
+/**
+ * @brief Empty the payload and reset the overflow count.
+ */
+void BLEAdvertisementPayload::clear() {
+	m_length   = 0;
+	m_overflow = 0;
+} // clear
+
+
+/**
+ * @brief Reserve room for a field and write its header.
+ * @param [in] type The AD type of the field.
+ * @param [in] length The length of the field data (excluding the length and type bytes).
+ * @return Where the field data is to be written or nullptr if the field does not fit.
+ */
+uint8_t* BLEAdvertisementPayload::reserveField(uint8_t type, size_t length) {
+	size_t needed = length + 2;
+	if (length > 254 || needed > getFree()) {
+		m_overflow += needed;
+		ESP_LOGW(LOG_TAG, "Advertisement field 0x%.2x of %d bytes does not fit in the %d bytes left", type, needed, getFree());
+		return nullptr;
+	}
+	uint8_t* p = m_data + m_length;
+	p[0] = length + 1;
+	p[1] = type;
+	m_length += needed;
+	return p + 2;
+} // reserveField
+
+
+/**
+ * @brief Append a field to the payload.
+ * @param [in] type The AD type of the field.
+ * @param [in] pData The field data.
+ * @param [in] length The length of the field data.
+ * @return True if the field was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::addField(uint8_t type, const uint8_t* pData, size_t length) {
+	uint8_t* p = reserveField(type, length);
+	if (p == nullptr) return false;
+	memcpy(p, pData, length);
+	return true;
+} // addField
+
+
+/**
+ * @brief Append already encoded fields to the payload.
+ * @param [in] pData The encoded fields.
+ * @param [in] length The length of the encoded fields.
+ * @return True if the data was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::addRaw(const uint8_t* pData, size_t length) {
+	if (length > getFree()) {
+		m_overflow += length;
+		ESP_LOGW(LOG_TAG, "Advertisement data of %d bytes does not fit in the %d bytes left", length, getFree());
+		return false;
+	}
+	memcpy(m_data + m_length, pData, length);
+	m_length += length;
+	return true;
+} // addRaw
+
+
+/**
+ * @brief Find a field in the payload.
+ * @param [in] type The AD type of the field.
+ * @param [in] pPrefix If not nullptr, only a field whose data starts with these bytes matches.
+ * @param [in] prefixLength The length of the prefix.
+ * @param [out] pLength Receives the length of the field data following the prefix.
+ * @return The field data following the prefix or nullptr if there is no such field.
+ */
+uint8_t* BLEAdvertisementPayload::findField(uint8_t type, const uint8_t* pPrefix, size_t prefixLength, size_t* pLength) {
+	size_t i = 0;
+	while (i + 1 < m_length) {
+		size_t fieldLength = m_data[i];
+		if (fieldLength == 0 || i + 1 + fieldLength > m_length) break;   // Malformed or padding.
+		size_t dataLength = fieldLength - 1;
+		uint8_t* pFieldData = m_data + i + 2;
+		if (m_data[i + 1] == type && dataLength >= prefixLength &&
+				(prefixLength == 0 || memcmp(pFieldData, pPrefix, prefixLength) == 0)) {
+			*pLength = dataLength - prefixLength;
+			return pFieldData + prefixLength;
+		}
+		i += fieldLength + 1;
+	}
+	return nullptr;
+} // findField
+
+
+/**
+ * @brief Overwrite bytes of an existing field without changing the layout of the payload.
+ * @param [in] type The AD type of the field.
+ * @param [in] offset The offset of the first byte to overwrite within the field data.
+ * @param [in] pData The new bytes.
+ * @param [in] length The number of bytes to overwrite.
+ * @return True if the field exists and the bytes lie within it.
+ */
+bool BLEAdvertisementPayload::patchField(uint8_t type, size_t offset, const uint8_t* pData, size_t length) {
+	size_t fieldLength;
+	uint8_t* p = findField(type, nullptr, 0, &fieldLength);
+	if (p == nullptr || offset + length > fieldLength) return false;
+	memcpy(p + offset, pData, length);
+	return true;
+} // patchField
+
+
+/**
+ * @brief Overwrite bytes of the service data of a service without changing the layout of the payload.
+ * @param [in] uuid The service whose data is to be patched.
+ * @param [in] offset The offset within the service data, after the UUID.
+ * @param [in] pData The new bytes.
+ * @param [in] length The number of bytes to overwrite.
+ * @return True if service data for the service exists and the bytes lie within it.
+ */
+bool BLEAdvertisementPayload::patchServiceData(BLEUUID uuid, size_t offset, const uint8_t* pData, size_t length) {
+	esp_bt_uuid_t* pNative = uuid.getNative();
+	uint8_t  type;
+	uint8_t* pUUID;
+	switch (uuid.bitSize()) {
+		case 16:
+			type  = ESP_BLE_AD_TYPE_SERVICE_DATA;
+			pUUID = (uint8_t*) &pNative->uuid.uuid16;
+			break;
+		case 32:
+			type  = ESP_BLE_AD_TYPE_32SERVICE_DATA;
+			pUUID = (uint8_t*) &pNative->uuid.uuid32;
+			break;
+		case 128:
+			type  = ESP_BLE_AD_TYPE_128SERVICE_DATA;
+			pUUID = pNative->uuid.uuid128;
+			break;
+		default:
+			return false;
+	}
+	size_t fieldLength;
+	uint8_t* p = findField(type, pUUID, uuid.bitSize() / 8, &fieldLength);
+	if (p == nullptr || offset + length > fieldLength) return false;
+	memcpy(p + offset, pData, length);
+	return true;
+} // patchServiceData
+
+
+/**
+ * @brief Set the appearance.
+ * @param [in] appearance The appearance code value.
+ * @return True if the field was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::setAppearance(uint16_t appearance) {
+	uint8_t* p = reserveField(ESP_BLE_AD_TYPE_APPEARANCE, 2);
+	if (p == nullptr) return false;
+	p[0] = appearance;
+	p[1] = appearance >> 8;
+	return true;
+} // setAppearance
+
+
+/**
+ * @brief Set the complete services.
+ * @param [in] uuid The single service to advertise.
+ * @return True if the field was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::setCompleteServices(BLEUUID uuid) {
+	return setServices(uuid, true);
+} // setCompleteServices
+
+
+/**
+ * @brief Set the partial services.
+ * @param [in] uuid The single service to advertise.
+ * @return True if the field was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::setPartialServices(BLEUUID uuid) {
+	return setServices(uuid, false);
+} // setPartialServices
+
+
+/**
+ * @brief Add a service list field holding a single UUID, encoded at its own size.
+ * @param [in] uuid The service to advertise.
+ * @param [in] complete Whether the list is complete or partial.
+ * @return True if the field was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::setServices(BLEUUID uuid, bool complete) {
+	esp_bt_uuid_t* pNative = uuid.getNative();
+	switch (uuid.bitSize()) {
+		case 16:
+			return addField(complete ? ESP_BLE_AD_TYPE_16SRV_CMPL : ESP_BLE_AD_TYPE_16SRV_PART, (uint8_t*) &pNative->uuid.uuid16, 2);
+		case 32:
+			return addField(complete ? ESP_BLE_AD_TYPE_32SRV_CMPL : ESP_BLE_AD_TYPE_32SRV_PART, (uint8_t*) &pNative->uuid.uuid32, 4);
+		case 128:
+			return addField(complete ? ESP_BLE_AD_TYPE_128SRV_CMPL : ESP_BLE_AD_TYPE_128SRV_PART, pNative->uuid.uuid128, 16);
+		default:
+			return false;
+	}
+} // setServices
+
+
+/**
+ * @brief Set the advertisement flags.
+ * @param [in] flags The flags to be set in the advertisement.
+ * @return True if the field was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::setFlags(uint8_t flags) {
+	return addField(ESP_BLE_AD_TYPE_FLAG, &flags, 1);
+} // setFlags
+
+
+/**
+ * @brief Set manufacturer specific data.
+ * @param [in] pData The manufacturer data, starting with the little endian company identifier.
+ * @param [in] length The length of the manufacturer data.
+ * @return True if the field was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::setManufacturerData(const uint8_t* pData, size_t length) {
+	return addField(ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE, pData, length);
+} // setManufacturerData
+
+
+/**
+ * @brief Set the complete name.
+ * @param [in] name The NUL terminated name of the device.
+ * @return True if the field was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::setName(const char* name) {
+	return setName(name, strlen(name));
+} // setName
+
+
+/**
+ * @brief Set the complete name.
+ * @param [in] name The name of the device.
+ * @param [in] length The length of the name.
+ * @return True if the field was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::setName(const char* name, size_t length) {
+	return addField(ESP_BLE_AD_TYPE_NAME_CMPL, (const uint8_t*) name, length);
+} // setName
+
+
+/**
+ * @brief Set the short name.
+ * @param [in] name The shortened name of the device.
+ * @param [in] length The length of the shortened name.
+ * @return True if the field was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::setShortName(const char* name, size_t length) {
+	return addField(ESP_BLE_AD_TYPE_NAME_SHORT, (const uint8_t*) name, length);
+} // setShortName
+
+
+/**
+ * @brief Set the service data (UUID + data).
+ * @param [in] uuid The UUID to set with the service data.  Size of UUID will be used.
+ * @param [in] pData The data to be associated with the service data advert.
+ * @param [in] length The length of the data.
+ * @return True if the field was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::setServiceData(BLEUUID uuid, const uint8_t* pData, size_t length) {
+	esp_bt_uuid_t* pNative = uuid.getNative();
+	uint8_t  type;
+	uint8_t* pUUID;
+	switch (uuid.bitSize()) {
+		case 16:
+			type  = ESP_BLE_AD_TYPE_SERVICE_DATA;  // 0x16
+			pUUID = (uint8_t*) &pNative->uuid.uuid16;
+			break;
+		case 32:
+			type  = ESP_BLE_AD_TYPE_32SERVICE_DATA;  // 0x20
+			pUUID = (uint8_t*) &pNative->uuid.uuid32;
+			break;
+		case 128:
+			type  = ESP_BLE_AD_TYPE_128SERVICE_DATA;  // 0x21
+			pUUID = pNative->uuid.uuid128;
+			break;
+		default:
+			return false;
+	}
+	size_t uuidLength = uuid.bitSize() / 8;
+	uint8_t* p = reserveField(type, uuidLength + length);
+	if (p == nullptr) return false;
+	memcpy(p, pUUID, uuidLength);
+	memcpy(p + uuidLength, pData, length);
+	return true;
+} // setServiceData
+
+
+/**
+ * @brief Set the transmit power level.
+ * @param [in] txPower The transmit power in dBm.
+ * @return True if the field was added, false if it did not fit.
+ */
+bool BLEAdvertisementPayload::setTxPower(int8_t txPower) {
+	return addField(ESP_BLE_AD_TYPE_TX_PWR, (uint8_t*) &txPower, 1);
+} // setTxPower
+
+
+/**
+ * @brief Handle GAP events concerning advertising.
+ *
+ * Drives the start sequence: each completion event issues the next step, and the final one releases start().
+ *
+ * @param [in] event The GAP event.
+ * @param [in] param The event parameters.
+ */
 void BLEAdvertising::handleGAPEvent(
 		esp_gap_ble_cb_event_t  event,
 		esp_ble_gap_cb_param_t* param)  {
 
 	ESP_LOGD(LOG_TAG, "handleGAPEvent [event no: %d]", (int)event);
+	m_btTask = ::xTaskGetCurrentTaskHandle();   // Events are delivered on the Bluetooth task.
 
 	switch(event) {
-		case ESP_GAP_BLE_ADV_DATA_SET_COMPLETE_EVT: {
-			// m_semaphoreSetAdv.give();
+		case ESP_GAP_BLE_ADV_DATA_SET_COMPLETE_EVT:
+		case ESP_GAP_BLE_ADV_DATA_RAW_SET_COMPLETE_EVT: {
+			if (m_advState != ADV_STATE_SETTING_DATA) break;   // An update outside of start().
+			if (param->adv_data_raw_cmpl.status != ESP_BT_STATUS_SUCCESS) {
+				ESP_LOGE(LOG_TAG, "Setting advertisement data failed: status=%d", param->adv_data_raw_cmpl.status);
+				failStart(ESP_FAIL);
+				break;
+			}
+			nextStartStep();
 			break;
 		}
-		case ESP_GAP_BLE_SCAN_RSP_DATA_SET_COMPLETE_EVT: {
-			// m_semaphoreSetAdv.give();
+		case ESP_GAP_BLE_SCAN_RSP_DATA_SET_COMPLETE_EVT:
+		case ESP_GAP_BLE_SCAN_RSP_DATA_RAW_SET_COMPLETE_EVT: {
+			if (m_advState != ADV_STATE_SETTING_SCAN_RSP) break;
+			if (param->scan_rsp_data_raw_cmpl.status != ESP_BT_STATUS_SUCCESS) {
+				ESP_LOGE(LOG_TAG, "Setting scan response data failed: status=%d", param->scan_rsp_data_raw_cmpl.status);
+				failStart(ESP_FAIL);
+				break;
+			}
+			nextStartStep();
 			break;
 		}
 		case ESP_GAP_BLE_ADV_START_COMPLETE_EVT: {
-			// m_semaphoreSetAdv.give();
+			bool starting = m_advState == ADV_STATE_STARTING;
+			if (param->adv_start_cmpl.status != ESP_BT_STATUS_SUCCESS) {
+				ESP_LOGE(LOG_TAG, "Starting advertising failed: status=%d", param->adv_start_cmpl.status);
+				if (starting) failStart(ESP_FAIL);
+				break;
+			}
+			m_advState = ADV_STATE_ACTIVE;
+			if (starting) completeStart(ESP_OK);
 			break;
 		}
 		case ESP_GAP_BLE_ADV_STOP_COMPLETE_EVT: {
 			ESP_LOGI(LOG_TAG, "STOP advertising");
-			start();
+			portENTER_CRITICAL(&m_startMux);
+			bool restart = m_restartPending;
+			m_restartPending = false;
+			if (restart) {
+				// Restart with the intervals of the new policy step; the data is unchanged.
+				m_startSteps = 0;
+				m_advState   = ADV_STATE_STARTING;
+			} else if (m_advState == ADV_STATE_STOPPING || m_advState == ADV_STATE_ACTIVE) {
+				m_advState = ADV_STATE_IDLE;
+			}
+			portEXIT_CRITICAL(&m_startMux);
+			if (restart) nextStartStep();
 			break;
 		}
 		default:
 			break;
 	}
-}
+} // handleGAPEvent
 
 
 #endif /* CONFIG_BT_ENABLED */
@@ -13,6 +13,7 @@
 #include "BLEUUID.h"
 #include <vector>
 #include "FreeRTOS.h"
+#include <freertos/timers.h>
 
 /**
  * @brief Advertisement data set by the programmer to be published by the %BLE server.
@@ -39,6 +40,141 @@ private:
 };   // BLEAdvertisementData
 
 
+/**
+ * @brief An advertisement payload built in place in a fixed 31 byte buffer.
+ *
+ * Unlike BLEAdvertisementData, no heap storage is used.  Each field is encoded directly into the buffer
+ * and every setter reports whether the field fitted.  A field that does not fit is not written at all
+ * and the number of bytes it would have needed is accumulated in getOverflow() so the caller can tell
+ * how far over budget the advert is.  The buffer is handed to the ESP-IDF as is, without a copy.
+ */
+class BLEAdvertisementPayload {
+public:
+	BLEAdvertisementPayload();
+	bool     addField(uint8_t type, const uint8_t* pData, size_t length);
+	bool     addRaw(const uint8_t* pData, size_t length);
+	void     clear();
+	uint8_t* findField(uint8_t type, const uint8_t* pPrefix, size_t prefixLength, size_t* pLength);
+	bool     patchField(uint8_t type, size_t offset, const uint8_t* pData, size_t length);
+	bool     patchServiceData(BLEUUID uuid, size_t offset, const uint8_t* pData, size_t length);
+	bool     setAppearance(uint16_t appearance);
+	bool     setCompleteServices(BLEUUID uuid);
+	bool     setFlags(uint8_t flags);
+	bool     setManufacturerData(const uint8_t* pData, size_t length);
+	bool     setName(const char* name);
+	bool     setName(const char* name, size_t length);
+	bool     setPartialServices(BLEUUID uuid);
+	bool     setServiceData(BLEUUID uuid, const uint8_t* pData, size_t length);
+	bool     setShortName(const char* name, size_t length);
+	bool     setTxPower(int8_t txPower);
+
+	const uint8_t* getData() const    { return m_data; }
+	uint8_t        getLength() const  { return m_length; }
+	uint8_t        getFree() const    { return ESP_BLE_ADV_DATA_LEN_MAX - m_length; }
+	uint16_t       getOverflow() const { return m_overflow; }
+	bool           hasOverflowed() const { return m_overflow != 0; }
+
+private:
+	uint8_t* reserveField(uint8_t type, size_t length);
+	bool     setServices(BLEUUID uuid, bool complete);
+
+	uint8_t  m_data[ESP_BLE_ADV_DATA_LEN_MAX];
+	uint8_t  m_length;     // Bytes of m_data in use.
+	uint16_t m_overflow;   // Bytes of rejected fields.
+}; // BLEAdvertisementPayload
+
+
+/*
+ * Compile time advertisement encoding.
+ *
+ * A static advert can be described as a list of field types which are encoded by the compiler into a
+ * constant byte array placed in flash.  For example:
+ *
+ *   typedef BLEStaticAdvertisement<
+ *     BLEAdvFlags<ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT>,
+ *     BLEAdvService16<0x180F>,
+ *     BLEAdvName<'E', 'S', 'P'>
+ *   > MyAdvert;
+ *
+ *   pAdvertising->setAdvertisementData(MyAdvert::data, MyAdvert::length);
+ *
+ * An advert that would exceed 31 bytes fails to compile.
+ */
+template<uint8_t... Bytes>
+struct BLEAdvBytes {
+	static constexpr size_t  length = sizeof...(Bytes);
+	static constexpr uint8_t data[sizeof...(Bytes) > 0 ? sizeof...(Bytes) : 1] = { Bytes... };
+};
+template<uint8_t... Bytes>
+constexpr uint8_t BLEAdvBytes<Bytes...>::data[sizeof...(Bytes) > 0 ? sizeof...(Bytes) : 1];
+
+template<typename... Fields> struct BLEAdvConcat;
+template<> struct BLEAdvConcat<> {
+	typedef BLEAdvBytes<> type;
+};
+template<uint8_t... A> struct BLEAdvConcat<BLEAdvBytes<A...>> {
+	typedef BLEAdvBytes<A...> type;
+};
+template<uint8_t... A, uint8_t... B, typename... Rest>
+struct BLEAdvConcat<BLEAdvBytes<A...>, BLEAdvBytes<B...>, Rest...> : BLEAdvConcat<BLEAdvBytes<A..., B...>, Rest...> {
+};
+
+template<uint8_t Type, uint8_t... Data>
+using BLEAdvField = BLEAdvBytes<(uint8_t) (sizeof...(Data) + 1), Type, Data...>;
+
+template<uint8_t Flags>
+using BLEAdvFlags = BLEAdvField<ESP_BLE_AD_TYPE_FLAG, Flags>;
+
+template<uint16_t Appearance>
+using BLEAdvAppearance = BLEAdvField<ESP_BLE_AD_TYPE_APPEARANCE, (uint8_t) (Appearance & 0xff), (uint8_t) (Appearance >> 8)>;
+
+template<int8_t TxPower>
+using BLEAdvTxPower = BLEAdvField<ESP_BLE_AD_TYPE_TX_PWR, (uint8_t) TxPower>;
+
+template<uint16_t UUID>
+using BLEAdvService16 = BLEAdvField<ESP_BLE_AD_TYPE_16SRV_CMPL, (uint8_t) (UUID & 0xff), (uint8_t) (UUID >> 8)>;
+
+template<char... Name>
+using BLEAdvName = BLEAdvField<ESP_BLE_AD_TYPE_NAME_CMPL, (uint8_t) Name...>;
+
+template<char... Name>
+using BLEAdvShortName = BLEAdvField<ESP_BLE_AD_TYPE_NAME_SHORT, (uint8_t) Name...>;
+
+template<uint16_t CompanyId, uint8_t... Data>
+using BLEAdvManufacturer = BLEAdvField<ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE, (uint8_t) (CompanyId & 0xff), (uint8_t) (CompanyId >> 8), Data...>;
+
+template<uint16_t UUID, uint8_t... Data>
+using BLEAdvServiceData16 = BLEAdvField<ESP_BLE_AD_TYPE_SERVICE_DATA, (uint8_t) (UUID & 0xff), (uint8_t) (UUID >> 8), Data...>;
+
+template<typename... Fields>
+struct BLEStaticAdvertisement : BLEAdvConcat<Fields...>::type {
+	static_assert(BLEAdvConcat<Fields...>::type::length <= ESP_BLE_ADV_DATA_LEN_MAX, "Advertisement payload exceeds 31 bytes");
+};
+
+
+/**
+ * @brief One step of an advertising interval policy.
+ */
+typedef struct {
+	uint16_t minInterval;   // Minimum advertising interval in units of 0.625ms.
+	uint16_t maxInterval;   // Maximum advertising interval in units of 0.625ms.
+	uint32_t duration;      // Milliseconds before moving to the next step; 0 holds this step.
+} ble_adv_interval_step_t;
+
+
+/**
+ * @brief Observed time (in microseconds) from the start of advertising to a connection.
+ */
+typedef struct {
+	uint32_t count;     // Number of connections measured.
+	uint32_t last;      // Latency of the most recent connection.
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;     // Sum of all latencies; total / count is the mean.
+	uint8_t  lastStep;  // Interval policy step that was active at the most recent connection.
+} ble_adv_connect_metrics_t;
+
+
 /**
  * @brief Perform and manage %BLE advertising.
  *
@@ -49,14 +185,20 @@ public:
 	BLEAdvertising();
 	void addServiceUUID(BLEUUID serviceUUID);
 	void addServiceUUID(const char* serviceUUID);
-	void start();
+	std::vector<BLEUUID> getUnplacedServiceUUIDs();
+	bool start();
 	void stop();
+	bool isAdvertising();
 	void setAppearance(uint16_t appearance);
 	void setMaxInterval(uint16_t maxinterval);
 	void setMinInterval(uint16_t mininterval);
 	void setAdvertisementData(BLEAdvertisementData& advertisementData);
+	void setAdvertisementData(const BLEAdvertisementPayload& payload);
+	void setAdvertisementData(const uint8_t* pData, size_t length);
 	void setScanFilter(bool scanRequertWhitelistOnly, bool connectWhitelistOnly);
 	void setScanResponseData(BLEAdvertisementData& advertisementData);
+	void setScanResponseData(const BLEAdvertisementPayload& payload);
+	void setScanResponseData(const uint8_t* pData, size_t length);
 	void setPrivateAddress(esp_ble_addr_type_t type = BLE_ADDR_TYPE_RANDOM);
 
 	void handleGAPEvent(esp_gap_ble_cb_event_t  event, esp_ble_gap_cb_param_t* param);
@@ -64,14 +206,85 @@ public:
 	void setMaxPreferred(uint16_t);
 	void setScanResponse(bool);
 
+	esp_err_t updateField(uint8_t type, size_t offset, const uint8_t* pData, size_t length);
+	esp_err_t updateManufacturerData(size_t offset, const uint8_t* pData, size_t length);
+	esp_err_t updateServiceData(BLEUUID uuid, size_t offset, const uint8_t* pData, size_t length);
+	void      setMinUpdateInterval(uint32_t ms);
+
+	bool      setIntervalPolicy(const ble_adv_interval_step_t* pSteps, uint8_t count);
+	void      setIntervalPolicy(uint16_t fastMin, uint16_t fastMax, uint32_t fastDuration, uint16_t slowMin, uint16_t slowMax);
+	void      boost();
+	uint8_t   getIntervalStep();
+	ble_adv_connect_metrics_t getConnectMetrics();
+
+	static const uint8_t MAX_INTERVAL_STEPS = 4;
+
+	static size_t packServiceUUIDs(std::vector<BLEUUID>& uuids, BLEAdvertisementPayload* pAdvertisement,
+		BLEAdvertisementPayload* pScanResponse, std::vector<BLEUUID>* pUnplaced);
+
 private:
+	friend class BLEAdvertisingScheduler;
+	friend class BLEDevice;
+
+	void buildPayloads(BLEAdvertisementPayload* pAdvertisement, BLEAdvertisementPayload* pScanResponse);
+	void invalidateConfig();
+	void nextStartStep();
+	void applyIntervalStep(uint8_t step);
+	void onConnect();
+	void stopAdvertising();
+	static void policyTimerCallback(TimerHandle_t timer);
+	void failStart(esp_err_t errRc);
+	void completeStart(esp_err_t errRc);
+	bool isStarting();
+	void restart();
+	esp_err_t sendPayloads(uint8_t which);
+	esp_err_t flushUpdate();
+	static void updateTimerCallback(TimerHandle_t timer);
+
 	esp_ble_adv_data_t   m_advData;
 	esp_ble_adv_params_t m_advParams;
-	std::vector<BLEUUID> m_serviceUUIDs;
+	std::vector<BLEUUID> m_serviceUUIDs;          // Services to advertise, highest priority first.
+	std::vector<BLEUUID> m_unplacedServiceUUIDs;  // Services that did not fit at the last start().
 	bool                 m_customAdvData = false;  // Are we using custom advertising data?
 	bool                 m_customScanResponseData = false;  // Are we using custom scan response data?
-	FreeRTOS::Semaphore  m_semaphoreSetAdv = FreeRTOS::Semaphore("startAdvert");
+	FreeRTOS::Semaphore  m_semaphoreSetAdv = FreeRTOS::Semaphore("startAdvert");   // Released when start() completes.
+	volatile uint8_t     m_advState = ADV_STATE_IDLE;
+	uint8_t              m_startSteps = 0;       // Payloads start() still has to hand over (UPDATE_ADV | UPDATE_SCAN_RSP).
+	TaskHandle_t         m_btTask = nullptr;     // The task GAP events are delivered on.
+	volatile bool        m_startWaiting = false; // Has an application task taken m_semaphoreSetAdv and is it waiting?
+	volatile bool        m_startDeferred = false;   // Was start() called while a start sequence was in flight?
+	uint8_t              m_deferredSteps = 0;    // Payloads the deferred start has to hand over.
+	bool                 m_deferredRestart = false; // Must the deferred start restart live advertising for new parameters?
+	portMUX_TYPE         m_startMux = portMUX_INITIALIZER_UNLOCKED;
+
+	ble_adv_interval_step_t m_intervalSteps[MAX_INTERVAL_STEPS];
+	uint8_t              m_intervalStepCount = 0;   // 0 when no interval policy is set.
+	uint8_t              m_intervalStep = 0;        // The step being advertised.
+	volatile bool        m_restartPending = false;  // Restart advertising when the stop completes.
+	TimerHandle_t        m_policyTimer = nullptr;
+	int64_t              m_advStartTime = 0;        // esp_timer time start() was called, 0 once connected.
+	ble_adv_connect_metrics_t m_connectMetrics = {};
 	bool				m_scanResp = true;
+	bool                 m_configDirty = true;   // Must the generated payloads be encoded again?
+	bool                 m_configSent = false;   // Does the controller hold the cached payloads?
+
+	BLEAdvertisementPayload m_advPayload;            // The advertisement last handed to the ESP-IDF.
+	BLEAdvertisementPayload m_scanResponsePayload;   // The scan response last handed to the ESP-IDF.
+	portMUX_TYPE         m_payloadMux = portMUX_INITIALIZER_UNLOCKED;
+	uint8_t              m_pendingUpdate = 0;        // Payloads patched but not yet sent (UPDATE_ADV | UPDATE_SCAN_RSP).
+	uint32_t             m_minUpdateInterval = 100;  // Minimum milliseconds between payload updates.
+	uint32_t             m_lastUpdateTime = 0;
+	TimerHandle_t        m_updateTimer = nullptr;
+
+	static const uint8_t ADV_STATE_IDLE             = 0;
+	static const uint8_t ADV_STATE_SETTING_DATA     = 1;
+	static const uint8_t ADV_STATE_SETTING_SCAN_RSP = 2;
+	static const uint8_t ADV_STATE_STARTING         = 3;
+	static const uint8_t ADV_STATE_ACTIVE           = 4;
+	static const uint8_t ADV_STATE_STOPPING         = 5;
+
+	static const uint8_t UPDATE_ADV      = 0x01;
+	static const uint8_t UPDATE_SCAN_RSP = 0x02;
 
 };
 #endif /* CONFIG_BT_ENABLED */
@@ -0,0 +1,421 @@
+/*
+ * BLEAdvertisingScheduler.cpp
+ *
+ *  Time multiplexing of several advertisements over the single legacy advertising set.
+ */
+#include "sdkconfig.h"
+#if defined(CONFIG_BT_ENABLED)
+#include <string.h>
+#include <esp_err.h>
+#include <esp_timer.h>
+#include "BLEAdvertisingScheduler.h"
+#include "BLEEddystoneTLM.h"
+#include "GeneralUtils.h"
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_ARDUHAL_ESP_LOG)
+#include "esp32-hal-log.h"
+#define LOG_TAG ""
+#else
+#include "esp_log.h"
+static const char* LOG_TAG = "BLEAdvertisingScheduler";
+#endif
+
+
+/**
+ * @brief Construct a scheduler driving the given advertising object.
+ * @param [in] pAdvertising The advertising object, normally BLEDevice::getAdvertising().
+ */
+BLEAdvertisingScheduler::BLEAdvertisingScheduler(BLEAdvertising* pAdvertising) {
+	m_pAdvertising    = pAdvertising;
+	m_current         = 0;
+	m_running         = false;
+	m_advertising     = false;
+	m_scanResponseSet = false;
+	m_rotations       = 0;
+	m_advEvents       = 0;
+	m_eventFraction   = 0;
+	m_setShownAt      = 0;
+	m_timer           = nullptr;
+	m_pVoltageProvider     = nullptr;
+	m_pTemperatureProvider = nullptr;
+	memset(&m_activeParams, 0, sizeof(m_activeParams));
+	memset(&m_savedParams, 0, sizeof(m_savedParams));
+	m_savedCustomAdvData          = false;
+	m_savedCustomScanResponseData = false;
+} // BLEAdvertisingScheduler
+
+
+BLEAdvertisingScheduler::~BLEAdvertisingScheduler() {
+	if (m_timer != nullptr) {
+		::xTimerStop(m_timer, portMAX_DELAY);
+		::xTimerDelete(m_timer, portMAX_DELAY);
+	}
+} // ~BLEAdvertisingScheduler
+
+
+/**
+ * @brief Add an advertisement to the rotation.
+ *
+ * Sets should be added before start() is called.  The own address type, channel map and filter policy
+ * are taken from the advertising object at the time the set is added.
+ *
+ * @param [in] advertisement The encoded advertisement.
+ * @param [in] dwell How long the set is advertised before moving to the next, in milliseconds.
+ * @param [in] minInterval The minimum advertising interval while the set is shown, in units of 0.625ms.
+ * @param [in] maxInterval The maximum advertising interval while the set is shown, in units of 0.625ms.
+ * @param [in] type The advertising type, e.g. ADV_TYPE_IND for a connectable advert.
+ * @return The index of the new set.
+ */
+int BLEAdvertisingScheduler::addSet(const BLEAdvertisementPayload& advertisement, uint32_t dwell,
+		uint16_t minInterval, uint16_t maxInterval, esp_ble_adv_type_t type) {
+	ble_adv_set_t set;
+	set.advertisement      = advertisement;
+	set.hasScanResponse    = false;
+	set.telemetry          = false;
+	set.dwell              = dwell > 0 ? dwell : 1;
+	set.params             = m_pAdvertising->m_advParams;
+	set.params.adv_int_min = minInterval;
+	set.params.adv_int_max = maxInterval;
+	set.params.adv_type    = type;
+	if (advertisement.hasOverflowed()) {
+		ESP_LOGW(LOG_TAG, "addSet: advertisement dropped %d bytes of fields that did not fit", advertisement.getOverflow());
+	}
+	m_sets.push_back(set);
+	return m_sets.size() - 1;
+} // addSet
+
+
+/**
+ * @brief Add an already encoded advertisement, such as a BLEStaticAdvertisement, to the rotation.
+ * @param [in] pData The encoded advertisement.
+ * @param [in] length The length of the advertisement.
+ * @param [in] dwell How long the set is advertised before moving to the next, in milliseconds.
+ * @param [in] minInterval The minimum advertising interval while the set is shown, in units of 0.625ms.
+ * @param [in] maxInterval The maximum advertising interval while the set is shown, in units of 0.625ms.
+ * @param [in] type The advertising type.
+ * @return The index of the new set or -1 if the advertisement is longer than 31 bytes.
+ */
+int BLEAdvertisingScheduler::addSet(const uint8_t* pData, size_t length, uint32_t dwell,
+		uint16_t minInterval, uint16_t maxInterval, esp_ble_adv_type_t type) {
+	BLEAdvertisementPayload advertisement;
+	if (!advertisement.addRaw(pData, length)) {
+		ESP_LOGE(LOG_TAG, "addSet: advertisement of %d bytes is too long", length);
+		return -1;
+	}
+	return addSet(advertisement, dwell, minInterval, maxInterval, type);
+} // addSet
+
+
+/**
+ * @brief Add an Eddystone TLM frame owned by the scheduler to the rotation.
+ *
+ * The frame is refreshed every time it comes round; see refreshTelemetry().
+ *
+ * @param [in] dwell How long the frame is advertised before moving to the next set, in milliseconds.
+ * @param [in] minInterval The minimum advertising interval while the frame is shown, in units of 0.625ms.
+ * @param [in] maxInterval The maximum advertising interval while the frame is shown, in units of 0.625ms.
+ * @return The index of the new set.
+ */
+int BLEAdvertisingScheduler::addTelemetrySet(uint32_t dwell, uint16_t minInterval, uint16_t maxInterval) {
+	// [0x20] [version] [VBATT 2] [TEMP 2] [ADV_CNT 4] [SEC_CNT 4], all big endian.
+	uint8_t frame[14] = { EDDYSTONE_TLM_FRAME_TYPE, 0x00 };
+	uint16_t serviceUUID = 0xFEAA;
+	BLEAdvertisementPayload advertisement;
+	advertisement.setFlags(ESP_BLE_ADV_FLAG_GEN_DISC | ESP_BLE_ADV_FLAG_BREDR_NOT_SPT);
+	advertisement.setCompleteServices(BLEUUID(serviceUUID));
+	advertisement.setServiceData(BLEUUID(serviceUUID), frame, sizeof(frame));
+	int index = addSet(advertisement, dwell, minInterval, maxInterval, ADV_TYPE_NONCONN_IND);
+	m_sets[index].telemetry = true;
+	return index;
+} // addTelemetrySet
+
+
+/**
+ * @brief Register the provider of the battery voltage reported in the TLM frame.
+ * @param [in] pProvider Returns the voltage in mV or 0 if it is not known.
+ */
+void BLEAdvertisingScheduler::setVoltageProvider(ble_tlm_voltage_provider_t pProvider) {
+	m_pVoltageProvider = pProvider;
+} // setVoltageProvider
+
+
+/**
+ * @brief Register the provider of the temperature reported in the TLM frame.
+ * @param [in] pProvider Returns the temperature in degrees C.
+ */
+void BLEAdvertisingScheduler::setTemperatureProvider(ble_tlm_temperature_provider_t pProvider) {
+	m_pTemperatureProvider = pProvider;
+} // setTemperatureProvider
+
+
+/**
+ * @brief Get the estimated number of advertising events since start().
+ *
+ * The controller does not report individual advertising events so the count is derived from the time
+ * each set was on air and its interval.  Each event takes the mean of the set's interval range plus the
+ * mean random advDelay of 5ms.
+ *
+ * @return The estimated number of advertising events.
+ */
+uint32_t BLEAdvertisingScheduler::getAdvertisingEvents() {
+	return m_advEvents;
+} // getAdvertisingEvents
+
+
+/**
+ * @brief Add the advertising events of the set going off air to the count.
+ *
+ * A set is rarely on air for a whole number of events.  The part event left over is carried to the next
+ * set rather than dropped, so the count does not fall behind by up to one event per switch.
+ */
+void BLEAdvertisingScheduler::countEvents() {
+	if (!m_advertising || m_setShownAt == 0) return;
+	int64_t  onAir    = esp_timer_get_time() - m_setShownAt;
+	uint32_t interval = (m_activeParams.adv_int_min + m_activeParams.adv_int_max) * 625 / 2 + 5000;   // Microseconds.
+	uint32_t fraction = m_eventFraction + (uint32_t) (((onAir % interval) << 16) / interval);
+	m_advEvents     += onAir / interval + (fraction >> 16);
+	m_eventFraction  = fraction & 0xffff;
+} // countEvents
+
+
+/**
+ * @brief Bring the TLM frame of a set up to date.
+ *
+ * Only the fields whose encoding changed are written to the payload.
+ *
+ * @param [in] set The telemetry set.
+ */
+void BLEAdvertisingScheduler::refreshTelemetry(ble_adv_set_t& set) {
+	static const uint8_t fieldOffsets[4] = { 2, 4, 6, 10 };
+	static const uint8_t fieldLengths[4] = { 2, 2, 4, 4 };
+	static const uint8_t serviceUUID[2]  = { 0xAA, 0xFE };
+
+	size_t   length;
+	uint8_t* pFrame = set.advertisement.findField(ESP_BLE_AD_TYPE_SERVICE_DATA, serviceUUID, sizeof(serviceUUID), &length);
+	if (pFrame == nullptr || length < 14) return;
+
+	uint16_t volt = m_pVoltageProvider != nullptr ? m_pVoltageProvider() : 0;
+	int16_t  temp = (int16_t) 0x8000;   // Not supported.
+	if (m_pTemperatureProvider != nullptr) {
+		temp = (int16_t) (m_pTemperatureProvider() * 256.0f);   // Signed 8.8 fixed point.
+	}
+	uint32_t seconds = esp_timer_get_time() / 100000;   // Uptime in 0.1s units.
+
+	uint8_t frame[14];
+	frame[2]  = volt >> 8;
+	frame[3]  = volt;
+	frame[4]  = (uint16_t) temp >> 8;
+	frame[5]  = temp;
+	frame[6]  = m_advEvents >> 24;
+	frame[7]  = m_advEvents >> 16;
+	frame[8]  = m_advEvents >> 8;
+	frame[9]  = m_advEvents;
+	frame[10] = seconds >> 24;
+	frame[11] = seconds >> 16;
+	frame[12] = seconds >> 8;
+	frame[13] = seconds;
+
+	for (int i = 0; i < 4; i++) {
+		if (memcmp(pFrame + fieldOffsets[i], frame + fieldOffsets[i], fieldLengths[i]) != 0) {
+			memcpy(pFrame + fieldOffsets[i], frame + fieldOffsets[i], fieldLengths[i]);
+		}
+	}
+} // refreshTelemetry
+
+
+/**
+ * @brief Give a set a scan response.
+ * @param [in] set The index of the set.
+ * @param [in] scanResponse The encoded scan response.
+ * @return True on success, false if there is no such set.
+ */
+bool BLEAdvertisingScheduler::setScanResponse(int set, const BLEAdvertisementPayload& scanResponse) {
+	if (set < 0 || (size_t) set >= m_sets.size()) return false;
+	m_sets[set].scanResponse    = scanResponse;
+	m_sets[set].hasScanResponse = true;
+	return true;
+} // setScanResponse
+
+
+/**
+ * @brief Get the encoded advertisement of a set.
+ *
+ * Fields of the advertisement may be patched in place (see BLEAdvertisementPayload::patchField()); the
+ * change is advertised the next time the set comes round.
+ *
+ * @param [in] set The index of the set.
+ * @return The advertisement or nullptr if there is no such set.
+ */
+BLEAdvertisementPayload* BLEAdvertisingScheduler::getAdvertisement(int set) {
+	if (set < 0 || (size_t) set >= m_sets.size()) return nullptr;
+	return &m_sets[set].advertisement;
+} // getAdvertisement
+
+
+/**
+ * @brief Stop the rotation and remove all the sets.
+ */
+void BLEAdvertisingScheduler::clear() {
+	stop();
+	m_sets.clear();
+} // clear
+
+
+/**
+ * @brief Get the index of the set being advertised.
+ * @return The index of the current set or -1 if the scheduler is not running.
+ */
+int BLEAdvertisingScheduler::getCurrentSet() {
+	return m_running ? (int) m_current : -1;
+} // getCurrentSet
+
+
+/**
+ * @brief Get the number of complete passes through all the sets since start().
+ * @return The number of rotations.
+ */
+uint32_t BLEAdvertisingScheduler::getRotations() {
+	return m_rotations;
+} // getRotations
+
+
+/**
+ * @brief Is the scheduler rotating the sets?
+ * @return True if running.
+ */
+bool BLEAdvertisingScheduler::isRunning() {
+	return m_running;
+} // isRunning
+
+
+/**
+ * @brief Start advertising the first set and rotating through the others.
+ * @return True on success, false if there are no sets or the timer could not be created.
+ */
+bool BLEAdvertisingScheduler::start() {
+	ESP_LOGD(LOG_TAG, ">> start: %d sets", m_sets.size());
+	if (m_sets.empty()) {
+		ESP_LOGE(LOG_TAG, "<< start: no advertisement sets");
+		return false;
+	}
+	if (m_timer == nullptr) {
+		m_timer = ::xTimerCreate("advRotate", 1, pdFALSE, this, timerCallback);
+		if (m_timer == nullptr) {
+			ESP_LOGE(LOG_TAG, "<< start: unable to create timer");
+			return false;
+		}
+	}
+	// Remember what the advertising object advertised so stop() can give it back.
+	portENTER_CRITICAL(&m_pAdvertising->m_payloadMux);
+	m_savedAdvertisement = m_pAdvertising->m_advPayload;
+	m_savedScanResponse  = m_pAdvertising->m_scanResponsePayload;
+	portEXIT_CRITICAL(&m_pAdvertising->m_payloadMux);
+	m_savedParams                 = m_pAdvertising->m_advParams;
+	m_savedCustomAdvData          = m_pAdvertising->m_customAdvData;
+	m_savedCustomScanResponseData = m_pAdvertising->m_customScanResponseData;
+
+	m_running     = true;
+	m_advertising = false;
+	m_rotations   = 0;
+	m_advEvents     = 0;
+	m_eventFraction = 0;
+	m_setShownAt    = 0;
+	showSet(0);
+	ESP_LOGD(LOG_TAG, "<< start");
+	return true;
+} // start
+
+
+/**
+ * @brief Stop rotating and stop advertising.
+ *
+ * The advertising object gets back the data and parameters it had before start(), so its next start()
+ * (including the restart after a disconnect) advertises them rather than the last set.
+ */
+void BLEAdvertisingScheduler::stop() {
+	if (!m_running) return;
+	m_running = false;
+	::xTimerStop(m_timer, 0);
+	countEvents();
+	m_advertising = false;
+	m_pAdvertising->stop();
+	restoreAdvertising();
+} // stop
+
+
+/**
+ * @brief Give the advertising object back the configuration saved by start().
+ *
+ * The controller still holds the last set, so the restored payloads are marked to be handed over again
+ * at the next start().
+ */
+void BLEAdvertisingScheduler::restoreAdvertising() {
+	portENTER_CRITICAL(&m_pAdvertising->m_payloadMux);
+	m_pAdvertising->m_advPayload          = m_savedAdvertisement;
+	m_pAdvertising->m_scanResponsePayload = m_savedScanResponse;
+	portEXIT_CRITICAL(&m_pAdvertising->m_payloadMux);
+	m_pAdvertising->m_advParams              = m_savedParams;
+	m_pAdvertising->m_customAdvData          = m_savedCustomAdvData;
+	m_pAdvertising->m_customScanResponseData = m_savedCustomScanResponseData;
+	m_pAdvertising->invalidateConfig();
+} // restoreAdvertising
+
+
+/**
+ * @brief Advertise a set and arm the timer for its dwell time.
+ * @param [in] index The index of the set to advertise.
+ */
+void BLEAdvertisingScheduler::showSet(size_t index) {
+	ble_adv_set_t& set = m_sets[index];
+	countEvents();
+	m_current = index;
+	if (set.telemetry) {
+		refreshTelemetry(set);
+	}
+
+	m_pAdvertising->setAdvertisementData(set.advertisement.getData(), set.advertisement.getLength());
+	if (set.hasScanResponse) {
+		m_pAdvertising->setScanResponseData(set.scanResponse.getData(), set.scanResponse.getLength());
+	} else if (m_scanResponseSet) {
+		static const uint8_t empty = 0;
+		m_pAdvertising->setScanResponseData(&empty, 0);   // Don't answer scans with another set's response.
+	}
+	m_scanResponseSet = set.hasScanResponse && set.scanResponse.getLength() > 0;
+
+	// The data change takes effect while advertising.  Only a change of type or interval, or the
+	// controller having stopped (a central connected to a connectable set), needs the advertising to be
+	// (re)started, which the advertising object sequences on the GAP events.
+	portENTER_CRITICAL(&m_pAdvertising->m_startMux);
+	bool live = m_pAdvertising->m_advState == BLEAdvertising::ADV_STATE_ACTIVE || m_pAdvertising->isStarting();
+	portEXIT_CRITICAL(&m_pAdvertising->m_startMux);
+	if (!m_advertising || !live || memcmp(&m_activeParams, &set.params, sizeof(m_activeParams)) != 0) {
+		m_pAdvertising->m_advParams = set.params;
+		m_pAdvertising->restart();
+		m_activeParams = set.params;
+		m_advertising  = true;
+	}
+	m_setShownAt = esp_timer_get_time();
+
+	// Also starts the timer.  Called from the timer task, so the command must not block.
+	TickType_t ticks = pdMS_TO_TICKS(set.dwell);
+	::xTimerChangePeriod(m_timer, ticks > 0 ? ticks : 1, 0);
+} // showSet
+
+
+/**
+ * @brief Move on to the next set when the dwell time of the current one has passed.
+ * @param [in] timer The timer that expired; its ID is the scheduler.
+ */
+/* STATIC */ void BLEAdvertisingScheduler::timerCallback(TimerHandle_t timer) {
+	BLEAdvertisingScheduler* pScheduler = (BLEAdvertisingScheduler*) ::pvTimerGetTimerID(timer);
+	if (!pScheduler->m_running) return;
+	size_t next = pScheduler->m_current + 1;
+	if (next >= pScheduler->m_sets.size()) {
+		next = 0;
+		pScheduler->m_rotations++;
+	}
+	pScheduler->showSet(next);
+} // timerCallback
+
+
+#endif /* CONFIG_BT_ENABLED */
@@ -0,0 +1,98 @@
+/*
+ * BLEAdvertisingScheduler.h
+ *
+ *  Time multiplexing of several advertisements over the single legacy advertising set.
+ */
+
+#ifndef COMPONENTS_CPP_UTILS_BLEADVERTISINGSCHEDULER_H_
+#define COMPONENTS_CPP_UTILS_BLEADVERTISINGSCHEDULER_H_
+#include "sdkconfig.h"
+#if defined(CONFIG_BT_ENABLED)
+#include <esp_gap_ble_api.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/timers.h>
+#include <vector>
+#include "BLEAdvertising.h"
+
+typedef uint16_t (*ble_tlm_voltage_provider_t)();       // Battery voltage in mV, 0 if unknown.
+typedef float    (*ble_tlm_temperature_provider_t)();   // Temperature in degrees C.
+
+/**
+ * @brief One advertisement in a rotation.
+ */
+typedef struct {
+	BLEAdvertisementPayload advertisement;    // Encoded advertisement.
+	BLEAdvertisementPayload scanResponse;     // Encoded scan response (if hasScanResponse).
+	bool                    hasScanResponse;
+	bool                    telemetry;        // Is this the Eddystone TLM frame owned by the scheduler?
+	uint32_t                dwell;            // Milliseconds the set is advertised before the next one.
+	esp_ble_adv_params_t    params;           // Advertising type and interval of the set.
+} ble_adv_set_t;
+
+
+/**
+ * @brief Rotate through a list of pre-encoded advertisements.
+ *
+ * The legacy controller advertises a single set at a time.  The scheduler shares it between several
+ * advertisements (for example an iBeacon, an Eddystone URL, an Eddystone TLM and a connectable advert)
+ * by advertising each for its dwell time in turn.  Every set is encoded once when it is added.  Switching
+ * to the next set only hands its payloads to the controller; advertising is restarted only when the
+ * next set has a different type or interval from the one before it.
+ *
+ * The scheduler can also own an Eddystone TLM frame (see addTelemetrySet()).  Each time the frame comes
+ * round its advertising count and uptime are brought up to date, the voltage and temperature are pulled
+ * from the registered providers and only the bytes that changed are patched in the encoded frame.
+ */
+class BLEAdvertisingScheduler {
+public:
+	BLEAdvertisingScheduler(BLEAdvertising* pAdvertising);
+	~BLEAdvertisingScheduler();
+	int      addSet(const BLEAdvertisementPayload& advertisement, uint32_t dwell,
+		uint16_t minInterval = 0x20, uint16_t maxInterval = 0x40, esp_ble_adv_type_t type = ADV_TYPE_NONCONN_IND);
+	int      addSet(const uint8_t* pData, size_t length, uint32_t dwell,
+		uint16_t minInterval = 0x20, uint16_t maxInterval = 0x40, esp_ble_adv_type_t type = ADV_TYPE_NONCONN_IND);
+	int      addTelemetrySet(uint32_t dwell, uint16_t minInterval = 0x20, uint16_t maxInterval = 0x40);
+	bool     setScanResponse(int set, const BLEAdvertisementPayload& scanResponse);
+	void     setTemperatureProvider(ble_tlm_temperature_provider_t pProvider);
+	void     setVoltageProvider(ble_tlm_voltage_provider_t pProvider);
+	uint32_t getAdvertisingEvents();
+	BLEAdvertisementPayload* getAdvertisement(int set);
+	void     clear();
+	int      getCurrentSet();
+	uint32_t getRotations();
+	bool     isRunning();
+	bool     start();
+	void     stop();
+
+private:
+	void        countEvents();
+	void        restoreAdvertising();
+	void        refreshTelemetry(ble_adv_set_t& set);
+	void        showSet(size_t index);
+	static void timerCallback(TimerHandle_t timer);
+
+	BLEAdvertising*            m_pAdvertising;
+	std::vector<ble_adv_set_t> m_sets;
+	size_t                     m_current;        // Index of the set being advertised.
+	bool                       m_running;
+	bool                       m_advertising;    // Has advertising been started with m_activeParams?
+	bool                       m_scanResponseSet;   // Was the last set's scan response non empty?
+	esp_ble_adv_params_t       m_activeParams;
+	uint32_t                   m_rotations;      // Completed passes through all the sets.
+	uint32_t                   m_advEvents;      // Estimated advertising events since start().
+	uint32_t                   m_eventFraction;  // Part event left over by the sets so far, in 1/65536 events.
+	int64_t                    m_setShownAt;     // esp_timer time the current set went on air.
+	ble_tlm_voltage_provider_t     m_pVoltageProvider;
+	ble_tlm_temperature_provider_t m_pTemperatureProvider;
+	TimerHandle_t              m_timer;
+
+	// The configuration of the advertising object before start(), given back by stop().
+	BLEAdvertisementPayload    m_savedAdvertisement;
+	BLEAdvertisementPayload    m_savedScanResponse;
+	esp_ble_adv_params_t       m_savedParams;
+	bool                       m_savedCustomAdvData;
+	bool                       m_savedCustomScanResponseData;
+}; // BLEAdvertisingScheduler
+
+#endif /* CONFIG_BT_ENABLED */
+#endif /* COMPONENTS_CPP_UTILS_BLEADVERTISINGSCHEDULER_H_ */
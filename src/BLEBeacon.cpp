@@ -53,6 +53,19 @@ int8_t BLEBeacon::getSignalPower() {
 	return m_beaconData.signalPower;
 }
 
+/**
+ * @brief Load the beacon from the manufacturer data of an advert without allocating.
+ * @param [in] pData The manufacturer data, starting with the company identifier.
+ * @param [in] length The length of the data.
+ * @return True if the data is an iBeacon record, false (leaving the beacon unchanged) otherwise.
+ */
+bool BLEBeacon::parse(const uint8_t* pData, size_t length) {
+	if (pData == nullptr || length != sizeof(m_beaconData)) return false;
+	if (pData[2] != 0x02 || pData[3] != 0x15) return false;   // iBeacon sub type and length.
+	memcpy(&m_beaconData, pData, sizeof(m_beaconData));
+	return true;
+} // parse
+
 /**
  * Set the raw data for the beacon record.
  */
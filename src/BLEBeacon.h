@@ -32,6 +32,7 @@ public:
 	uint16_t    getManufacturerId();
 	BLEUUID     getProximityUUID();
 	int8_t      getSignalPower();
+	bool        parse(const uint8_t* pData, size_t length);
 	void        setData(std::string data);
 	void        setMajor(uint16_t major);
 	void        setMinor(uint16_t minor);
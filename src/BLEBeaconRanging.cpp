@@ -0,0 +1,218 @@
+/*
+ * BLEBeaconRanging.cpp
+ *
+ *  Smoothed RSSI to distance estimation for iBeacons seen by a scan.
+ */
+#include "sdkconfig.h"
+#if defined(CONFIG_BT_ENABLED)
+#include <string.h>
+#include <math.h>
+#include <esp_timer.h>
+#include "BLEBeaconRanging.h"
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_ARDUHAL_ESP_LOG)
+#include "esp32-hal-log.h"
+#define LOG_TAG ""
+#else
+#include "esp_log.h"
+static const char* LOG_TAG = "BLEBeaconRanging";
+#endif
+
+#define IBEACON_DATA_LENGTH 25   // Company id, sub type, sub type length, id and measured power.
+
+
+/**
+ * @brief Construct an estimator.
+ * @param [in] pathLossExponent The path loss exponent; 2 in free space, 2.5 to 4 indoors.
+ * @param [in] measurementNoise The variance of a single RSSI reading in dB^2.
+ * @param [in] processNoise How fast the true RSSI is expected to wander, as a variance in dB^2 per second.
+ */
+BLEBeaconRanging::BLEBeaconRanging(float pathLossExponent, float measurementNoise, float processNoise) {
+	m_pathLossExponent     = pathLossExponent;
+	m_measurementNoise     = measurementNoise;
+	m_processNoise         = processNoise;
+	m_defaultMeasuredPower = -59;
+	m_count                = 0;
+} // BLEBeaconRanging
+
+
+/**
+ * @brief Forget every beacon.
+ */
+void BLEBeaconRanging::clear() {
+	portENTER_CRITICAL(&m_mux);
+	m_count = 0;
+	portEXIT_CRITICAL(&m_mux);
+} // clear
+
+
+/**
+ * @brief Find the entry of a beacon.
+ * @param [in] pId The proximity UUID, major and minor as advertised.
+ * @return The entry or nullptr if the beacon is not in the table.
+ */
+ble_beacon_range_t* BLEBeaconRanging::find(const uint8_t* pId) {
+	for (size_t i = 0; i < m_count; i++) {
+		if (memcmp(m_beacons[i].id, pId, BEACON_RANGING_ID_LENGTH) == 0) return &m_beacons[i];
+	}
+	return nullptr;
+} // find
+
+
+/**
+ * @brief Get the confidence of an entry's distance.
+ *
+ * The confidence is 1 / (1 + e) where e is the relative error of the distance implied by the standard
+ * deviation of the filtered RSSI, including the drift expected since the beacon was last heard.
+ *
+ * @param [in] entry The entry.
+ * @return The confidence, between 0 and 1.
+ */
+float BLEBeaconRanging::getConfidence(const ble_beacon_range_t& entry) {
+	float age      = (esp_timer_get_time() - entry.lastSeen) / 1000000.0;
+	float sigma    = sqrtf(entry.variance + m_processNoise * age);
+	float relError = sigma * 0.2302585f / m_pathLossExponent;   // ln(10) / (10 * n) per dB.
+	return 1.0 / (1.0 + relError);
+} // getConfidence
+
+
+/**
+ * @brief Return the number of beacons in the table.
+ * @return The number of beacons.
+ */
+size_t BLEBeaconRanging::getCount() {
+	return m_count;
+} // getCount
+
+
+/**
+ * @brief Get the estimated distance of an entry.
+ * @param [in] entry The entry.
+ * @return The distance in meters.
+ */
+float BLEBeaconRanging::getDistance(const ble_beacon_range_t& entry) {
+	return rssiToDistance(entry.rssi, entry.measuredPower, m_pathLossExponent);
+} // getDistance
+
+
+/**
+ * @brief Copy an entry of the table.
+ * @param [in] index The index of the entry, from 0 to getCount() - 1.
+ * @param [out] pEntry Receives a snapshot of the entry.
+ * @return True if the entry exists.
+ */
+bool BLEBeaconRanging::getEntry(size_t index, ble_beacon_range_t* pEntry) {
+	bool found = false;
+	portENTER_CRITICAL(&m_mux);
+	if (index < m_count) {
+		*pEntry = m_beacons[index];
+		found = true;
+	}
+	portEXIT_CRITICAL(&m_mux);
+	return found;
+} // getEntry
+
+
+/**
+ * @brief Get the estimated distance of a beacon.
+ * @param [in] proximityUUID The proximity UUID of the beacon.
+ * @param [in] major The major number of the beacon.
+ * @param [in] minor The minor number of the beacon.
+ * @param [out] pDistance Receives the distance in meters.
+ * @param [out] pConfidence Receives the confidence between 0 and 1 (optional).
+ * @return True if the beacon has been heard, false otherwise.
+ */
+bool BLEBeaconRanging::getRange(BLEUUID proximityUUID, uint16_t major, uint16_t minor, float* pDistance, float* pConfidence) {
+	uint8_t id[BEACON_RANGING_ID_LENGTH];
+	memcpy(id, proximityUUID.to128().getNative()->uuid.uuid128, 16);
+	id[16] = major >> 8;
+	id[17] = major;
+	id[18] = minor >> 8;
+	id[19] = minor;
+
+	ble_beacon_range_t entry;
+	bool found = false;
+	portENTER_CRITICAL(&m_mux);
+	ble_beacon_range_t* pEntry = find(id);
+	if (pEntry != nullptr) {
+		entry = *pEntry;
+		found = true;
+	}
+	portEXIT_CRITICAL(&m_mux);
+	if (!found) return false;
+
+	*pDistance = getDistance(entry);
+	if (pConfidence != nullptr) *pConfidence = getConfidence(entry);
+	return true;
+} // getRange
+
+
+/**
+ * @brief Convert an RSSI to a distance with the log distance path loss model.
+ * @param [in] rssi The RSSI in dBm.
+ * @param [in] measuredPower The RSSI at 1m in dBm.
+ * @param [in] pathLossExponent The path loss exponent.
+ * @return The distance in meters.
+ */
+/* STATIC */ float BLEBeaconRanging::rssiToDistance(float rssi, int8_t measuredPower, float pathLossExponent) {
+	return powf(10.0, (measuredPower - rssi) / (10.0 * pathLossExponent));
+} // rssiToDistance
+
+
+/**
+ * @brief Set the measured power assumed for beacons that advertise 0.
+ * @param [in] measuredPower The RSSI at 1m in dBm.  The default is -59.
+ */
+void BLEBeaconRanging::setDefaultMeasuredPower(int8_t measuredPower) {
+	m_defaultMeasuredPower = measuredPower;
+} // setDefaultMeasuredPower
+
+
+/**
+ * @brief Fold an advert into the estimate of the beacon that sent it.
+ * @param [in] pManufacturerData The manufacturer data of the advert, starting with the company identifier.
+ * @param [in] length The length of the manufacturer data.
+ * @param [in] rssi The RSSI of the advert.
+ * @return True if the advert was an iBeacon, false if it was ignored.
+ */
+bool BLEBeaconRanging::update(const uint8_t* pManufacturerData, size_t length, int rssi) {
+	if (pManufacturerData == nullptr || length != IBEACON_DATA_LENGTH) return false;
+	if (pManufacturerData[2] != 0x02 || pManufacturerData[3] != 0x15) return false;   // iBeacon sub type and length.
+
+	const uint8_t* pId   = pManufacturerData + 4;
+	int8_t measuredPower = (int8_t) pManufacturerData[4 + BEACON_RANGING_ID_LENGTH];
+	if (measuredPower == 0) measuredPower = m_defaultMeasuredPower;
+	int64_t now = esp_timer_get_time();
+
+	portENTER_CRITICAL(&m_mux);
+	ble_beacon_range_t* pEntry = find(pId);
+	if (pEntry == nullptr) {
+		if (m_count < BEACON_RANGING_MAX_BEACONS) {
+			pEntry = &m_beacons[m_count++];
+		} else {
+			pEntry = &m_beacons[0];      // Replace the beacon heard least recently.
+			for (size_t i = 1; i < m_count; i++) {
+				if (m_beacons[i].lastSeen < pEntry->lastSeen) pEntry = &m_beacons[i];
+			}
+		}
+		memcpy(pEntry->id, pId, BEACON_RANGING_ID_LENGTH);
+		pEntry->rssi     = rssi;
+		pEntry->variance = m_measurementNoise;
+		pEntry->samples  = 0;
+	} else {
+		// Predict: the true RSSI may have drifted since the last advert.  Then correct with the reading.
+		float variance   = pEntry->variance + m_processNoise * ((now - pEntry->lastSeen) / 1000000.0);
+		float gain       = variance / (variance + m_measurementNoise);
+		pEntry->rssi    += gain * (rssi - pEntry->rssi);
+		pEntry->variance = (1.0 - gain) * variance;
+	}
+	pEntry->measuredPower = measuredPower;
+	pEntry->lastSeen      = now;
+	pEntry->samples++;
+	portEXIT_CRITICAL(&m_mux);
+
+	ESP_LOGV(LOG_TAG, "update: rssi=%d, measured power=%d", rssi, measuredPower);
+	return true;
+} // update
+
+#endif /* CONFIG_BT_ENABLED */
@@ -0,0 +1,71 @@
+/*
+ * BLEBeaconRanging.h
+ *
+ *  Smoothed RSSI to distance estimation for iBeacons seen by a scan.
+ */
+
+#ifndef COMPONENTS_CPP_UTILS_BLEBEACONRANGING_H_
+#define COMPONENTS_CPP_UTILS_BLEBEACONRANGING_H_
+#include "sdkconfig.h"
+#if defined(CONFIG_BT_ENABLED)
+#include <freertos/FreeRTOS.h>
+#include "BLEUUID.h"
+
+#define BEACON_RANGING_MAX_BEACONS 16
+#define BEACON_RANGING_ID_LENGTH   20    // Proximity UUID + major + minor as advertised.
+
+/**
+ * @brief The filter state of one beacon.
+ */
+typedef struct {
+	uint8_t  id[BEACON_RANGING_ID_LENGTH];   // Proximity UUID, major and minor in advertised byte order.
+	int8_t   measuredPower;                  // Advertised RSSI at 1m.
+	float    rssi;                           // Filtered RSSI in dBm.
+	float    variance;                       // Variance of the filtered RSSI at lastSeen, in dB^2.
+	uint32_t samples;                        // Adverts folded into the estimate.
+	int64_t  lastSeen;                       // esp_timer time of the last advert.
+} ble_beacon_range_t;
+
+
+/**
+ * @brief Estimate the distance to iBeacons from the RSSI of their adverts.
+ *
+ * Each advert updates a one dimensional Kalman filter over the RSSI of the beacon that sent it.  The
+ * filter's variance grows with the time since the last advert and shrinks with every reading, so
+ * it follows a beacon that is moving while damping the multipath noise of one that is not.  The distance
+ * is derived with the log distance path loss model calibrated from the measured power in the advert.
+ * The confidence reflects the filter's variance, so it drops for beacons that have not been heard for a while.
+ *
+ * State is kept in a fixed table of BEACON_RANGING_MAX_BEACONS entries keyed by proximity UUID, major and
+ * minor.  When the table is full the beacon heard least recently is replaced.  Nothing is allocated
+ * after construction.
+ *
+ * Register with BLEScan::setBeaconRanging() to have every advert of a scan fed to the estimator.
+ */
+class BLEBeaconRanging {
+public:
+	BLEBeaconRanging(float pathLossExponent = 2.0, float measurementNoise = 16.0, float processNoise = 1.0);
+	void        clear();
+	size_t      getCount();
+	bool        getEntry(size_t index, ble_beacon_range_t* pEntry);
+	bool        getRange(BLEUUID proximityUUID, uint16_t major, uint16_t minor, float* pDistance, float* pConfidence = nullptr);
+	float       getConfidence(const ble_beacon_range_t& entry);
+	float       getDistance(const ble_beacon_range_t& entry);
+	void        setDefaultMeasuredPower(int8_t measuredPower);
+	bool        update(const uint8_t* pManufacturerData, size_t length, int rssi);
+	static float rssiToDistance(float rssi, int8_t measuredPower, float pathLossExponent);
+
+private:
+	ble_beacon_range_t* find(const uint8_t* pId);
+
+	ble_beacon_range_t m_beacons[BEACON_RANGING_MAX_BEACONS];
+	size_t             m_count;
+	float              m_pathLossExponent;
+	float              m_measurementNoise;      // Variance of a single RSSI reading, in dB^2.
+	float              m_processNoise;          // Growth of the variance per second, in dB^2.
+	int8_t             m_defaultMeasuredPower;  // Used when a beacon advertises a measured power of 0.
+	portMUX_TYPE       m_mux = portMUX_INITIALIZER_UNLOCKED;
+}; // BLEBeaconRanging
+
+#endif /* CONFIG_BT_ENABLED */
+#endif /* COMPONENTS_CPP_UTILS_BLEBEACONRANGING_H_ */
@@ -12,6 +12,8 @@
 #include <stdlib.h>
 #include "sdkconfig.h"
 #include <esp_err.h>
+#include <esp_timer.h>
+#include <math.h>
 #include "BLECharacteristic.h"
 #include "BLEService.h"
 #include "BLEDevice.h"
@@ -28,6 +30,8 @@ static const char* LOG_TAG = "BLECharacteristic";
 
 #define NULL_HANDLE (0xffff)
 
+FreeRTOS::Semaphore BLECharacteristic::m_semaphoreCreateEvt = FreeRTOS::Semaphore("CreateEvt");
+
 
 /**
  * @brief Construct a characteristic
@@ -61,6 +65,7 @@ BLECharacteristic::BLECharacteristic(BLEUUID uuid, uint32_t properties) {
  */
 BLECharacteristic::~BLECharacteristic() {
 	//free(m_value.attr_value); // Release the storage for the value.
+	delete m_pNotifyFilter;
 } // ~BLECharacteristic
 
 
@@ -108,6 +113,7 @@ void BLECharacteristic::executeCreate(BLEService* pService) {
 
 	if (errRc != ESP_OK) {
 		ESP_LOGE(LOG_TAG, "<< esp_ble_gatts_add_char: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		m_semaphoreCreateEvt.give();
 		return;
 	}
 	m_semaphoreCreateEvt.wait("executeCreate");
@@ -142,6 +148,18 @@ BLEDescriptor* BLECharacteristic::getDescriptorByUUID(BLEUUID descriptorUUID) {
 } // getDescriptorByUUID
 
 
+/**
+ * @brief Get the memory used by this characteristic.
+ * This counts the object itself, its descriptor list and its value storage in the shared arena.  The
+ * descriptors are reported separately by BLEDescriptor::getFootprint().
+ * @return The number of bytes used.
+ */
+size_t BLECharacteristic::getFootprint() {
+	return sizeof(BLECharacteristic) + m_descriptorMap.getFootprint() + m_value.getFootprint() +
+		(m_pNotifyFilter != nullptr ? sizeof(ble_notify_filter_t) : 0);
+} // getFootprint
+
+
 /**
  * @brief Get the handle of the characteristic.
  * @return The handle of the characteristic.
@@ -291,9 +309,9 @@ void BLECharacteristic::handleGATTServerEvent(
 				ESP_LOGD(LOG_TAG, " - Response to write event: New value: handle: %.2x, uuid: %s",
 						getHandle(), getUUID().toString().c_str());
 
-				char* pHexData = BLEUtils::buildHexData(nullptr, param->write.value, param->write.len);
-				ESP_LOGD(LOG_TAG, " - Data: length: %d, data: %s", param->write.len, pHexData);
-				free(pHexData);
+				char hex[BLE_HEX_LOG_MAX * 2 + 1];
+				ESP_LOGD(LOG_TAG, " - Data: length: %d, data: %s", param->write.len,
+					BLEUtils::buildHexData(hex, sizeof(hex), param->write.value, param->write.len));
 
 				if (param->write.need_rsp) {
 					esp_gatt_rsp_t rsp;
@@ -406,9 +424,9 @@ void BLECharacteristic::handleGATTServerEvent(
 					rsp.attr_value.handle   = param->read.handle;
 					rsp.attr_value.auth_req = ESP_GATT_AUTH_REQ_NONE;
 
-					char *pHexData = BLEUtils::buildHexData(nullptr, rsp.attr_value.value, rsp.attr_value.len);
-					ESP_LOGD(LOG_TAG, " - Data: length=%d, data=%s, offset=%d", rsp.attr_value.len, pHexData, rsp.attr_value.offset);
-					free(pHexData);
+					char hex[BLE_HEX_LOG_MAX * 2 + 1];
+					ESP_LOGD(LOG_TAG, " - Data: length=%d, data=%s, offset=%d", rsp.attr_value.len,
+						BLEUtils::buildHexData(hex, sizeof(hex), rsp.attr_value.value, rsp.attr_value.len), rsp.attr_value.offset);
 
 					esp_err_t errRc = ::esp_ble_gatts_send_response(
 							gatts_if, param->read.conn_id,
@@ -424,27 +442,18 @@ void BLECharacteristic::handleGATTServerEvent(
 		} // ESP_GATTS_READ_EVT
 
 
-		// ESP_GATTS_CONF_EVT
-		//
-		// conf:
-		// - esp_gatt_status_t status  – The status code.
-		// - uint16_t          conn_id – The connection used.
-		//
-		case ESP_GATTS_CONF_EVT: {
-			// ESP_LOGD(LOG_TAG, "m_handle = %d, conf->handle = %d", m_handle, param->conf.handle);
-			if(param->conf.conn_id == getService()->getServer()->getConnId()) // && param->conf.handle == m_handle) // bug in esp-idf and not implemented in arduino yet
-				m_semaphoreConfEvt.give(param->conf.status);
-			break;
-		}
-
-		case ESP_GATTS_CONNECT_EVT: {
-			break;
-		}
-
+		// ESP_GATTS_CONF_EVT and ESP_GATTS_DISCONNECT_EVT release the indication semaphore owned by
+		// the BLEServer; see BLEServer::handleGATTServerEvent.  A disconnect also forgets what was
+		// notified to the connection so a later connection reusing its id gets the value.
 		case ESP_GATTS_DISCONNECT_EVT: {
-			m_semaphoreConfEvt.give();
+			if (m_pNotifyFilter != nullptr) {
+				for (int i = 0; i < BLE_NOTIFY_FILTER_MAX_PEERS; i++) {
+					ble_notify_sent_t& sent = m_pNotifyFilter->sent[i];
+					if (sent.used && sent.connId == param->disconnect.conn_id) sent.used = false;
+				}
+			}
 			break;
-		}
+		} // ESP_GATTS_DISCONNECT_EVT
 
 		default: {
 			break;
@@ -460,6 +469,81 @@ void BLECharacteristic::handleGATTServerEvent(
 } // handleGATTServerEvent
 
 
+/**
+ * @brief FNV-1a hash of a value, to compare long values without keeping a copy.
+ */
+static uint32_t hashValue(const uint8_t* pData, size_t length) {
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; i++) {
+		hash = (hash ^ pData[i]) * 16777619u;
+	}
+	return hash;
+} // hashValue
+
+
+/**
+ * @brief Has the current value already been notified to a connection, in change only mode?
+ *
+ * The value is unchanged if it is byte for byte the one last sent or, when both were set from numbers,
+ * if the numbers differ by no more than the deadband.  An unchanged value is still sent once the
+ * refresh period has passed.
+ *
+ * @param [in] connId The connection.
+ * @param [in] now The current esp_timer time.
+ * @return True if the notification can be skipped.
+ */
+bool BLECharacteristic::isUnchangedFor(uint16_t connId, int64_t now) {
+	ble_notify_filter_t* pFilter = m_pNotifyFilter;
+	for (int i = 0; i < BLE_NOTIFY_FILTER_MAX_PEERS; i++) {
+		ble_notify_sent_t& sent = pFilter->sent[i];
+		if (!sent.used || sent.connId != connId) continue;
+
+		if (pFilter->refreshMs > 0 && now - sent.sentAt >= (int64_t) pFilter->refreshMs * 1000) return false;
+		if (pFilter->hasNumber && sent.hasNumber && pFilter->deadband > 0) {
+			return fabs(pFilter->number - sent.number) <= pFilter->deadband;
+		}
+		if (sent.length != m_value.getLength()) return false;
+		if (sent.length > BLE_NOTIFY_FILTER_MAX_VALUE) {
+			return sent.hash == hashValue(m_value.getData(), sent.length);
+		}
+		return memcmp(sent.value, m_value.getData(), sent.length) == 0;
+	}
+	return false;   // Nothing sent to this connection yet.
+} // isUnchangedFor
+
+
+/**
+ * @brief Remember the value notified to a connection, in change only mode.
+ * @param [in] connId The connection.
+ * @param [in] now The esp_timer time of the notification.
+ */
+void BLECharacteristic::recordSent(uint16_t connId, int64_t now) {
+	ble_notify_sent_t* pSent = nullptr;
+	for (int i = 0; i < BLE_NOTIFY_FILTER_MAX_PEERS; i++) {
+		ble_notify_sent_t& sent = m_pNotifyFilter->sent[i];
+		if (sent.used && sent.connId == connId) {
+			pSent = &sent;
+			break;
+		}
+		if (!sent.used && pSent == nullptr) pSent = &sent;
+	}
+	if (pSent == nullptr) return;   // More peers than slots; they are always notified.
+
+	size_t length = m_value.getLength();
+	pSent->used      = true;
+	pSent->connId    = connId;
+	pSent->sentAt    = now;
+	pSent->length    = length;
+	pSent->hasNumber = m_pNotifyFilter->hasNumber;
+	pSent->number    = m_pNotifyFilter->number;
+	if (length > BLE_NOTIFY_FILTER_MAX_VALUE) {
+		pSent->hash = hashValue(m_value.getData(), length);
+	} else {
+		memcpy(pSent->value, m_value.getData(), length);
+	}
+} // recordSent
+
+
 /**
  * @brief Send an indication.
  * An indication is a transmission of up to the first 20 bytes of the characteristic value.  An indication
@@ -468,7 +552,7 @@ void BLECharacteristic::handleGATTServerEvent(
  */
 void BLECharacteristic::indicate() {
 
-	ESP_LOGD(LOG_TAG, ">> indicate: length: %d", m_value.getValue().length());
+	ESP_LOGD(LOG_TAG, ">> indicate: length: %d", m_value.getLength());
 	notify(false);
 	ESP_LOGD(LOG_TAG, "<< indicate");
 } // indicate
@@ -481,12 +565,12 @@ void BLECharacteristic::indicate() {
  * @return N/A.
  */
 void BLECharacteristic::notify(bool is_notification) {
-	ESP_LOGD(LOG_TAG, ">> notify: length: %d", m_value.getValue().length());
+	ESP_LOGD(LOG_TAG, ">> notify: length: %d", m_value.getLength());
 
 	assert(getService() != nullptr);
 	assert(getService()->getServer() != nullptr);
 
-	GeneralUtils::hexDump((uint8_t*)m_value.getValue().data(), m_value.getValue().length());
+	GeneralUtils::hexDump(m_value.getData(), m_value.getLength());
 
 	if (getService()->getServer()->getConnectedCount() == 0) {
 		ESP_LOGD(LOG_TAG, "<< notify: No connected clients.");
@@ -509,26 +593,33 @@ void BLECharacteristic::notify(bool is_notification) {
 			return;
 		}
 	}
+	FreeRTOS::Semaphore* pSemaphoreConfEvt = &getService()->getServer()->m_semaphoreConfEvt;
+	size_t length = m_value.getLength();
+	int64_t now = m_pNotifyFilter != nullptr ? esp_timer_get_time() : 0;
 	for (auto &myPair : getService()->getServer()->getPeerDevices(false)) {
+		if (m_pNotifyFilter != nullptr && isUnchangedFor(myPair.first, now)) {
+			ESP_LOGD(LOG_TAG, "- Value unchanged for conn_id %d; not sent", myPair.first);
+			continue;
+		}
 		uint16_t _mtu = (myPair.second.mtu);
-		if (m_value.getValue().length() > _mtu - 3) {
+		if (length > _mtu - 3) {
 			ESP_LOGW(LOG_TAG, "- Truncating to %d bytes (maximum notify size)", _mtu - 3);
 		}
 
-		size_t length = m_value.getValue().length();
 		if(!is_notification)
-			m_semaphoreConfEvt.take("indicate");
+			pSemaphoreConfEvt->take("indicate");
 		esp_err_t errRc = ::esp_ble_gatts_send_indicate(
 				getService()->getServer()->getGattsIf(),
 				myPair.first,
-				getHandle(), length, (uint8_t*)m_value.getValue().data(), !is_notification); // The need_confirm = false makes this a notify.
+				getHandle(), length, m_value.getData(), !is_notification); // The need_confirm = false makes this a notify.
 		if (errRc != ESP_OK) {
 			ESP_LOGE(LOG_TAG, "<< esp_ble_gatts_send_ %s: rc=%d %s",is_notification?"notify":"indicate", errRc, GeneralUtils::errorToString(errRc));
-			m_semaphoreConfEvt.give();
+			pSemaphoreConfEvt->give();
 			return;
 		}
 		if(!is_notification)
-			m_semaphoreConfEvt.wait("indicate");
+			pSemaphoreConfEvt->wait("indicate");
+		if (m_pNotifyFilter != nullptr) recordSent(myPair.first, now);
 	}
 	ESP_LOGD(LOG_TAG, "<< notify");
 } // Notify
@@ -593,6 +684,34 @@ void BLECharacteristic::setIndicateProperty(bool value) {
 } // setIndicateProperty
 
 
+/**
+ * @brief Only notify a connection when the value differs from the one last sent to it.
+ *
+ * Useful for slowly varying values, such as a battery level or a sensor reading, that are set and
+ * notified on every sample.  Each connection remembers the value it was last sent; notify() skips the
+ * connections for which the value is unchanged.  Indications are filtered the same way.
+ *
+ * @param [in] enable True to enable change only notifications, false to notify on every call (the default).
+ * @param [in] deadband For values set from a number (setValue(int&), setValue(float&), ...), changes no
+ * larger than this are treated as unchanged.  0 requires an exact match.
+ * @param [in] refreshMs Send an unchanged value anyway once this many milliseconds have passed since
+ * it was last sent.  0 never refreshes.
+ */
+void BLECharacteristic::setNotifyOnChange(bool enable, double deadband, uint32_t refreshMs) {
+	if (!enable) {
+		delete m_pNotifyFilter;
+		m_pNotifyFilter = nullptr;
+		return;
+	}
+	if (m_pNotifyFilter == nullptr) {
+		m_pNotifyFilter = new ble_notify_filter_t;
+		memset(m_pNotifyFilter, 0, sizeof(ble_notify_filter_t));
+	}
+	m_pNotifyFilter->deadband  = deadband;
+	m_pNotifyFilter->refreshMs = refreshMs;
+} // setNotifyOnChange
+
+
 /**
  * @brief Set the Notify property value.
  * @param [in] value Set to true if we are to allow notification messages.
@@ -627,14 +746,15 @@ void BLECharacteristic::setReadProperty(bool value) {
  * @param [in] length The length of the data in bytes.
  */
 void BLECharacteristic::setValue(uint8_t* data, size_t length) {
-	char* pHex = BLEUtils::buildHexData(nullptr, data, length);
-	ESP_LOGD(LOG_TAG, ">> setValue: length=%d, data=%s, characteristic UUID=%s", length, pHex, getUUID().toString().c_str());
-	free(pHex);
+	char hex[BLE_HEX_LOG_MAX * 2 + 1];
+	ESP_LOGD(LOG_TAG, ">> setValue: length=%d, data=%s, characteristic UUID=%s", length,
+		BLEUtils::buildHexData(hex, sizeof(hex), data, length), getUUID().toString().c_str());
 	if (length > ESP_GATT_MAX_ATTR_LEN) {
 		ESP_LOGE(LOG_TAG, "Size %d too large, must be no bigger than %d", length, ESP_GATT_MAX_ATTR_LEN);
 		return;
 	}
 	m_value.setValue(data, length);
+	if (m_pNotifyFilter != nullptr) m_pNotifyFilter->hasNumber = false;
 	ESP_LOGD(LOG_TAG, "<< setValue");
 } // setValue
 
@@ -655,6 +775,7 @@ void BLECharacteristic::setValue(uint16_t& data16) {
 	temp[0] = data16;
 	temp[1] = data16 >> 8;
 	setValue(temp, 2);
+	setNumber(data16);
 } // setValue
 
 void BLECharacteristic::setValue(uint32_t& data32) {
@@ -664,6 +785,7 @@ void BLECharacteristic::setValue(uint32_t& data32) {
 	temp[2] = data32 >> 16;
 	temp[3] = data32 >> 24;
 	setValue(temp, 4);
+	setNumber(data32);
 } // setValue
 
 void BLECharacteristic::setValue(int& data32) {
@@ -673,21 +795,34 @@ void BLECharacteristic::setValue(int& data32) {
 	temp[2] = data32 >> 16;
 	temp[3] = data32 >> 24;
 	setValue(temp, 4);
+	setNumber(data32);
 } // setValue
 
 void BLECharacteristic::setValue(float& data32) {
 	uint8_t temp[4];
 	*((float*)temp) = data32;
 	setValue(temp, 4);
+	setNumber(data32);
 } // setValue
 
 void BLECharacteristic::setValue(double& data64) {
 	uint8_t temp[8];
 	*((double*)temp) = data64;
 	setValue(temp, 8);
+	setNumber(data64);
 } // setValue
 
 
+/**
+ * @brief Record the number the value was just set from, for the deadband of change only mode.
+ */
+void BLECharacteristic::setNumber(double number) {
+	if (m_pNotifyFilter == nullptr) return;
+	m_pNotifyFilter->hasNumber = true;
+	m_pNotifyFilter->number    = number;
+} // setNumber
+
+
 /**
  * @brief Set the Write No Response property value.
  * @param [in] value Set to true if we are to allow writes with no response.
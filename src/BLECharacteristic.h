@@ -10,7 +10,7 @@
 #include "sdkconfig.h"
 #if defined(CONFIG_BT_ENABLED)
 #include <string>
-#include <map>
+#include <vector>
 #include "BLEUUID.h"
 #include <esp_gatts_api.h>
 #include <esp_gap_ble_api.h>
@@ -37,13 +37,45 @@ public:
 	void handleGATTServerEvent(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t* param);
 	BLEDescriptor* getFirst();
 	BLEDescriptor* getNext();
+	size_t         getCount();
+	size_t         getFootprint();
 private:
-	std::map<BLEDescriptor*, std::string> m_uuidMap;
-	std::map<uint16_t, BLEDescriptor*> m_handleMap;
-	std::map<BLEDescriptor*, std::string>::iterator m_iterator;
+	// Descriptors in the order they were added.  Lookups by UUID or handle scan the (short) list
+	// instead of keeping string keyed and handle keyed maps per characteristic.
+	std::vector<BLEDescriptor*> m_descriptors;
+	size_t                      m_iterator = 0;
 };
 
 
+#define BLE_NOTIFY_FILTER_MAX_PEERS 4
+#define BLE_NOTIFY_FILTER_MAX_VALUE 20
+
+/**
+ * @brief What was last notified to one connection, for change only notifications.
+ */
+typedef struct {
+	bool     used;
+	uint16_t connId;
+	int64_t  sentAt;                               // esp_timer time of the notification.
+	uint16_t length;                               // Length of the value sent.
+	uint32_t hash;                                 // FNV-1a hash of values longer than BLE_NOTIFY_FILTER_MAX_VALUE.
+	uint8_t  value[BLE_NOTIFY_FILTER_MAX_VALUE];   // Copy of shorter values.
+	bool     hasNumber;                            // Was the value set from a number?
+	double   number;
+} ble_notify_sent_t;
+
+/**
+ * @brief State of the change only notification mode of a characteristic.
+ */
+typedef struct {
+	double            deadband;        // Numeric changes no larger than this are not notified.
+	uint32_t          refreshMs;       // Notify an unchanged value after this long; 0 never.
+	bool              hasNumber;       // Was the current value set from a number?
+	double            number;          // The number the current value was set from.
+	ble_notify_sent_t sent[BLE_NOTIFY_FILTER_MAX_PEERS];
+} ble_notify_filter_t;
+
+
 /**
  * @brief The model of a %BLE Characteristic.
  *
@@ -68,6 +100,7 @@ public:
 	void setBroadcastProperty(bool value);
 	void setCallbacks(BLECharacteristicCallbacks* pCallbacks);
 	void setIndicateProperty(bool value);
+	void setNotifyOnChange(bool enable, double deadband = 0, uint32_t refreshMs = 0);
 	void setNotifyProperty(bool value);
 	void setReadProperty(bool value);
 	void setValue(uint8_t* data, size_t size);
@@ -82,6 +115,7 @@ public:
 	std::string toString();
 	uint16_t getHandle();
 	void setAccessPermissions(esp_gatt_perm_t perm);
+	size_t getFootprint();
 
 	static const uint32_t PROPERTY_READ      = 1<<0;
 	static const uint32_t PROPERTY_WRITE     = 1<<1;
@@ -105,6 +139,7 @@ private:
 	BLEService*                 m_pService;
 	BLEValue                    m_value;
 	esp_gatt_perm_t             m_permissions = ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE;
+	ble_notify_filter_t*        m_pNotifyFilter = nullptr;   // Only allocated in change only mode.
 
 	void handleGATTServerEvent(
 			esp_gatts_cb_event_t      event,
@@ -115,8 +150,13 @@ private:
 	esp_gatt_char_prop_t getProperties();
 	BLEService*          getService();
 	void                 setHandle(uint16_t handle);
-	FreeRTOS::Semaphore m_semaphoreCreateEvt = FreeRTOS::Semaphore("CreateEvt");
-	FreeRTOS::Semaphore m_semaphoreConfEvt   = FreeRTOS::Semaphore("ConfEvt");
+	void                 setNumber(double number);
+	bool                 isUnchangedFor(uint16_t connId, int64_t now);
+	void                 recordSent(uint16_t connId, int64_t now);
+
+	// Characteristics and descriptors are registered one at a time so they all share a single
+	// completion semaphore.  Indication confirms are tracked by the owning BLEServer.
+	static FreeRTOS::Semaphore m_semaphoreCreateEvt;
 }; // BLECharacteristic
 
 
@@ -17,10 +17,15 @@
 /**
  * @brief Return the characteristic by handle.
  * @param [in] handle The handle to look up the characteristic.
- * @return The characteristic.
+ * @return The characteristic.  If not present, then nullptr is returned.
  */
 BLECharacteristic* BLECharacteristicMap::getByHandle(uint16_t handle) {
-	return m_handleMap.at(handle);
+	for (auto pCharacteristic : m_characteristics) {
+		if (pCharacteristic->getHandle() == handle) {
+			return pCharacteristic;
+		}
+	}
+	return nullptr;
 } // getByHandle
 
 
@@ -40,12 +45,11 @@ BLECharacteristic* BLECharacteristicMap::getByUUID(const char* uuid) {
  * @return The characteristic.
  */
 BLECharacteristic* BLECharacteristicMap::getByUUID(BLEUUID uuid) {
-	for (auto &myPair : m_uuidMap) {
-		if (myPair.first->getUUID().equals(uuid)) {
-			return myPair.first;
+	for (auto pCharacteristic : m_characteristics) {
+		if (pCharacteristic->getUUID().equals(uuid)) {
+			return pCharacteristic;
 		}
 	}
-	//return m_uuidMap.at(uuid.toString());
 	return nullptr;
 } // getByUUID
 
@@ -55,11 +59,8 @@ BLECharacteristic* BLECharacteristicMap::getByUUID(BLEUUID uuid) {
  * @return The first characteristic in the map.
  */
 BLECharacteristic* BLECharacteristicMap::getFirst() {
-	m_iterator = m_uuidMap.begin();
-	if (m_iterator == m_uuidMap.end()) return nullptr;
-	BLECharacteristic* pRet = m_iterator->first;
-	m_iterator++;
-	return pRet;
+	m_iterator = 0;
+	return getNext();
 } // getFirst
 
 
@@ -68,13 +69,29 @@ BLECharacteristic* BLECharacteristicMap::getFirst() {
  * @return The next characteristic in the map.
  */
 BLECharacteristic* BLECharacteristicMap::getNext() {
-	if (m_iterator == m_uuidMap.end()) return nullptr;
-	BLECharacteristic* pRet = m_iterator->first;
-	m_iterator++;
-	return pRet;
+	if (m_iterator >= m_characteristics.size()) return nullptr;
+	return m_characteristics[m_iterator++];
 } // getNext
 
 
+/**
+ * @brief Get the number of characteristics in the map.
+ * @return The number of characteristics.
+ */
+size_t BLECharacteristicMap::getCount() {
+	return m_characteristics.size();
+} // getCount
+
+
+/**
+ * @brief Get the heap bytes used by the map itself.
+ * @return The size of the characteristic list storage.
+ */
+size_t BLECharacteristicMap::getFootprint() {
+	return m_characteristics.capacity() * sizeof(BLECharacteristic*);
+} // getFootprint
+
+
 /**
  * @brief Pass the GATT server event onwards to each of the characteristics found in the mapping
  * @param [in] event
@@ -83,20 +100,21 @@ BLECharacteristic* BLECharacteristicMap::getNext() {
  */
 void BLECharacteristicMap::handleGATTServerEvent(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t* param) {
 	// Invoke the handler for every Service we have.
-	for (auto& myPair : m_uuidMap) {
-		myPair.first->handleGATTServerEvent(event, gatts_if, param);
+	for (auto pCharacteristic : m_characteristics) {
+		pCharacteristic->handleGATTServerEvent(event, gatts_if, param);
 	}
 } // handleGATTServerEvent
 
 
 /**
  * @brief Set the characteristic by handle.
+ * The handle is held by the characteristic itself so this only makes sure the characteristic is known.
  * @param [in] handle The handle of the characteristic.
  * @param [in] characteristic The characteristic to cache.
  * @return N/A.
  */
 void BLECharacteristicMap::setByHandle(uint16_t handle, BLECharacteristic* characteristic) {
-	m_handleMap.insert(std::pair<uint16_t, BLECharacteristic*>(handle, characteristic));
+	setByUUID(characteristic, characteristic->getUUID());
 } // setByHandle
 
 
@@ -107,7 +125,10 @@ void BLECharacteristicMap::setByHandle(uint16_t handle, BLECharacteristic* chara
  * @return N/A.
  */
 void BLECharacteristicMap::setByUUID(BLECharacteristic* pCharacteristic, BLEUUID uuid) {
-	m_uuidMap.insert(std::pair<BLECharacteristic*, std::string>(pCharacteristic, uuid.toString()));
+	for (auto pExisting : m_characteristics) {
+		if (pExisting == pCharacteristic) return;
+	}
+	m_characteristics.push_back(pCharacteristic);
 } // setByUUID
 
 
@@ -119,12 +140,12 @@ std::string BLECharacteristicMap::toString() {
 	std::stringstream stringStream;
 	stringStream << std::hex << std::setfill('0');
 	int count = 0;
-	for (auto &myPair: m_uuidMap) {
+	for (auto pCharacteristic : m_characteristics) {
 		if (count > 0) {
 			stringStream << "\n";
 		}
 		count++;
-		stringStream << "handle: 0x" << std::setw(2) << myPair.first->getHandle() << ", uuid: " + myPair.first->getUUID().toString();
+		stringStream << "handle: 0x" << std::setw(2) << pCharacteristic->getHandle() << ", uuid: " + pCharacteristic->getUUID().toString();
 	}
 	return stringStream.str();
 } // toString
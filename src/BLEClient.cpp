@@ -291,14 +291,13 @@ void BLEClient::gattClientEventHandler(
 		// - esp_gatt_id_t srvc_id
 		//
 		case ESP_GATTC_SEARCH_RES_EVT: {
-			BLEUUID uuid = BLEUUID(evtParam->search_res.srvc_id);
 			BLERemoteService* pRemoteService = new BLERemoteService(
 				evtParam->search_res.srvc_id,
 				this,
 				evtParam->search_res.start_handle,
 				evtParam->search_res.end_handle
 			);
-			m_servicesMap.insert(std::pair<std::string, BLERemoteService*>(uuid.toString(), pRemoteService));
+			m_servicesMap.insert(std::pair<ble_uuid_ref_t, BLERemoteService*>(pRemoteService->m_uuid, pRemoteService));
 			m_servicesMapByInstID.insert(std::pair<BLERemoteService *, uint16_t>(pRemoteService, evtParam->search_res.srvc_id.inst_id));
 			break;
 		} // ESP_GATTC_SEARCH_RES_EVT
@@ -390,13 +389,11 @@ BLERemoteService* BLEClient::getService(BLEUUID uuid) {
 	if (!m_haveServices) {
 		getServices();
 	}
-	std::string uuidStr = uuid.toString();
-	for (auto &myPair : m_servicesMap) {
-		if (myPair.first == uuidStr) {
-			ESP_LOGD(LOG_TAG, "<< getService: found the service with uuid: %s", uuid.toString().c_str());
-			return myPair.second;
-		}
-	} // End of each of the services.
+	auto it = m_servicesMap.find(BLEUUIDTable::find(uuid));
+	if (it != m_servicesMap.end()) {
+		ESP_LOGD(LOG_TAG, "<< getService: found the service with uuid: %s", uuid.toString().c_str());
+		return it->second;
+	}
 	ESP_LOGD(LOG_TAG, "<< getService: not found");
 	return nullptr;
 } // getService
@@ -408,7 +405,7 @@ BLERemoteService* BLEClient::getService(BLEUUID uuid) {
  * services and wait until we have received them all.
  * @return N/A
  */
-std::map<std::string, BLERemoteService*>* BLEClient::getServices() {
+std::map<ble_uuid_ref_t, BLERemoteService*>* BLEClient::getServices() {
 /*
  * Design
  * ------
@@ -513,6 +510,41 @@ void BLEClient::setValue(BLEUUID serviceUUID, BLEUUID characteristicUUID, std::s
 	ESP_LOGD(LOG_TAG, "<< setValue");
 } // setValue
 
+/**
+ * @brief Get the value of a specific characteristic associated with a specific service without throwing.
+ * @param [in] serviceUUID The service that owns the characteristic.
+ * @param [in] characteristicUUID The characteristic whose value we wish to read.
+ * @param [out] pValue The value that was read.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the service or characteristic is unknown or the read status.
+ */
+esp_err_t BLEClient::tryGetValue(BLEUUID serviceUUID, BLEUUID characteristicUUID, std::string* pValue) {
+	BLERemoteService* pService = getService(serviceUUID);
+	if (pService == nullptr) {
+		ESP_LOGE(LOG_TAG, "tryGetValue: no service %s", serviceUUID.toString().c_str());
+		pValue->clear();
+		return ESP_ERR_NOT_FOUND;
+	}
+	return pService->tryGetValue(characteristicUUID, pValue);
+} // tryGetValue
+
+
+/**
+ * @brief Set the value of a specific characteristic associated with a specific service without throwing.
+ * @param [in] serviceUUID The service that owns the characteristic.
+ * @param [in] characteristicUUID The characteristic whose value we wish to write.
+ * @param [in] value The value to write.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if the service or characteristic is unknown or the write status.
+ */
+esp_err_t BLEClient::trySetValue(BLEUUID serviceUUID, BLEUUID characteristicUUID, std::string value) {
+	BLERemoteService* pService = getService(serviceUUID);
+	if (pService == nullptr) {
+		ESP_LOGE(LOG_TAG, "trySetValue: no service %s", serviceUUID.toString().c_str());
+		return ESP_ERR_NOT_FOUND;
+	}
+	return pService->trySetValue(characteristicUUID, value);
+} // trySetValue
+
+
 uint16_t BLEClient::getMTU() {
 	return m_mtu;
 }
@@ -20,6 +20,7 @@
 #include "BLEService.h"
 #include "BLEAddress.h"
 #include "BLEAdvertisedDevice.h"
+#include "BLEUUIDTable.h"
 
 class BLERemoteService;
 class BLEClientCallbacks;
@@ -38,7 +39,7 @@ public:
 	void                                       disconnect();                  // Disconnect from the remote BLE Server
 	BLEAddress                                 getPeerAddress();              // Get the address of the remote BLE Server
 	int                                        getRssi();                     // Get the RSSI of the remote BLE Server
-	std::map<std::string, BLERemoteService*>*  getServices();                 // Get a map of the services offered by the remote BLE Server
+	std::map<ble_uuid_ref_t, BLERemoteService*>* getServices();               // Get a map of the services offered by the remote BLE Server, keyed by BLEUUIDTable reference
 	BLERemoteService*                          getService(const char* uuid);  // Get a reference to a specified service offered by the remote BLE server.
 	BLERemoteService*                          getService(BLEUUID uuid);      // Get a reference to a specified service offered by the remote BLE server.
 	std::string                                getValue(BLEUUID serviceUUID, BLEUUID characteristicUUID);   // Get the value of a given characteristic at a given service.
@@ -53,6 +54,9 @@ public:
 	void                                       setClientCallbacks(BLEClientCallbacks *pClientCallbacks);
 	void                                       setValue(BLEUUID serviceUUID, BLEUUID characteristicUUID, std::string value);   // Set the value of a given characteristic at a given service.
 
+	esp_err_t                                  tryGetValue(BLEUUID serviceUUID, BLEUUID characteristicUUID, std::string* pValue);  // As getValue but returns a status.
+	esp_err_t                                  trySetValue(BLEUUID serviceUUID, BLEUUID characteristicUUID, std::string value);    // As setValue but returns a status.
+
 	std::string                                toString();                    // Return a string representation of this client.
 	uint16_t                                   getConnId();
 	esp_gatt_if_t                              getGattcIf();
@@ -82,7 +86,7 @@ private:
 	FreeRTOS::Semaphore m_semaphoreOpenEvt       = FreeRTOS::Semaphore("OpenEvt");
 	FreeRTOS::Semaphore m_semaphoreSearchCmplEvt = FreeRTOS::Semaphore("SearchCmplEvt");
 	FreeRTOS::Semaphore m_semaphoreRssiCmplEvt   = FreeRTOS::Semaphore("RssiCmplEvt");
-	std::map<std::string, BLERemoteService*> m_servicesMap;
+	std::map<ble_uuid_ref_t, BLERemoteService*> m_servicesMap;
 	std::map<BLERemoteService*, uint16_t> m_servicesMapByInstID;
 	void clearServices();   // Clear any existing services.
 	uint16_t m_mtu = 23;
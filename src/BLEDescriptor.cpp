@@ -74,7 +74,7 @@ void BLEDescriptor::executeCreate(BLECharacteristic* pCharacteristic) {
 
 	esp_attr_control_t control;
 	control.auto_rsp = ESP_GATT_AUTO_RSP;
-	m_semaphoreCreateEvt.take("executeCreate");
+	BLECharacteristic::m_semaphoreCreateEvt.take("executeCreate");
 	esp_err_t errRc = ::esp_ble_gatts_add_char_descr(
 			pCharacteristic->getService()->getHandle(),
 			getUUID().getNative(),
@@ -83,14 +83,24 @@ void BLEDescriptor::executeCreate(BLECharacteristic* pCharacteristic) {
 			&control);
 	if (errRc != ESP_OK) {
 		ESP_LOGE(LOG_TAG, "<< esp_ble_gatts_add_char_descr: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		BLECharacteristic::m_semaphoreCreateEvt.give();
 		return;
 	}
 
-	m_semaphoreCreateEvt.wait("executeCreate");
+	BLECharacteristic::m_semaphoreCreateEvt.wait("executeCreate");
 	ESP_LOGD(LOG_TAG, "<< executeCreate");
 } // executeCreate
 
 
+/**
+ * @brief Get the memory used by this descriptor.
+ * @return The size of the object plus its value buffer.
+ */
+size_t BLEDescriptor::getFootprint() {
+	return sizeof(BLEDescriptor) + m_value.attr_max_len;
+} // getFootprint
+
+
 /**
  * @brief Get the BLE handle for this descriptor.
  * @return The handle for this descriptor.
@@ -147,11 +157,12 @@ void BLEDescriptor::handleGATTServerEvent(
 		// - esp_bt_uuid_t     char_uuid
 		case ESP_GATTS_ADD_CHAR_DESCR_EVT: {
 			if (m_pCharacteristic != nullptr &&
+					m_handle == NULL_HANDLE &&
 					m_bleUUID.equals(BLEUUID(param->add_char_descr.descr_uuid)) &&
 					m_pCharacteristic->getService()->getHandle() == param->add_char_descr.service_handle &&
 					m_pCharacteristic == m_pCharacteristic->getService()->getLastCreatedCharacteristic()) {
 				setHandle(param->add_char_descr.attr_handle);
-				m_semaphoreCreateEvt.give();
+				BLECharacteristic::m_semaphoreCreateEvt.give();
 			}
 			break;
 		} // ESP_GATTS_ADD_CHAR_DESCR_EVT
@@ -242,6 +253,10 @@ void BLEDescriptor::setValue(uint8_t* data, size_t length) {
 		ESP_LOGE(LOG_TAG, "Size %d too large, must be no bigger than %d", length, ESP_GATT_MAX_ATTR_LEN);
 		return;
 	}
+	if (length > m_value.attr_max_len) {
+		ESP_LOGE(LOG_TAG, "Size %d too large, descriptor holds at most %d", length, m_value.attr_max_len);
+		return;
+	}
 	m_value.attr_len = length;
 	memcpy(m_value.attr_value, data, length);
 } // setValue
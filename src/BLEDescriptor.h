@@ -43,16 +43,17 @@ public:
 	void setValue(std::string value);                       // Set the value of the descriptor as a data buffer.
 
 	std::string toString();                                 // Convert the descriptor to a string representation.
+	size_t   getFootprint();                                // Get the bytes used by the descriptor.
 
 private:
 	friend class BLEDescriptorMap;
 	friend class BLECharacteristic;
+	friend class BLEService;
 	BLEUUID                 m_bleUUID;
 	uint16_t                m_handle;
 	BLEDescriptorCallbacks* m_pCallback;
 	BLECharacteristic*      m_pCharacteristic;
 	esp_gatt_perm_t				  m_permissions = ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE;
-	FreeRTOS::Semaphore     m_semaphoreCreateEvt = FreeRTOS::Semaphore("CreateEvt");
 	esp_attr_value_t        m_value;
 
 	void executeCreate(BLECharacteristic* pCharacteristic);
@@ -31,12 +31,11 @@ BLEDescriptor* BLEDescriptorMap::getByUUID(const char* uuid) {
  * @return The descriptor.  If not present, then nullptr is returned.
  */
 BLEDescriptor* BLEDescriptorMap::getByUUID(BLEUUID uuid) {
-	for (auto &myPair : m_uuidMap) {
-		if (myPair.first->getUUID().equals(uuid)) {
-			return myPair.first;
+	for (auto pDescriptor : m_descriptors) {
+		if (pDescriptor->getUUID().equals(uuid)) {
+			return pDescriptor;
 		}
 	}
-	//return m_uuidMap.at(uuid.toString());
 	return nullptr;
 } // getByUUID
 
@@ -44,10 +43,15 @@ BLEDescriptor* BLEDescriptorMap::getByUUID(BLEUUID uuid) {
 /**
  * @brief Return the descriptor by handle.
  * @param [in] handle The handle to look up the descriptor.
- * @return The descriptor.
+ * @return The descriptor.  If not present, then nullptr is returned.
  */
 BLEDescriptor* BLEDescriptorMap::getByHandle(uint16_t handle) {
-	return m_handleMap.at(handle);
+	for (auto pDescriptor : m_descriptors) {
+		if (pDescriptor->getHandle() == handle) {
+			return pDescriptor;
+		}
+	}
+	return nullptr;
 } // getByHandle
 
 
@@ -58,7 +62,7 @@ BLEDescriptor* BLEDescriptorMap::getByHandle(uint16_t handle) {
  * @return N/A.
  */
 void BLEDescriptorMap::setByUUID(const char* uuid, BLEDescriptor* pDescriptor){
-	m_uuidMap.insert(std::pair<BLEDescriptor*, std::string>(pDescriptor, uuid));
+	setByUUID(BLEUUID(uuid), pDescriptor);
 } // setByUUID
 
 
@@ -70,18 +74,22 @@ void BLEDescriptorMap::setByUUID(const char* uuid, BLEDescriptor* pDescriptor){
  * @return N/A.
  */
 void BLEDescriptorMap::setByUUID(BLEUUID uuid, BLEDescriptor* pDescriptor) {
-	m_uuidMap.insert(std::pair<BLEDescriptor*, std::string>(pDescriptor, uuid.toString()));
+	for (auto pExisting : m_descriptors) {
+		if (pExisting == pDescriptor) return;
+	}
+	m_descriptors.push_back(pDescriptor);
 } // setByUUID
 
 
 /**
  * @brief Set the descriptor by handle.
+ * The handle is held by the descriptor itself so this only makes sure the descriptor is known.
  * @param [in] handle The handle of the descriptor.
  * @param [in] descriptor The descriptor to cache.
  * @return N/A.
  */
 void BLEDescriptorMap::setByHandle(uint16_t handle, BLEDescriptor* pDescriptor) {
-	m_handleMap.insert(std::pair<uint16_t, BLEDescriptor*>(handle, pDescriptor));
+	setByUUID(pDescriptor->getUUID(), pDescriptor);
 } // setByHandle
 
 
@@ -93,12 +101,12 @@ std::string BLEDescriptorMap::toString() {
 	std::stringstream stringStream;
 	stringStream << std::hex << std::setfill('0');
 	int count = 0;
-	for (auto &myPair : m_uuidMap) {
+	for (auto pDescriptor : m_descriptors) {
 		if (count > 0) {
 			stringStream << "\n";
 		}
 		count++;
-		stringStream << "handle: 0x" << std::setw(2) << myPair.first->getHandle() << ", uuid: " + myPair.first->getUUID().toString();
+		stringStream << "handle: 0x" << std::setw(2) << pDescriptor->getHandle() << ", uuid: " + pDescriptor->getUUID().toString();
 	}
 	return stringStream.str();
 } // toString
@@ -115,8 +123,8 @@ void BLEDescriptorMap::handleGATTServerEvent(
 		esp_gatt_if_t             gatts_if,
 		esp_ble_gatts_cb_param_t* param) {
 	// Invoke the handler for every descriptor we have.
-	for (auto &myPair : m_uuidMap) {
-		myPair.first->handleGATTServerEvent(event, gatts_if, param);
+	for (auto pDescriptor : m_descriptors) {
+		pDescriptor->handleGATTServerEvent(event, gatts_if, param);
 	}
 } // handleGATTServerEvent
 
@@ -126,11 +134,8 @@ void BLEDescriptorMap::handleGATTServerEvent(
  * @return The first descriptor in the map.
  */
 BLEDescriptor* BLEDescriptorMap::getFirst() {
-	m_iterator = m_uuidMap.begin();
-	if (m_iterator == m_uuidMap.end()) return nullptr;
-	BLEDescriptor* pRet = m_iterator->first;
-	m_iterator++;
-	return pRet;
+	m_iterator = 0;
+	return getNext();
 } // getFirst
 
 
@@ -139,9 +144,25 @@ BLEDescriptor* BLEDescriptorMap::getFirst() {
  * @return The next descriptor in the map.
  */
 BLEDescriptor* BLEDescriptorMap::getNext() {
-	if (m_iterator == m_uuidMap.end()) return nullptr;
-	BLEDescriptor* pRet = m_iterator->first;
-	m_iterator++;
-	return pRet;
+	if (m_iterator >= m_descriptors.size()) return nullptr;
+	return m_descriptors[m_iterator++];
 } // getNext
+
+
+/**
+ * @brief Get the number of descriptors in the map.
+ * @return The number of descriptors.
+ */
+size_t BLEDescriptorMap::getCount() {
+	return m_descriptors.size();
+} // getCount
+
+
+/**
+ * @brief Get the heap bytes used by the map itself.
+ * @return The size of the descriptor list storage.
+ */
+size_t BLEDescriptorMap::getFootprint() {
+	return m_descriptors.capacity() * sizeof(BLEDescriptor*);
+} // getFootprint
 #endif /* CONFIG_BT_ENABLED */
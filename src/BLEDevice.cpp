@@ -18,6 +18,7 @@
 #include <esp_gatts_api.h>     // ESP32 BLE
 #include <esp_gattc_api.h>     // ESP32 BLE
 #include <esp_gatt_common_api.h>// ESP32 BLE
+#include <esp_timer.h>         // ESP32 ESP-IDF
 #include <esp_err.h>           // ESP32 ESP-IDF
 #include <map>                 // Part of C++ Standard library
 #include <sstream>             // Part of C++ Standard library
@@ -57,6 +58,12 @@ std::map<uint16_t, conn_status_t> BLEDevice::m_connectedClientsMap;
 gap_event_handler BLEDevice::m_customGapHandler = nullptr;
 gattc_event_handler BLEDevice::m_customGattcHandler = nullptr;
 gatts_event_handler BLEDevice::m_customGattsHandler = nullptr;
+ble_init_metrics_t BLEDevice::m_initMetrics = {};
+bool BLEDevice::m_gattcRegistered = false;
+bool BLEDevice::m_gattsRegistered = false;
+bool BLEDevice::m_suspended = false;
+std::string BLEDevice::m_deviceName;
+ble_resume_metrics_t BLEDevice::m_resumeMetrics = {};
 
 /**
  * @brief Create a new instance of a client.
@@ -68,6 +75,7 @@ gatts_event_handler BLEDevice::m_customGattsHandler = nullptr;
 	ESP_LOGE(LOG_TAG, "BLE GATTC is not enabled - CONFIG_GATTC_ENABLE not defined");
 	abort();
 #endif  // CONFIG_GATTC_ENABLE
+	registerGattClient();
 	m_pClient = new BLEClient();
 	ESP_LOGD(LOG_TAG, "<< createClient");
 	return m_pClient;
@@ -84,6 +92,7 @@ gatts_event_handler BLEDevice::m_customGattsHandler = nullptr;
 	ESP_LOGE(LOG_TAG, "BLE GATTS is not enabled - CONFIG_GATTS_ENABLE not defined");
 	abort();
 #endif // CONFIG_GATTS_ENABLE
+	registerGattServer();
 	m_pServer = new BLEServer();
 	m_pServer->createApp(m_appId++);
 	ESP_LOGD(LOG_TAG, "<< createServer");
@@ -109,8 +118,16 @@ gatts_event_handler BLEDevice::m_customGattsHandler = nullptr;
 
 	BLEUtils::dumpGattServerEvent(event, gatts_if, param);
 
+	if (m_bleAdvertising != nullptr) {
+		// A server callback may start advertising; it must not wait for GAP events on this same task.
+		m_bleAdvertising->m_btTask = xTaskGetCurrentTaskHandle();
+	}
+
 	switch (event) {
 		case ESP_GATTS_CONNECT_EVT: {
+			if (m_bleAdvertising != nullptr) {
+				m_bleAdvertising->onConnect();   // The controller stops advertising on a connection.
+			}
 #ifdef CONFIG_BLE_SMP_ENABLE   // Check that BLE SMP (security) is configured in make menuconfig
 			if(BLEDevice::m_securityLevel){
 				esp_ble_set_encryption(param->connect.remote_bda, BLEDevice::m_securityLevel);
@@ -255,6 +272,11 @@ gatts_event_handler BLEDevice::m_customGattsHandler = nullptr;
 			 ESP_LOGI(LOG_TAG, "key type = %s", BLESecurity::esp_key_type_to_str(param->ble_security.ble_key.key_type));
 #endif	// CONFIG_BLE_SMP_ENABLE
 			 break;
+		 case ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT:
+			 if (m_pServer != nullptr && param->update_conn_params.status == ESP_BT_STATUS_SUCCESS) {
+				 m_pServer->m_connInterval = param->update_conn_params.conn_int;
+			 }
+			 break;
 		 case ESP_GAP_BLE_AUTH_CMPL_EVT:
 			 ESP_LOGI(LOG_TAG, "ESP_GAP_BLE_AUTH_CMPL_EVT");
 #ifdef CONFIG_BLE_SMP_ENABLE   // Check that BLE SMP (security) is configured in make menuconfig
@@ -299,6 +321,15 @@ gatts_event_handler BLEDevice::m_customGattsHandler = nullptr;
 } // getAddress
 
 
+/**
+ * @brief Get the name the device was initialized with.
+ * @return The device name.
+ */
+/* STATIC */ std::string BLEDevice::getDeviceName() {
+	return m_deviceName;
+} // getDeviceName
+
+
 /**
  * @brief Retrieve the Scan object that we use for scanning.
  * @return The scanning object reference.  This is a singleton object.  The caller should not
@@ -338,102 +369,325 @@ gatts_event_handler BLEDevice::m_customGattsHandler = nullptr;
  */
 /* STATIC */ void BLEDevice::init(std::string deviceName) {
 	if(!initialized){
-		initialized = true; // Set the initialization flag to ensure we are only initialized once.
-
-		esp_err_t errRc = ESP_OK;
-#ifdef ARDUINO_ARCH_ESP32
-		if (!btStart()) {
-			errRc = ESP_FAIL;
+		if (!initStack(deviceName, false)) {
 			return;
 		}
+		int64_t settleStart = esp_timer_get_time();
+		vTaskDelay(200 / portTICK_PERIOD_MS); // Delay for 200 msecs as a workaround to an apparent Arduino environment issue.
+		m_initMetrics.settle = esp_timer_get_time() - settleStart;
+		m_initMetrics.total += m_initMetrics.settle;
+	}
+} // init
+
+
+/**
+ * @brief Initialize the %BLE environment with minimal start up latency.
+ *
+ * Unlike init(), no fixed delay is applied.  None is needed: esp_bt_controller_enable() and
+ * esp_bluedroid_enable() only return once the controller and bluedroid are enabled, and the GAP callback
+ * is registered before initStack() returns.  The GATT client and GATT server callbacks are not registered
+ * here; they are registered the first time a client or server is created (or a custom handler is set).
+ * @param [in] deviceName The device name of the device.
+ * @return True if the stack is ready.
+ */
+/* STATIC */ bool BLEDevice::initFast(std::string deviceName) {
+	if (initialized) {
+		return esp_bluedroid_get_status() == ESP_BLUEDROID_STATUS_ENABLED;
+	}
+	return initStack(deviceName, true);
+} // initFast
+
+
+/**
+ * @brief Bring up the controller and bluedroid and register our handlers.
+ *
+ * The time spent in each phase is recorded in the init metrics.
+ * @param [in] deviceName The device name of the device.
+ * @param [in] lazyGatt If true, defer GATTC/GATTS callback registration until first use.
+ * @return True on success.
+ */
+/* STATIC */ bool BLEDevice::initStack(std::string deviceName, bool lazyGatt) {
+	initialized = true; // Set the initialization flag to ensure we are only initialized once.
+	m_deviceName = deviceName;
+	memset(&m_initMetrics, 0, sizeof(m_initMetrics));
+	int64_t initStart  = esp_timer_get_time();
+	int64_t phaseStart = initStart;
+
+	esp_err_t errRc = ESP_OK;
+#ifdef ARDUINO_ARCH_ESP32
+	if (!btStart()) {
+		errRc = ESP_FAIL;
+		return false;
+	}
 #else
-		errRc = ::nvs_flash_init();
-		if (errRc != ESP_OK) {
-			ESP_LOGE(LOG_TAG, "nvs_flash_init: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-			return;
-		}
+	errRc = ::nvs_flash_init();
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "nvs_flash_init: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return false;
+	}
 
 #ifndef CLASSIC_BT_ENABLED
-		esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT);  
+	esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT);  
 #endif
-		esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
-		errRc = esp_bt_controller_init(&bt_cfg);
-		if (errRc != ESP_OK) {
-			ESP_LOGE(LOG_TAG, "esp_bt_controller_init: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-			return;
-		}
+	esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
+	errRc = esp_bt_controller_init(&bt_cfg);
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_bt_controller_init: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return false;
+	}
 
 #ifndef CLASSIC_BT_ENABLED
-		errRc = esp_bt_controller_enable(ESP_BT_MODE_BLE);
-		if (errRc != ESP_OK) {
-			ESP_LOGE(LOG_TAG, "esp_bt_controller_enable: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-			return;
-		}
+	errRc = esp_bt_controller_enable(ESP_BT_MODE_BLE);
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_bt_controller_enable: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return false;
+	}
 #else
-		errRc = esp_bt_controller_enable(ESP_BT_MODE_BTDM);
-		if (errRc != ESP_OK) {
-			ESP_LOGE(LOG_TAG, "esp_bt_controller_enable: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-			return;
-		}
+	errRc = esp_bt_controller_enable(ESP_BT_MODE_BTDM);
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_bt_controller_enable: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return false;
+	}
 #endif
 #endif
+	m_initMetrics.controller = esp_timer_get_time() - phaseStart;
+	phaseStart = esp_timer_get_time();
 
-		esp_bluedroid_status_t bt_state = esp_bluedroid_get_status();
-		if (bt_state == ESP_BLUEDROID_STATUS_UNINITIALIZED) {
-			errRc = esp_bluedroid_init();
-			if (errRc != ESP_OK) {
-				ESP_LOGE(LOG_TAG, "esp_bluedroid_init: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-				return;
-			}
+	esp_bluedroid_status_t bt_state = esp_bluedroid_get_status();
+	if (bt_state == ESP_BLUEDROID_STATUS_UNINITIALIZED) {
+		errRc = esp_bluedroid_init();
+		if (errRc != ESP_OK) {
+			ESP_LOGE(LOG_TAG, "esp_bluedroid_init: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+			return false;
 		}
+	}
 
-		if (bt_state != ESP_BLUEDROID_STATUS_ENABLED) {
-			errRc = esp_bluedroid_enable();
-			if (errRc != ESP_OK) {
-				ESP_LOGE(LOG_TAG, "esp_bluedroid_enable: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-				return;
-			}
+	if (bt_state != ESP_BLUEDROID_STATUS_ENABLED) {
+		errRc = esp_bluedroid_enable();
+		if (errRc != ESP_OK) {
+			ESP_LOGE(LOG_TAG, "esp_bluedroid_enable: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+			return false;
 		}
+	}
+	m_initMetrics.bluedroid = esp_timer_get_time() - phaseStart;
+	phaseStart = esp_timer_get_time();
 
-		errRc = esp_ble_gap_register_callback(BLEDevice::gapEventHandler);
-		if (errRc != ESP_OK) {
-			ESP_LOGE(LOG_TAG, "esp_ble_gap_register_callback: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-			return;
+	errRc = esp_ble_gap_register_callback(BLEDevice::gapEventHandler);
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_ble_gap_register_callback: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return false;
+	}
+	m_initMetrics.gapRegister = esp_timer_get_time() - phaseStart;
+
+	if (!lazyGatt) {
+		if (registerGattClient() != ESP_OK || registerGattServer() != ESP_OK) {
+			return false;
 		}
+	}
+	phaseStart = esp_timer_get_time();
+
+	errRc = ::esp_ble_gap_set_device_name(deviceName.c_str());
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_ble_gap_set_device_name: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return false;
+	};
+	m_initMetrics.deviceName = esp_timer_get_time() - phaseStart;
+	phaseStart = esp_timer_get_time();
 
+#ifdef CONFIG_BLE_SMP_ENABLE   // Check that BLE SMP (security) is configured in make menuconfig
+	esp_ble_io_cap_t iocap = ESP_IO_CAP_NONE;
+	errRc = ::esp_ble_gap_set_security_param(ESP_BLE_SM_IOCAP_MODE, &iocap, sizeof(uint8_t));
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_ble_gap_set_security_param: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return false;
+	};
+#endif // CONFIG_BLE_SMP_ENABLE
+	m_initMetrics.security = esp_timer_get_time() - phaseStart;
+	m_initMetrics.total    = esp_timer_get_time() - initStart;
+	return true;
+} // initStack
+
+
+/**
+ * @brief Register the GATT client callback if it has not already been registered.
+ * @return ESP_OK on success (or if GATTC is not configured).
+ */
+/* STATIC */ esp_err_t BLEDevice::registerGattClient() {
 #ifdef CONFIG_GATTC_ENABLE   // Check that BLE client is configured in make menuconfig
-		errRc = esp_ble_gattc_register_callback(BLEDevice::gattClientEventHandler);
-		if (errRc != ESP_OK) {
-			ESP_LOGE(LOG_TAG, "esp_ble_gattc_register_callback: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-			return;
-		}
+	if (m_gattcRegistered) return ESP_OK;
+	int64_t phaseStart = esp_timer_get_time();
+	esp_err_t errRc = esp_ble_gattc_register_callback(BLEDevice::gattClientEventHandler);
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_ble_gattc_register_callback: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return errRc;
+	}
+	m_gattcRegistered = true;
+	m_initMetrics.gattcRegister = esp_timer_get_time() - phaseStart;
 #endif   // CONFIG_GATTC_ENABLE
+	return ESP_OK;
+} // registerGattClient
 
+
+/**
+ * @brief Register the GATT server callback if it has not already been registered.
+ * @return ESP_OK on success (or if GATTS is not configured).
+ */
+/* STATIC */ esp_err_t BLEDevice::registerGattServer() {
 #ifdef CONFIG_GATTS_ENABLE  // Check that BLE server is configured in make menuconfig
-		errRc = esp_ble_gatts_register_callback(BLEDevice::gattServerEventHandler);
-		if (errRc != ESP_OK) {
-			ESP_LOGE(LOG_TAG, "esp_ble_gatts_register_callback: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-			return;
-		}
+	if (m_gattsRegistered) return ESP_OK;
+	int64_t phaseStart = esp_timer_get_time();
+	esp_err_t errRc = esp_ble_gatts_register_callback(BLEDevice::gattServerEventHandler);
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_ble_gatts_register_callback: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return errRc;
+	}
+	m_gattsRegistered = true;
+	m_initMetrics.gattsRegister = esp_timer_get_time() - phaseStart;
 #endif   // CONFIG_GATTS_ENABLE
+	return ESP_OK;
+} // registerGattServer
 
-		errRc = ::esp_ble_gap_set_device_name(deviceName.c_str());
-		if (errRc != ESP_OK) {
-			ESP_LOGE(LOG_TAG, "esp_ble_gap_set_device_name: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-			return;
-		};
 
+/**
+ * @brief Suspend the %BLE stack.
+ *
+ * Advertising is stopped and bluedroid and the controller are disabled, which turns the radio off.  Unlike
+ * deinit(), the memory of the stack is kept and the server, service, characteristic, descriptor and
+ * advertising objects survive.  The attribute table of every service is precomputed so that resume() can
+ * register each service with a single request.  All connections are dropped.
+ * @return True if the stack was suspended.
+ */
+/* STATIC */ bool BLEDevice::suspend() {
+	ESP_LOGD(LOG_TAG, ">> suspend");
+	if (!initialized || m_suspended) {
+		ESP_LOGE(LOG_TAG, "<< suspend: not initialized or already suspended");
+		return false;
+	}
+
+	::esp_ble_gap_stop_advertising();
+#ifdef CONFIG_GATTS_ENABLE
+	if (m_pServer != nullptr) {
+		m_pServer->prepareSuspend();
+	}
+#endif
+	m_connectedClientsMap.clear();
+
+	esp_err_t errRc = ::esp_bluedroid_disable();
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_bluedroid_disable: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return false;
+	}
+	errRc = ::esp_bt_controller_disable();
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_bt_controller_disable: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return false;
+	}
+	m_suspended = true;
+	ESP_LOGD(LOG_TAG, "<< suspend");
+	return true;
+} // suspend
+
+
+/**
+ * @brief Resume the %BLE stack after suspend().
+ *
+ * The controller and bluedroid are enabled again, the GAP configuration is restored, the GATT server
+ * (if any) is registered again from its precomputed attribute tables and advertising is restarted.
+ * The time spent is available from getResumeMetrics().
+ * @param [in] advertise If true, restart advertising.
+ * @return True if the stack was resumed.
+ */
+/* STATIC */ bool BLEDevice::resume(bool advertise) {
+	ESP_LOGD(LOG_TAG, ">> resume");
+	if (!m_suspended) {
+		ESP_LOGE(LOG_TAG, "<< resume: not suspended");
+		return false;
+	}
+	memset(&m_resumeMetrics, 0, sizeof(m_resumeMetrics));
+	int64_t resumeStart = esp_timer_get_time();
+	int64_t phaseStart  = resumeStart;
+
+#ifndef CLASSIC_BT_ENABLED
+	esp_err_t errRc = ::esp_bt_controller_enable(ESP_BT_MODE_BLE);
+#else
+	esp_err_t errRc = ::esp_bt_controller_enable(ESP_BT_MODE_BTDM);
+#endif
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_bt_controller_enable: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return false;
+	}
+	m_resumeMetrics.controller = esp_timer_get_time() - phaseStart;
+	phaseStart = esp_timer_get_time();
+
+	errRc = ::esp_bluedroid_enable();
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_bluedroid_enable: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return false;
+	}
+	m_suspended = false;
+
+	errRc = ::esp_ble_gap_set_device_name(m_deviceName.c_str());
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "esp_ble_gap_set_device_name: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+	}
 #ifdef CONFIG_BLE_SMP_ENABLE   // Check that BLE SMP (security) is configured in make menuconfig
-		esp_ble_io_cap_t iocap = ESP_IO_CAP_NONE;
-		errRc = ::esp_ble_gap_set_security_param(ESP_BLE_SM_IOCAP_MODE, &iocap, sizeof(uint8_t));
-		if (errRc != ESP_OK) {
-			ESP_LOGE(LOG_TAG, "esp_ble_gap_set_security_param: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-			return;
-		};
+	esp_ble_io_cap_t iocap = ESP_IO_CAP_NONE;
+	::esp_ble_gap_set_security_param(ESP_BLE_SM_IOCAP_MODE, &iocap, sizeof(uint8_t));
 #endif // CONFIG_BLE_SMP_ENABLE
+	if (m_localMTU != 23) {
+		::esp_ble_gatt_set_local_mtu(m_localMTU);
 	}
-	vTaskDelay(200 / portTICK_PERIOD_MS); // Delay for 200 msecs as a workaround to an apparent Arduino environment issue.
-} // init
+	m_resumeMetrics.bluedroid = esp_timer_get_time() - phaseStart;
+	phaseStart = esp_timer_get_time();
+
+	bool rc = true;
+#ifdef CONFIG_GATTS_ENABLE
+	if (m_pServer != nullptr) {
+		rc = m_pServer->resume();
+	}
+#endif
+	m_resumeMetrics.gattServer = esp_timer_get_time() - phaseStart;
+	phaseStart = esp_timer_get_time();
+
+	if (m_bleAdvertising != nullptr) {
+		m_bleAdvertising->invalidateConfig();   // The restarted controller has lost the advertising data.
+	}
+	if (advertise && m_bleAdvertising != nullptr) {
+		m_bleAdvertising->start();
+	}
+	m_resumeMetrics.advertising = esp_timer_get_time() - phaseStart;
+	m_resumeMetrics.total       = esp_timer_get_time() - resumeStart;
+
+	ESP_LOGD(LOG_TAG, "<< resume: %d usecs", m_resumeMetrics.total);
+	return rc;
+} // resume
+
+
+/**
+ * @brief Is the %BLE stack currently suspended?
+ * @return True if suspend() was called and resume() has not yet succeeded.
+ */
+/* STATIC */ bool BLEDevice::isSuspended() {
+	return m_suspended;
+} // isSuspended
+
+
+/**
+ * @brief Get the time spent in each phase of the last resume().
+ * @return The resume metrics.  All values are in microseconds.
+ */
+/* STATIC */ ble_resume_metrics_t BLEDevice::getResumeMetrics() {
+	return m_resumeMetrics;
+} // getResumeMetrics
+
+
+/**
+ * @brief Get the time spent in each phase of the last initialization.
+ * @return The start up metrics.  All values are in microseconds.
+ */
+/* STATIC */ ble_init_metrics_t BLEDevice::getInitMetrics() {
+	return m_initMetrics;
+} // getInitMetrics
 
 
 /**
@@ -455,6 +709,9 @@ gatts_event_handler BLEDevice::m_customGattsHandler = nullptr;
 	if (errRc != ESP_OK) {
 		ESP_LOGE(LOG_TAG, "esp_ble_tx_power_set: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
 	};
+	if (m_bleAdvertising != nullptr) {
+		m_bleAdvertising->m_configDirty = true;   // The cached payloads may carry the old TX power level.
+	}
 	ESP_LOGD(LOG_TAG, "<< setPower");
 } // setPower
 
@@ -626,6 +883,12 @@ void BLEDevice::removePeerDevice(uint16_t conn_id, bool _client) {
     esp_bluedroid_deinit();
     esp_bt_controller_disable();
     esp_bt_controller_deinit();
+    m_gattcRegistered = false;
+    m_gattsRegistered = false;
+    m_suspended       = false;
+    if (m_bleAdvertising != nullptr) {
+        m_bleAdvertising->invalidateConfig();
+    }
 #ifndef ARDUINO_ARCH_ESP32
     if (release_memory) {
         esp_bt_controller_mem_release(ESP_BT_MODE_BTDM);  // <-- require tests because we released classic BT memory and this can cause crash (most likely not, esp-idf takes care of it)
@@ -641,10 +904,12 @@ void BLEDevice::setCustomGapHandler(gap_event_handler handler) {
 
 void BLEDevice::setCustomGattcHandler(gattc_event_handler handler) {
 	m_customGattcHandler = handler;
+	if (initialized) registerGattClient();
 }
 
 void BLEDevice::setCustomGattsHandler(gatts_event_handler handler) {
 	m_customGattsHandler = handler;
+	if (initialized) registerGattServer();
 }
 
 #endif // CONFIG_BT_ENABLED
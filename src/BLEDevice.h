@@ -28,15 +28,48 @@ typedef void (*gap_event_handler)(esp_gap_ble_cb_event_t  event, esp_ble_gap_cb_
 typedef void (*gattc_event_handler)(esp_gattc_cb_event_t event, esp_gatt_if_t gattc_if, esp_ble_gattc_cb_param_t* param);
 typedef void (*gatts_event_handler)(esp_gatts_cb_event_t event, esp_gatt_if_t gattc_if, esp_ble_gatts_cb_param_t* param);
 
+/**
+ * @brief Time spent (in microseconds) in each phase of BLEDevice initialization.
+ */
+typedef struct {
+	uint32_t controller;     // Controller init and enable (btStart under Arduino).
+	uint32_t bluedroid;      // Bluedroid init and enable.
+	uint32_t gapRegister;    // GAP callback registration.
+	uint32_t gattcRegister;  // GATT client callback registration (may happen lazily).
+	uint32_t gattsRegister;  // GATT server callback registration (may happen lazily).
+	uint32_t deviceName;     // Setting the GAP device name.
+	uint32_t security;       // Setting the security parameters.
+	uint32_t settle;         // Fixed delay of init(), 0 for initFast().
+	uint32_t total;          // Total time spent in init.
+} ble_init_metrics_t;
+
+/**
+ * @brief Time spent (in microseconds) in each phase of BLEDevice::resume().
+ */
+typedef struct {
+	uint32_t controller;     // Controller enable.
+	uint32_t bluedroid;      // Bluedroid enable and GAP configuration.
+	uint32_t gattServer;     // GATT server app and attribute table registration.
+	uint32_t advertising;    // Restarting advertising.
+	uint32_t total;          // Total time spent in resume.
+} ble_resume_metrics_t;
+
 class BLEDevice {
 public:
 
 	static BLEClient*  createClient();    // Create a new BLE client.
 	static BLEServer*  createServer();    // Cretae a new BLE server.
 	static BLEAddress  getAddress();      // Retrieve our own local BD address.
+	static std::string getDeviceName();   // Retrieve the name we were initialized with.
 	static BLEScan*    getScan();         // Get the scan object
 	static std::string getValue(BLEAddress bdAddress, BLEUUID serviceUUID, BLEUUID characteristicUUID);	  // Get the value of a characteristic of a service on a server.
 	static void        init(std::string deviceName);   // Initialize the local BLE environment.
+	static bool        initFast(std::string deviceName);   // Initialize without the fixed settle delay.
+	static ble_init_metrics_t getInitMetrics();        // Time spent in each phase of initialization.
+	static bool        suspend();         // Turn the radio off but keep the GATT database objects.
+	static bool        resume(bool advertise = true);  // Turn the radio back on and re-register the GATT database.
+	static bool        isSuspended();     // Is the stack currently suspended?
+	static ble_resume_metrics_t getResumeMetrics();    // Time spent in each phase of the last resume.
 	static void        setPower(esp_power_level_t powerLevel);  // Set our power level.
 	static void        setValue(BLEAddress bdAddress, BLEUUID serviceUUID, BLEUUID characteristicUUID, std::string value);   // Set the value of a characteristic on a service on a server.
 	static std::string toString();        // Return a string representation of our device.
@@ -72,6 +105,16 @@ private:
 	static BLEAdvertising* m_bleAdvertising;
 	static esp_gatt_if_t getGattcIF();
 	static std::map<uint16_t, conn_status_t> m_connectedClientsMap;	
+	static ble_init_metrics_t m_initMetrics;
+	static bool m_gattcRegistered;
+	static bool m_gattsRegistered;
+	static bool m_suspended;
+	static std::string m_deviceName;
+	static ble_resume_metrics_t m_resumeMetrics;
+
+	static bool      initStack(std::string deviceName, bool lazyGatt);
+	static esp_err_t registerGattClient();
+	static esp_err_t registerGattServer();
 
 	static void gattClientEventHandler(
 		esp_gattc_cb_event_t      event,
@@ -112,6 +112,18 @@ std::string BLEEddystoneTLM::toString() {
   return ss.str();
 } // toString
 
+/**
+ * @brief Load the frame from Eddystone service data without allocating.
+ * @param [in] pData The service data following the 0xFEAA UUID, starting with the frame type.
+ * @param [in] length The length of the data.
+ * @return True if the data is a TLM frame, false (leaving the frame unchanged) otherwise.
+ */
+bool BLEEddystoneTLM::parse(const uint8_t* pData, size_t length) {
+	if (pData == nullptr || length != sizeof(m_eddystoneData) || pData[0] != EDDYSTONE_TLM_FRAME_TYPE) return false;
+	memcpy(&m_eddystoneData, pData, sizeof(m_eddystoneData));
+	return true;
+} // parse
+
 /**
  * Set the raw data for the beacon record.
  */
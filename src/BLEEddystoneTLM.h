@@ -27,6 +27,7 @@ public:
 	uint32_t	getCount();
 	uint32_t	getTime();
 	std::string toString();
+	bool		parse(const uint8_t* pData, size_t length);
 	void		setData(std::string data);
 	void		setUUID(BLEUUID l_uuid);
 	void		setVersion(uint8_t version);
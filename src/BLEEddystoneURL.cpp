@@ -21,7 +21,8 @@ BLEEddystoneURL::BLEEddystoneURL() {
 } // BLEEddystoneURL
 
 std::string BLEEddystoneURL::getData() {
-	return std::string((char*) &m_eddystoneData, sizeof(m_eddystoneData));
+	// Only the used part of the URL; trailing zeros would decode as ".com/".
+	return std::string((char*) &m_eddystoneData, sizeof(m_eddystoneData) - sizeof(m_eddystoneData.url) + lengthURL);
 } // getData
 
 BLEUUID BLEEddystoneURL::getUUID() {
@@ -33,97 +34,168 @@ int8_t BLEEddystoneURL::getPower() {
 } // getPower
 
 std::string BLEEddystoneURL::getURL() {
-	return std::string((char*) &m_eddystoneData.url, sizeof(m_eddystoneData.url));
+	return std::string((char*) &m_eddystoneData.url, lengthURL);
 } // getURL
 
+const uint8_t* BLEEddystoneURL::getURLData() {
+	return m_eddystoneData.url;
+} // getURLData
+
+size_t BLEEddystoneURL::getURLLength() {
+	return lengthURL;
+} // getURLLength
+
 std::string BLEEddystoneURL::getDecodedURL() {
-	std::string decodedURL = "";
-
-	switch (m_eddystoneData.url[0]) {
-		case 0x00:
-			decodedURL += "http://www.";
-			break;
-		case 0x01:
-			decodedURL += "https://www.";
-			break;
-		case 0x02:
-			decodedURL += "http://";
-			break;
-		case 0x03:
-			decodedURL += "https://";
-			break;
-		default:
-			decodedURL += m_eddystoneData.url[0];
+	char decodedURL[EDDYSTONE_URL_DECODED_MAX];
+	size_t length = getDecodedURL(decodedURL, sizeof(decodedURL));
+	return std::string(decodedURL, length);
+} // getDecodedURL
+
+/**
+ * Eddystone URL compression tables.  The index of an entry is its code.
+ * See https://github.com/google/eddystone/tree/master/eddystone-url.
+ */
+typedef struct {
+	const char* text;
+	uint8_t     length;
+} eddystone_url_code_t;
+
+static const eddystone_url_code_t urlSchemes[] = {
+	{ "http://www.", 11 }, { "https://www.", 12 }, { "http://", 7 }, { "https://", 8 }
+};
+
+static const eddystone_url_code_t urlExpansions[] = {
+	{ ".com/", 5 }, { ".org/", 5 }, { ".edu/", 5 }, { ".net/", 5 }, { ".info/", 6 }, { ".biz/", 5 }, { ".gov/", 5 },
+	{ ".com", 4 },  { ".org", 4 },  { ".edu", 4 },  { ".net", 4 },  { ".info", 5 },  { ".biz", 4 },  { ".gov", 4 }
+};
+
+#define URL_SCHEME_COUNT    (sizeof(urlSchemes) / sizeof(urlSchemes[0]))
+#define URL_EXPANSION_COUNT (sizeof(urlExpansions) / sizeof(urlExpansions[0]))
+
+
+/**
+ * @brief Find the longest table entry that the text starts with.
+ * @param [in] pTable The table to search.
+ * @param [in] count The number of entries in the table.
+ * @param [in] pText The text.
+ * @return The code of the longest match or -1 if no entry matches.
+ */
+static int longestMatch(const eddystone_url_code_t* pTable, size_t count, const char* pText) {
+	int best = -1;
+	for (size_t i = 0; i < count; i++) {
+		if ((best < 0 || pTable[i].length > pTable[best].length) && strncmp(pText, pTable[i].text, pTable[i].length) == 0) {
+			best = i;
+		}
 	}
+	return best;
+} // longestMatch
 
-	for (int i = 1; i < lengthURL; i++) {
-		if (m_eddystoneData.url[i] > 33 && m_eddystoneData.url[i] < 127) {
-			decodedURL += m_eddystoneData.url[i];
+
+/**
+ * @brief Compress a URL into the Eddystone URL encoding.
+ *
+ * The scheme is replaced by its prefix code and each place where an expansion (".com/", ".org" ...) matches
+ * is replaced by its code, always choosing the longest expansion that matches.
+ *
+ * @param [in] url The NUL terminated URL, e.g. "https://www.example.com/".
+ * @param [out] pEncoded Receives the encoded URL, starting with the scheme code.
+ * @param [in] encodedSize The size of pEncoded; the frame holds EDDYSTONE_URL_ENCODED_MAX bytes.
+ * @return The length of the encoded URL or 0 if the URL has no known scheme, contains characters that
+ * cannot be sent or does not fit.
+ */
+/* STATIC */ size_t BLEEddystoneURL::encodeURL(const char* url, uint8_t* pEncoded, size_t encodedSize) {
+	int scheme = longestMatch(urlSchemes, URL_SCHEME_COUNT, url);
+	if (scheme < 0 || encodedSize == 0) return 0;
+	pEncoded[0] = scheme;
+	size_t length = 1;
+	const char* p = url + urlSchemes[scheme].length;
+	while (*p != 0) {
+		if (length >= encodedSize) return 0;
+		int expansion = longestMatch(urlExpansions, URL_EXPANSION_COUNT, p);
+		if (expansion >= 0) {
+			pEncoded[length++] = expansion;
+			p += urlExpansions[expansion].length;
+		} else if (*p > 32 && *p < 127) {
+			pEncoded[length++] = *p++;
 		} else {
-			switch (m_eddystoneData.url[i]) {
-				case 0x00:
-					decodedURL += ".com/";
-					break;
-				case 0x01:
-					decodedURL += ".org/";
-					break;
-				case 0x02:
-					decodedURL += ".edu/";
-					break;
-				case 0x03:
-					decodedURL += ".net/";
-					break;
-				case 0x04:
-					decodedURL += ".info/";
-					break;
-				case 0x05:
-					decodedURL += ".biz/";
-					break;
-				case 0x06:
-					decodedURL += ".gov/";
-					break;
-				case 0x07:
-					decodedURL += ".com";
-					break;
-				case 0x08:
-					decodedURL += ".org";
-					break;
-				case 0x09:
-					decodedURL += ".edu";
-					break;
-				case 0x0A:
-					decodedURL += ".net";
-					break;
-				case 0x0B:
-					decodedURL += ".info";
-					break;
-				case 0x0C:
-					decodedURL += ".biz";
-					break;
-				case 0x0D:
-					decodedURL += ".gov";
-					break;
-				default:
-					break;
-			}
+			return 0;   // Codes below 0x21 are reserved for expansions.
+		}
+	}
+	return length;
+} // encodeURL
+
+
+/**
+ * @brief Append text to a buffer, keeping room for the terminator but counting the full length.
+ */
+static void appendText(char* pBuffer, size_t bufferSize, size_t* pLength, const char* pText, size_t textLength) {
+	if (*pLength + 1 < bufferSize) {
+		size_t room = bufferSize - 1 - *pLength;
+		memcpy(pBuffer + *pLength, pText, textLength < room ? textLength : room);
+	}
+	*pLength += textLength;
+} // appendText
+
+
+/**
+ * @brief Decode the URL into a caller supplied buffer without allocating.
+ * @param [out] pBuffer The buffer to receive the NUL terminated URL.
+ * @param [in] bufferSize The size of the buffer; EDDYSTONE_URL_DECODED_MAX always suffices.
+ * @return The length of the decoded URL.  If this is not less than bufferSize the URL was truncated.
+ */
+size_t BLEEddystoneURL::getDecodedURL(char* pBuffer, size_t bufferSize) {
+	size_t length = 0;
+
+	uint8_t scheme = m_eddystoneData.url[0];
+	if (scheme < URL_SCHEME_COUNT) {
+		appendText(pBuffer, bufferSize, &length, urlSchemes[scheme].text, urlSchemes[scheme].length);
+	} else {
+		appendText(pBuffer, bufferSize, &length, (const char*) &m_eddystoneData.url[0], 1);
+	}
+
+	for (int i = 1; i < lengthURL; i++) {
+		uint8_t c = m_eddystoneData.url[i];
+		if (c < URL_EXPANSION_COUNT) {
+			appendText(pBuffer, bufferSize, &length, urlExpansions[c].text, urlExpansions[c].length);
+		} else if (c > 32 && c < 127) {
+			appendText(pBuffer, bufferSize, &length, (const char*) &m_eddystoneData.url[i], 1);
 		}
 	}
-	return decodedURL;
+	if (bufferSize > 0) {
+		pBuffer[length < bufferSize ? length : bufferSize - 1] = 0;
+	}
+	return length;
 } // getDecodedURL
 
 
 
+/**
+ * @brief Load the frame from Eddystone service data without allocating.
+ * @param [in] pData The service data following the 0xFEAA UUID, starting with the frame type.
+ * @param [in] length The length of the data; a URL frame is 3 to 20 bytes.
+ * @return True if the data is a URL frame, false (leaving the frame unchanged) otherwise.
+ */
+bool BLEEddystoneURL::parse(const uint8_t* pData, size_t length) {
+	size_t header = sizeof(m_eddystoneData) - sizeof(m_eddystoneData.url);
+	if (pData == nullptr || length <= header || length > sizeof(m_eddystoneData) || pData[0] != EDDYSTONE_URL_FRAME_TYPE) return false;
+	memset(&m_eddystoneData, 0, sizeof(m_eddystoneData));
+	memcpy(&m_eddystoneData, pData, length);
+	lengthURL = length - header;
+	return true;
+} // parse
+
 /**
  * Set the raw data for the beacon record.
  */
 void BLEEddystoneURL::setData(std::string data) {
-	if (data.length() > sizeof(m_eddystoneData)) {
-		ESP_LOGE(LOG_TAG, "Unable to set the data ... length passed in was %d and max expected %d", data.length(), sizeof(m_eddystoneData));
+	size_t header = sizeof(m_eddystoneData) - sizeof(m_eddystoneData.url);
+	if (data.length() <= header || data.length() > sizeof(m_eddystoneData)) {
+		ESP_LOGE(LOG_TAG, "Unable to set the data ... length passed in was %d and expected %d to %d", data.length(), header + 1, sizeof(m_eddystoneData));
 		return;
 	}
 	memset(&m_eddystoneData, 0, sizeof(m_eddystoneData));
 	memcpy(&m_eddystoneData, data.data(), data.length());
-	lengthURL = data.length() - (sizeof(m_eddystoneData) - sizeof(m_eddystoneData.url));
+	lengthURL = data.length() - header;
 } // setData
 
 void BLEEddystoneURL::setUUID(BLEUUID l_uuid) {
@@ -144,5 +216,23 @@ void BLEEddystoneURL::setURL(std::string url) {
   lengthURL = url.length();
 } // setURL
 
+/**
+ * @brief Set the URL from its readable form, compressing it with encodeURL().
+ * @param [in] url The NUL terminated URL, e.g. "https://www.example.com/".
+ * @return True on success, false if the URL cannot be encoded or does not fit.
+ */
+bool BLEEddystoneURL::setDecodedURL(const char* url) {
+	uint8_t encoded[EDDYSTONE_URL_ENCODED_MAX];
+	size_t length = encodeURL(url, encoded, sizeof(encoded));
+	if (length == 0) {
+		ESP_LOGE(LOG_TAG, "Unable to encode the url %s in %d bytes", url, sizeof(encoded));
+		return false;
+	}
+	memset(m_eddystoneData.url, 0, sizeof(m_eddystoneData.url));
+	memcpy(m_eddystoneData.url, encoded, length);
+	lengthURL = length;
+	return true;
+} // setDecodedURL
+
 
 #endif
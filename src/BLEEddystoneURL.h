@@ -10,6 +10,8 @@
 #include "BLEUUID.h"
 
 #define EDDYSTONE_URL_FRAME_TYPE 0x10
+#define EDDYSTONE_URL_ENCODED_MAX 18    // Scheme code + 17 bytes of encoded URL.
+#define EDDYSTONE_URL_DECODED_MAX 115   // "https://www." + 17 * ".info/" + NUL.
 
 /**
  * @brief Representation of a beacon.
@@ -24,10 +26,16 @@ public:
 	int8_t	  getPower();
 	std::string getURL();
 	std::string getDecodedURL();
+	size_t	  getDecodedURL(char* pBuffer, size_t bufferSize);
+	const uint8_t* getURLData();
+	size_t	  getURLLength();
+	bool		parse(const uint8_t* pData, size_t length);
 	void		setData(std::string data);
 	void		setUUID(BLEUUID l_uuid);
 	void		setPower(int8_t advertisedTxPower);
 	void		setURL(std::string url);
+	bool		setDecodedURL(const char* url);
+	static size_t encodeURL(const char* url, uint8_t* pEncoded, size_t encodedSize);
 
 private:
 	uint16_t beaconUUID;
@@ -35,7 +43,7 @@ private:
 	struct {
 		uint8_t frameType;
 		int8_t  advertisedTxPower;
-		uint8_t url[16];
+		uint8_t url[EDDYSTONE_URL_ENCODED_MAX];
 	} __attribute__((packed)) m_eddystoneData;
 
 }; // BLEEddystoneURL
@@ -9,10 +9,14 @@
 #define COMPONENTS_CPP_UTILS_BLEEXCEPTIONS_H_
 #include "sdkconfig.h"
 
-#if CONFIG_CXX_EXCEPTIONS != 1
-#error "C++ exception handling must be enabled within make menuconfig. See Compiler Options > Enable C++ Exceptions."
+// Define BLE_NO_EXCEPTIONS (or build without CONFIG_CXX_EXCEPTIONS) to remove the exception classes.  The
+// client API then reports failures only through the esp_err_t returned by the try*() methods and the
+// legacy methods return empty values instead of throwing.
+#if !defined(BLE_NO_EXCEPTIONS) && CONFIG_CXX_EXCEPTIONS != 1
+#define BLE_NO_EXCEPTIONS
 #endif
 
+#ifndef BLE_NO_EXCEPTIONS
 #include <exception>
 
 
@@ -28,4 +32,5 @@ class BLEUuidNotFoundException : public std::exception {
 	}
 };
 
+#endif /* BLE_NO_EXCEPTIONS */
 #endif /* COMPONENTS_CPP_UTILS_BLEEXCEPTIONS_H_ */
@@ -43,6 +43,7 @@ BLEHIDDevice::BLEHIDDevice(BLEServer* server) {
 	m_batteryLevelCharacteristic = m_batteryService->createCharacteristic((uint16_t) 0x2a19, BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY);
 	m_batteryLevelCharacteristic->addDescriptor(batteryLevelDescriptor);
 	m_batteryLevelCharacteristic->addDescriptor(new BLE2902());
+	m_batteryLevelCharacteristic->setNotifyOnChange(true);   // Only notify when the level changes.
 
 	/*
 	 * This value is setup here because its default value in most usage cases, its very rare to use boot mode
@@ -62,6 +63,25 @@ void BLEHIDDevice::reportMap(uint8_t* map, uint16_t size) {
 	m_reportMapCharacteristic->setValue(map, size);
 }
 
+/*
+ * @brief Install a report map and create the characteristics of the reports it describes
+ * @param [in] map report map, normally BLEHIDReportMap<...>::data
+ * @param [in] size size of the report map
+ * @param [in] pInfo report IDs and lengths of the reports in the map
+ * @param [in] count number of entries in pInfo
+ * @param [out] pReports receives the characteristics created for each entry of pInfo
+ */
+void BLEHIDDevice::createReports(const uint8_t* map, uint16_t size, const ble_hid_report_info_t* pInfo, size_t count,
+		ble_hid_report_characteristics_t* pReports) {
+	reportMap((uint8_t*) map, size);
+	for (size_t i = 0; i < count; i++) {
+		pReports[i].id       = pInfo[i].id;
+		pReports[i].pInput   = pInfo[i].inputLength > 0   ? inputReport(pInfo[i].id)   : nullptr;
+		pReports[i].pOutput  = pInfo[i].outputLength > 0  ? outputReport(pInfo[i].id)  : nullptr;
+		pReports[i].pFeature = pInfo[i].featureLength > 0 ? featureReport(pInfo[i].id) : nullptr;
+	}
+}
+
 /*
  * @brief This function suppose to be called at the end, when we have created all characteristics we need to build HID service
  */
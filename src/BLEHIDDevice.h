@@ -27,12 +27,34 @@
 #define HID_DIGITAL_PEN	0x03C7
 #define HID_BARCODE		0x03C8
 
+/**
+ * @brief The lengths of the reports sharing one report ID; 0 when the report does not exist.
+ */
+typedef struct {
+	uint8_t id;
+	uint8_t inputLength;
+	uint8_t outputLength;
+	uint8_t featureLength;
+} ble_hid_report_info_t;
+
+/**
+ * @brief The characteristics created for one report ID; nullptr when the report does not exist.
+ */
+typedef struct {
+	uint8_t            id;
+	BLECharacteristic* pInput;
+	BLECharacteristic* pOutput;
+	BLECharacteristic* pFeature;
+} ble_hid_report_characteristics_t;
+
 class BLEHIDDevice {
 public:
 	BLEHIDDevice(BLEServer*);
 	virtual ~BLEHIDDevice();
 
 	void reportMap(uint8_t* map, uint16_t);
+	void createReports(const uint8_t* map, uint16_t size, const ble_hid_report_info_t* pInfo, size_t count,
+		ble_hid_report_characteristics_t* pReports);
 	void startServices();
 
 	BLEService* deviceInfo();
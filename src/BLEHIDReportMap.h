@@ -0,0 +1,236 @@
+/*
+ * BLEHIDReportMap.h
+ *
+ *  Compile time construction of HID report maps.
+ */
+
+#ifndef _BLEHIDREPORTMAP_H_
+#define _BLEHIDREPORTMAP_H_
+
+#include "sdkconfig.h"
+#if defined(CONFIG_BT_ENABLED)
+
+#include <type_traits>
+#include "BLEHIDDevice.h"
+
+/**
+ * @brief Build a HID report map, and the report characteristics that go with it, at compile time.
+ *
+ * A map is declared as a type.  Each report is an application collection with its own report ID:
+ *
+ *   typedef BLEHIDReportMap<
+ *     BLEHIDReport<1, HID_USAGE_PAGE_GENERIC_DESKTOP, 0x06,       // Keyboard
+ *       BLEHIDUsagePage<HID_USAGE_PAGE_KEYBOARD>,
+ *       BLEHIDUsageMinimum<0xE0>, BLEHIDUsageMaximum<0xE7>,
+ *       BLEHIDLogicalMinimum<0>, BLEHIDLogicalMaximum<1>,
+ *       BLEHIDInput<1, 8, HID_DATA_VARIABLE_ABSOLUTE>,             // Modifiers
+ *       BLEHIDInput<8, 1, HID_CONSTANT>,                           // Reserved
+ *       BLEHIDUsagePage<HID_USAGE_PAGE_LED>,
+ *       BLEHIDUsageMinimum<1>, BLEHIDUsageMaximum<5>,
+ *       BLEHIDOutput<1, 5, HID_DATA_VARIABLE_ABSOLUTE>,            // LEDs
+ *       BLEHIDOutput<3, 1, HID_CONSTANT>,
+ *       BLEHIDUsagePage<HID_USAGE_PAGE_KEYBOARD>,
+ *       BLEHIDUsageMinimum<0>, BLEHIDUsageMaximum<0x65>,
+ *       BLEHIDLogicalMaximum<0x65>,
+ *       BLEHIDInput<8, 6, HID_DATA_ARRAY_ABSOLUTE>                 // Keys
+ *     >
+ *   > KeyboardMap;
+ *
+ *   ble_hid_report_characteristics_t reports[KeyboardMap::count];
+ *   KeyboardMap::create(pHIDDevice, reports);
+ *   KeyboardMap::Report<0>::input_t keys;    // 8 bytes, derived from the map.
+ *
+ * The encoded map is a constant array in flash.  The input, output and feature report lengths of every
+ * report are summed from its main items.  create() installs the map and creates one characteristic for
+ * each kind of report that exists, with the matching report reference descriptor, so the IDs can not
+ * drift from the map.  A report that is not a whole number of bytes, a duplicate or zero report ID and
+ * a report longer than MAX_HID_REPORT_SIZE fail to compile.
+ */
+
+#define HID_USAGE_PAGE_GENERIC_DESKTOP 0x01
+#define HID_USAGE_PAGE_KEYBOARD        0x07
+#define HID_USAGE_PAGE_LED             0x08
+#define HID_USAGE_PAGE_BUTTON          0x09
+#define HID_USAGE_PAGE_CONSUMER        0x0C
+
+// Main item flags.
+#define HID_DATA_ARRAY_ABSOLUTE        0x00
+#define HID_CONSTANT                   0x01
+#define HID_DATA_VARIABLE_ABSOLUTE     0x02
+#define HID_DATA_VARIABLE_RELATIVE     0x06
+
+// Collection types.
+#define HID_COLLECTION_PHYSICAL        0x00
+#define HID_COLLECTION_APPLICATION     0x01
+#define HID_COLLECTION_LOGICAL         0x02
+
+
+template<uint8_t... Bytes>
+struct BLEHIDBytes {
+	static constexpr size_t  length = sizeof...(Bytes);
+	static constexpr uint8_t data[sizeof...(Bytes) > 0 ? sizeof...(Bytes) : 1] = { Bytes... };
+};
+template<uint8_t... Bytes>
+constexpr uint8_t BLEHIDBytes<Bytes...>::data[sizeof...(Bytes) > 0 ? sizeof...(Bytes) : 1];
+
+template<typename... Parts> struct BLEHIDConcat;
+template<> struct BLEHIDConcat<> {
+	typedef BLEHIDBytes<> type;
+};
+template<uint8_t... A> struct BLEHIDConcat<BLEHIDBytes<A...>> {
+	typedef BLEHIDBytes<A...> type;
+};
+template<uint8_t... A, uint8_t... B, typename... Rest>
+struct BLEHIDConcat<BLEHIDBytes<A...>, BLEHIDBytes<B...>, Rest...> : BLEHIDConcat<BLEHIDBytes<A..., B...>, Rest...> {
+};
+
+// A short item holding the value in the fewest bytes (1, 2 or 4).
+template<uint8_t Prefix, uint32_t Value>
+using BLEHIDUnsignedItem = typename std::conditional<(Value <= 0xff),
+	BLEHIDBytes<Prefix | 1, (uint8_t) Value>,
+	typename std::conditional<(Value <= 0xffff),
+		BLEHIDBytes<Prefix | 2, (uint8_t) Value, (uint8_t) (Value >> 8)>,
+		BLEHIDBytes<Prefix | 3, (uint8_t) Value, (uint8_t) (Value >> 8), (uint8_t) (Value >> 16), (uint8_t) (Value >> 24)>
+	>::type
+>::type;
+
+template<uint8_t Prefix, int32_t Value>
+using BLEHIDSignedItem = typename std::conditional<(Value >= -128 && Value <= 127),
+	BLEHIDBytes<Prefix | 1, (uint8_t) Value>,
+	typename std::conditional<(Value >= -32768 && Value <= 32767),
+		BLEHIDBytes<Prefix | 2, (uint8_t) Value, (uint8_t) (Value >> 8)>,
+		BLEHIDBytes<Prefix | 3, (uint8_t) Value, (uint8_t) (Value >> 8), (uint8_t) (Value >> 16), (uint8_t) (Value >> 24)>
+	>::type
+>::type;
+
+/**
+ * @brief An element of a map: its encoding and the bits it adds to each kind of report.
+ */
+template<typename Bytes, uint16_t InputBits = 0, uint16_t OutputBits = 0, uint16_t FeatureBits = 0>
+struct BLEHIDItem {
+	typedef Bytes bytes;
+	static constexpr uint16_t inputBits   = InputBits;
+	static constexpr uint16_t outputBits  = OutputBits;
+	static constexpr uint16_t featureBits = FeatureBits;
+};
+
+template<typename... Items> struct BLEHIDItems;
+template<> struct BLEHIDItems<> : BLEHIDItem<BLEHIDBytes<>> {
+};
+template<typename First, typename... Rest>
+struct BLEHIDItems<First, Rest...> : BLEHIDItem<
+	typename BLEHIDConcat<typename First::bytes, typename BLEHIDItems<Rest...>::bytes>::type,
+	First::inputBits   + BLEHIDItems<Rest...>::inputBits,
+	First::outputBits  + BLEHIDItems<Rest...>::outputBits,
+	First::featureBits + BLEHIDItems<Rest...>::featureBits> {
+};
+
+template<uint16_t Page>   using BLEHIDUsagePage      = BLEHIDItem<BLEHIDUnsignedItem<0x04, Page>>;
+template<uint16_t Usage>  using BLEHIDUsage          = BLEHIDItem<BLEHIDUnsignedItem<0x08, Usage>>;
+template<uint16_t Usage>  using BLEHIDUsageMinimum   = BLEHIDItem<BLEHIDUnsignedItem<0x18, Usage>>;
+template<uint16_t Usage>  using BLEHIDUsageMaximum   = BLEHIDItem<BLEHIDUnsignedItem<0x28, Usage>>;
+template<int32_t Minimum> using BLEHIDLogicalMinimum = BLEHIDItem<BLEHIDSignedItem<0x14, Minimum>>;
+template<int32_t Maximum> using BLEHIDLogicalMaximum = BLEHIDItem<BLEHIDSignedItem<0x24, Maximum>>;
+
+// Main items: Size bits per field, Count fields.
+template<uint8_t Size, uint8_t Count, uint8_t Flags>
+using BLEHIDInput = BLEHIDItem<typename BLEHIDConcat<BLEHIDUnsignedItem<0x74, Size>, BLEHIDUnsignedItem<0x94, Count>,
+	BLEHIDUnsignedItem<0x80, Flags>>::type, Size * Count, 0, 0>;
+template<uint8_t Size, uint8_t Count, uint8_t Flags>
+using BLEHIDOutput = BLEHIDItem<typename BLEHIDConcat<BLEHIDUnsignedItem<0x74, Size>, BLEHIDUnsignedItem<0x94, Count>,
+	BLEHIDUnsignedItem<0x90, Flags>>::type, 0, Size * Count, 0>;
+template<uint8_t Size, uint8_t Count, uint8_t Flags>
+using BLEHIDFeature = BLEHIDItem<typename BLEHIDConcat<BLEHIDUnsignedItem<0x74, Size>, BLEHIDUnsignedItem<0x94, Count>,
+	BLEHIDUnsignedItem<0xB0, Flags>>::type, 0, 0, Size * Count>;
+
+template<uint8_t Type, typename... Items>
+struct BLEHIDCollection : BLEHIDItem<
+	typename BLEHIDConcat<BLEHIDBytes<0xA1, Type>, typename BLEHIDItems<Items...>::bytes, BLEHIDBytes<0xC0>>::type,
+	BLEHIDItems<Items...>::inputBits, BLEHIDItems<Items...>::outputBits, BLEHIDItems<Items...>::featureBits> {
+};
+
+/**
+ * @brief Fixed size storage of one report, as sent over the air (without the report ID).
+ */
+template<size_t Length>
+struct BLEHIDReportData {
+	uint8_t data[Length > 0 ? Length : 1];
+} __attribute__((packed));
+
+/**
+ * @brief An application collection with its own report ID.
+ */
+template<uint8_t Id, uint16_t UsagePage, uint16_t Usage, typename... Items>
+struct BLEHIDReport : BLEHIDCollection<HID_COLLECTION_APPLICATION, BLEHIDItem<BLEHIDBytes<0x85, Id>>, Items...> {
+	typedef BLEHIDCollection<HID_COLLECTION_APPLICATION, BLEHIDItem<BLEHIDBytes<0x85, Id>>, Items...> collection;
+	typedef typename BLEHIDConcat<typename BLEHIDUsagePage<UsagePage>::bytes, typename BLEHIDUsage<Usage>::bytes,
+		typename collection::bytes>::type bytes;
+
+	static constexpr uint8_t id            = Id;
+	static constexpr uint8_t inputLength   = collection::inputBits / 8;
+	static constexpr uint8_t outputLength  = collection::outputBits / 8;
+	static constexpr uint8_t featureLength = collection::featureBits / 8;
+	typedef BLEHIDReportData<inputLength>   input_t;
+	typedef BLEHIDReportData<outputLength>  output_t;
+	typedef BLEHIDReportData<featureLength> feature_t;
+
+	static_assert(Id != 0, "Report ID 0 is reserved");
+	static_assert(collection::inputBits % 8 == 0, "Input report is not a whole number of bytes; add padding");
+	static_assert(collection::outputBits % 8 == 0, "Output report is not a whole number of bytes; add padding");
+	static_assert(collection::featureBits % 8 == 0, "Feature report is not a whole number of bytes; add padding");
+	static_assert(collection::inputBits <= MAX_HID_REPORT_SIZE * 8 && collection::outputBits <= MAX_HID_REPORT_SIZE * 8 &&
+		collection::featureBits <= MAX_HID_REPORT_SIZE * 8, "Report exceeds MAX_HID_REPORT_SIZE");
+};
+
+template<uint8_t Id, uint8_t... Ids> struct BLEHIDContains;
+template<uint8_t Id> struct BLEHIDContains<Id> : std::false_type {
+};
+template<uint8_t Id, uint8_t First, uint8_t... Rest>
+struct BLEHIDContains<Id, First, Rest...> : std::integral_constant<bool, Id == First || BLEHIDContains<Id, Rest...>::value> {
+};
+
+template<uint8_t... Ids> struct BLEHIDUniqueIds;
+template<> struct BLEHIDUniqueIds<> : std::true_type {
+};
+template<uint8_t First, uint8_t... Rest>
+struct BLEHIDUniqueIds<First, Rest...> : std::integral_constant<bool,
+	!BLEHIDContains<First, Rest...>::value && BLEHIDUniqueIds<Rest...>::value> {
+};
+
+template<size_t Index, typename... Reports> struct BLEHIDReportAt;
+template<typename First, typename... Rest> struct BLEHIDReportAt<0, First, Rest...> {
+	typedef First type;
+};
+template<size_t Index, typename First, typename... Rest> struct BLEHIDReportAt<Index, First, Rest...> : BLEHIDReportAt<Index - 1, Rest...> {
+};
+
+/**
+ * @brief A complete report map.
+ */
+template<typename... Reports>
+struct BLEHIDReportMap : BLEHIDConcat<typename Reports::bytes...>::type {
+	static_assert(sizeof...(Reports) > 0, "A report map needs at least one report");
+	static_assert(BLEHIDUniqueIds<Reports::id...>::value, "Report IDs must be unique");
+
+	static constexpr size_t count = sizeof...(Reports);
+	static constexpr ble_hid_report_info_t info[sizeof...(Reports)] = {
+		{ Reports::id, Reports::inputLength, Reports::outputLength, Reports::featureLength }...
+	};
+
+	template<size_t Index>
+	using Report = typename BLEHIDReportAt<Index, Reports...>::type;
+
+	/**
+	 * @brief Install the map and create the characteristics of every report.
+	 * @param [in] pDevice The HID device.
+	 * @param [out] reports Receives the characteristics, in the order of the reports in the map.
+	 */
+	static void create(BLEHIDDevice* pDevice, ble_hid_report_characteristics_t (&reports)[sizeof...(Reports)]) {
+		pDevice->createReports(BLEHIDReportMap::data, BLEHIDReportMap::length, info, count, reports);
+	}
+};
+template<typename... Reports>
+constexpr ble_hid_report_info_t BLEHIDReportMap<Reports...>::info[sizeof...(Reports)];
+
+#endif // CONFIG_BT_ENABLED
+#endif /* _BLEHIDREPORTMAP_H_ */
@@ -0,0 +1,262 @@
+/*
+ * BLEHIDReportSender.cpp
+ *
+ *  Low latency sending of HID input reports.
+ */
+#include "sdkconfig.h"
+#if defined(CONFIG_BT_ENABLED)
+#include <string.h>
+#include <esp_err.h>
+#include <esp_timer.h>
+#include <esp_gatts_api.h>
+#include "BLEHIDReportSender.h"
+#include "GeneralUtils.h"
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_ARDUHAL_ESP_LOG)
+#include "esp32-hal-log.h"
+#define LOG_TAG ""
+#else
+#include "esp_log.h"
+static const char* LOG_TAG = "BLEHIDReportSender";
+#endif
+
+
+/**
+ * @brief Construct a sender for the reports of a server.
+ *
+ * The sender registers itself as the congestion handler of the server.
+ *
+ * @param [in] pServer The server hosting the HID service.
+ */
+BLEHIDReportSender::BLEHIDReportSender(BLEServer* pServer) {
+	m_pServer     = pServer;
+	m_reportCount = 0;
+	resetStackLatency();
+	m_pServer->setCongestionHandler(congestionHandler, this);
+} // BLEHIDReportSender
+
+
+BLEHIDReportSender::~BLEHIDReportSender() {
+	m_pServer->setCongestionHandler(nullptr, nullptr);
+} // ~BLEHIDReportSender
+
+
+/**
+ * @brief Add an input report.
+ * @param [in] pCharacteristic The input report characteristic, see BLEHIDDevice::inputReport().
+ * @param [in] length The length of the report in bytes.
+ * @param [in] relativeMask Bit n set if byte n of the report is a signed relative value (e.g. mouse X, Y
+ * and wheel) that may be summed when reports are merged.
+ * @return The index of the report to pass to send() or -1 if the report can not be added.
+ */
+int BLEHIDReportSender::addReport(BLECharacteristic* pCharacteristic, uint8_t length, uint32_t relativeMask) {
+	if (m_reportCount >= HID_REPORT_SENDER_MAX_REPORTS || length > HID_REPORT_SENDER_MAX_LENGTH) {
+		ESP_LOGE(LOG_TAG, "Unable to add a report of %d bytes, %d reports already added", length, m_reportCount);
+		return -1;
+	}
+	hid_report_slot_t& slot = m_reports[m_reportCount];
+	slot.pCharacteristic = pCharacteristic;
+	slot.p2902           = (BLE2902*) pCharacteristic->getDescriptorByUUID((uint16_t) 0x2902);   // Looked up once.
+	slot.length          = length;
+	slot.relativeMask    = relativeMask;
+	slot.pending         = false;
+	slot.inputTime       = 0;
+	memset(slot.data, 0, sizeof(slot.data));
+	return m_reportCount++;
+} // addReport
+
+
+/**
+ * @brief Handle a change in the congestion of the link; pending reports are sent when it clears.
+ */
+/* STATIC */ void BLEHIDReportSender::congestionHandler(uint16_t connId, bool congested, void* pArg) {
+	if (!congested) {
+		((BLEHIDReportSender*) pArg)->flush();
+	}
+} // congestionHandler
+
+
+/**
+ * @brief Send the pending reports.
+ * @return True if no report is left pending.
+ */
+bool BLEHIDReportSender::flush() {
+	bool done = true;
+	for (uint8_t i = 0; i < m_reportCount; i++) {
+		hid_report_slot_t& slot = m_reports[i];
+		uint8_t data[HID_REPORT_SENDER_MAX_LENGTH];
+		int64_t inputTime;
+
+		portENTER_CRITICAL(&m_mux);
+		bool pending = slot.pending;
+		if (pending) {
+			memcpy(data, slot.data, slot.length);
+			inputTime    = slot.inputTime;
+			slot.pending = false;
+		}
+		portEXIT_CRITICAL(&m_mux);
+		if (!pending || notify(slot, data, inputTime)) continue;
+
+		// Still busy.  Put the report back unless a newer one arrived in the meantime and it can
+		// not be merged with it.
+		done = false;
+		portENTER_CRITICAL(&m_mux);
+		bool kept = true;
+		if (!slot.pending) {
+			memcpy(slot.data, data, slot.length);
+			slot.pending   = true;
+			slot.inputTime = inputTime;
+		} else if (merge(slot, data)) {
+			slot.inputTime = inputTime;
+		} else {
+			kept = false;
+		}
+		portEXIT_CRITICAL(&m_mux);
+		if (!kept) {
+			ESP_LOGW(LOG_TAG, "Dropped a report of input report %d", i);
+		}
+	}
+	return done;
+} // flush
+
+
+/**
+ * @brief Get the interval of the connection the reports are sent on.
+ * @return The connection interval in units of 1.25ms or 0 if it is not known.
+ */
+uint16_t BLEHIDReportSender::getConnInterval() {
+	return m_pServer->getConnInterval();
+} // getConnInterval
+
+
+/**
+ * @brief Get the input to stack latency of the reports sent so far.
+ * @return The latency statistics.
+ */
+ble_hid_stack_latency_t BLEHIDReportSender::getStackLatency() {
+	portENTER_CRITICAL(&m_mux);
+	ble_hid_stack_latency_t latency = m_stackLatency;
+	portEXIT_CRITICAL(&m_mux);
+	return latency;
+} // getStackLatency
+
+
+/**
+ * @brief Is any report waiting for the link?
+ * @return True if a report is pending.
+ */
+bool BLEHIDReportSender::hasPending() {
+	for (uint8_t i = 0; i < m_reportCount; i++) {
+		if (m_reports[i].pending) return true;
+	}
+	return false;
+} // hasPending
+
+
+/**
+ * @brief Merge a report into the pending report of a slot.
+ *
+ * Reports merge when all their bytes other than the relative ones are equal and summing the relative
+ * bytes does not overflow.  Merging two equal reports without relative bytes drops the repeat.
+ * Called with the lock held.
+ *
+ * @return True if the report was merged, false if the pending report is unchanged.
+ */
+bool BLEHIDReportSender::merge(hid_report_slot_t& slot, const uint8_t* pData) {
+	for (uint8_t i = 0; i < slot.length; i++) {
+		if (slot.relativeMask & (1 << i)) {
+			int sum = (int8_t) slot.data[i] + (int8_t) pData[i];
+			if (sum < -127 || sum > 127) return false;
+		} else if (slot.data[i] != pData[i]) {
+			return false;
+		}
+	}
+	for (uint8_t i = 0; i < slot.length; i++) {
+		if (slot.relativeMask & (1 << i)) {
+			slot.data[i] = (int8_t) slot.data[i] + (int8_t) pData[i];
+		}
+	}
+	return true;
+} // merge
+
+
+/**
+ * @brief Hand a report to the stack as a notification by handle and record its input to stack latency.
+ * @return True if the stack accepted the report.
+ */
+bool BLEHIDReportSender::notify(hid_report_slot_t& slot, const uint8_t* pData, int64_t inputTime) {
+	esp_err_t errRc = ::esp_ble_gatts_send_indicate(m_pServer->getGattsIf(), m_pServer->getConnId(),
+		slot.pCharacteristic->getHandle(), slot.length, (uint8_t*) pData, false);
+	if (errRc != ESP_OK) {
+		ESP_LOGD(LOG_TAG, "esp_ble_gatts_send_indicate: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		return false;
+	}
+
+	uint32_t latency = esp_timer_get_time() - inputTime;
+	portENTER_CRITICAL(&m_mux);
+	m_stackLatency.count++;
+	m_stackLatency.last   = latency;
+	m_stackLatency.total += latency;
+	if (latency < m_stackLatency.min) m_stackLatency.min = latency;
+	if (latency > m_stackLatency.max) m_stackLatency.max = latency;
+	portEXIT_CRITICAL(&m_mux);
+	return true;
+} // notify
+
+
+/**
+ * @brief Clear the input to stack latency statistics.
+ */
+void BLEHIDReportSender::resetStackLatency() {
+	portENTER_CRITICAL(&m_mux);
+	memset(&m_stackLatency, 0, sizeof(m_stackLatency));
+	m_stackLatency.min = UINT32_MAX;
+	portEXIT_CRITICAL(&m_mux);
+} // resetStackLatency
+
+
+/**
+ * @brief Send an input report.
+ *
+ * If the link is free the report is notified straight away.  If it is congested the report becomes
+ * the pending report of its slot, merged into an already pending one where possible.
+ *
+ * @param [in] report The index returned by addReport().
+ * @param [in] pData The report, of the length given to addReport().
+ * @param [in] inputTime The esp_timer time of the input that produced the report, 0 for now.
+ * @return True if the report was sent or queued, false if no host is listening or an earlier report
+ * that it can not be merged with is still pending; the caller should try again later.
+ */
+bool BLEHIDReportSender::send(int report, const uint8_t* pData, int64_t inputTime) {
+	if (report < 0 || report >= m_reportCount) return false;
+	hid_report_slot_t& slot = m_reports[report];
+	if (m_pServer->getConnectedCount() == 0) return false;
+	if (slot.p2902 != nullptr && !slot.p2902->getNotifications()) return false;
+	if (inputTime == 0) inputTime = esp_timer_get_time();
+
+	if (slot.pending && !flush()) {
+		// The link is still busy: fold the report into the pending one if we can.
+		portENTER_CRITICAL(&m_mux);
+		bool merged = slot.pending && merge(slot, pData);
+		if (merged) m_stackLatency.merged++;
+		portEXIT_CRITICAL(&m_mux);
+		if (merged || slot.pending) return merged;
+	}
+
+	if (!m_pServer->isCongested() && notify(slot, pData, inputTime)) return true;
+
+	portENTER_CRITICAL(&m_mux);
+	bool queued = !slot.pending;
+	if (queued) {
+		memcpy(slot.data, pData, slot.length);
+		slot.pending   = true;
+		slot.inputTime = inputTime;
+	} else if (merge(slot, pData)) {     // The congestion handler raced us; merge into its report.
+		m_stackLatency.merged++;
+		queued = true;
+	}
+	portEXIT_CRITICAL(&m_mux);
+	return queued;
+} // send
+
+#endif // CONFIG_BT_ENABLED
@@ -0,0 +1,90 @@
+/*
+ * BLEHIDReportSender.h
+ *
+ *  Low latency sending of HID input reports.
+ */
+
+#ifndef _BLEHIDREPORTSENDER_H_
+#define _BLEHIDREPORTSENDER_H_
+
+#include "sdkconfig.h"
+#if defined(CONFIG_BT_ENABLED)
+
+#include <freertos/FreeRTOS.h>
+#include "BLECharacteristic.h"
+#include "BLE2902.h"
+#include "BLEServer.h"
+
+#define HID_REPORT_SENDER_MAX_REPORTS 4
+#define HID_REPORT_SENDER_MAX_LENGTH  20    // Fits a notification at the default MTU.
+
+/**
+ * @brief Input to stack latency of the reports sent, in microseconds.
+ *
+ * This is the time from the input to the stack accepting the notification.  The time the report then
+ * waits in the stack and the controller for a connection event is not included.
+ */
+typedef struct {
+	uint32_t count;     // Reports handed to the stack.
+	uint32_t merged;    // Reports folded into a pending report instead of being sent on their own.
+	uint32_t last;
+	uint32_t min;
+	uint32_t max;
+	uint64_t total;     // Sum of all latencies; total / count is the mean.
+} ble_hid_stack_latency_t;
+
+
+/**
+ * @brief Send HID input reports with as little work per report as possible.
+ *
+ * Sending a report through BLECharacteristic::setValue() and notify() copies the value several times,
+ * dumps it to the log, copies the peer map and looks up the 0x2902 descriptor on every call.  The
+ * sender instead keeps a preallocated buffer per report, resolves the handle and the 0x2902 descriptor
+ * once and notifies the connected host directly by handle.
+ *
+ * While the link is congested a report is held as pending.  A newer report of the same kind is merged
+ * into it when only its relative bytes (for example mouse X, Y and wheel) differ, so mouse movement is
+ * never lost, only coalesced.  A report that cannot be merged is refused until the pending one has gone
+ * out, which gives the caller flow control.  Pending reports are sent as soon as the congestion clears.
+ *
+ * The input to stack latency, from the input (the time given to send()) to the report being accepted by
+ * the stack, is recorded, see getStackLatency().
+ *
+ * The characteristic's own value is not updated; hosts read input reports through notifications.
+ */
+class BLEHIDReportSender {
+public:
+	BLEHIDReportSender(BLEServer* pServer);
+	~BLEHIDReportSender();
+	int      addReport(BLECharacteristic* pCharacteristic, uint8_t length, uint32_t relativeMask = 0);
+	bool     flush();
+	uint16_t getConnInterval();
+	ble_hid_stack_latency_t getStackLatency();
+	bool     hasPending();
+	void     resetStackLatency();
+	bool     send(int report, const uint8_t* pData, int64_t inputTime = 0);
+
+private:
+	typedef struct {
+		BLECharacteristic* pCharacteristic;
+		BLE2902*           p2902;
+		uint8_t            length;
+		uint32_t           relativeMask;     // Bit n set: byte n is a signed delta that may be summed.
+		bool               pending;
+		int64_t            inputTime;        // Input time of the oldest report merged into the pending one.
+		uint8_t            data[HID_REPORT_SENDER_MAX_LENGTH];
+	} hid_report_slot_t;
+
+	bool        merge(hid_report_slot_t& slot, const uint8_t* pData);
+	bool        notify(hid_report_slot_t& slot, const uint8_t* pData, int64_t inputTime);
+	static void congestionHandler(uint16_t connId, bool congested, void* pArg);
+
+	BLEServer*              m_pServer;
+	hid_report_slot_t       m_reports[HID_REPORT_SENDER_MAX_REPORTS];
+	uint8_t                 m_reportCount;
+	ble_hid_stack_latency_t m_stackLatency;
+	portMUX_TYPE            m_mux = portMUX_INITIALIZER_UNLOCKED;
+}; // BLEHIDReportSender
+
+#endif // CONFIG_BT_ENABLED
+#endif /* _BLEHIDREPORTSENDER_H_ */
@@ -0,0 +1,187 @@
+/*
+ * BLEHIDTypist.cpp
+ *
+ *  Typing text through a BLE HID keyboard.
+ */
+#include "sdkconfig.h"
+#if defined(CONFIG_BT_ENABLED)
+#include <string.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "BLEHIDTypist.h"
+#include "HIDKeyboardTypes.h"
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_ARDUHAL_ESP_LOG)
+#include "esp32-hal-log.h"
+#define LOG_TAG ""
+#else
+#include "esp_log.h"
+static const char* LOG_TAG = "BLEHIDTypist";
+#endif
+
+
+/**
+ * @brief Construct a typist.
+ * @param [in] pSender The sender of the keyboard's input reports.
+ * @param [in] report The index of the 8 byte keyboard input report in the sender.
+ */
+BLEHIDTypist::BLEHIDTypist(BLEHIDReportSender* pSender, int report) {
+	m_pSender        = pSender;
+	m_report         = report;
+	m_rollover       = HID_KEYBOARD_ROLLOVER;
+	m_pacingMs       = HID_TYPIST_PACING_CONN_INTERVAL;
+	m_timeoutMs      = 1000;
+	m_lastReportTime = 0;
+	m_reportCount    = 0;
+	m_charsPerSecond = 0;
+} // BLEHIDTypist
+
+
+/**
+ * @brief Get the throughput of the last call to type().
+ * @return Characters per second.
+ */
+float BLEHIDTypist::getCharsPerSecond() {
+	return m_charsPerSecond;
+} // getCharsPerSecond
+
+
+/**
+ * @brief Get the number of reports sent by the last call to type().
+ * @return The number of reports.
+ */
+uint32_t BLEHIDTypist::getReportCount() {
+	return m_reportCount;
+} // getReportCount
+
+
+/**
+ * @brief Send a keyboard report, waiting while the sender refuses it.
+ * @return True if the report was sent or queued, false if it was refused for longer than the timeout.
+ */
+bool BLEHIDTypist::sendReport(uint8_t modifiers, const uint8_t* pKeys, uint8_t count) {
+	uint8_t report[HID_KEYBOARD_REPORT_LENGTH] = { modifiers, 0 };
+	if (count > 0) memcpy(report + 2, pKeys, count);
+
+	int64_t pacing = m_pacingMs == HID_TYPIST_PACING_CONN_INTERVAL
+		? m_pSender->getConnInterval() * 1250      // Units of 1.25ms; 0 while the interval is not known.
+		: (int64_t) m_pacingMs * 1000;
+	if (pacing > 0) {
+		int64_t wait = m_lastReportTime + pacing - esp_timer_get_time();
+		if (wait > 0) vTaskDelay(wait / 1000 / portTICK_PERIOD_MS + 1);
+	}
+
+	int64_t start = esp_timer_get_time();
+	while (!m_pSender->send(m_report, report)) {
+		if (esp_timer_get_time() - start > (int64_t) m_timeoutMs * 1000) {
+			ESP_LOGE(LOG_TAG, "Keyboard report refused for %d ms", m_timeoutMs);
+			return false;
+		}
+		vTaskDelay(1);      // Let the stack drain the pending report.
+	}
+	m_lastReportTime = esp_timer_get_time();
+	m_reportCount++;
+	return true;
+} // sendReport
+
+
+/**
+ * @brief Set a minimum interval between reports.
+ * @param [in] intervalMs The interval in milliseconds, 0 to send as fast as the flow control allows or
+ * HID_TYPIST_PACING_CONN_INTERVAL (the default) for the current connection interval.
+ */
+void BLEHIDTypist::setPacing(uint32_t intervalMs) {
+	m_pacingMs = intervalMs;
+} // setPacing
+
+
+/**
+ * @brief Set how many keys may be pressed together in one report.
+ * @param [in] keys From 1 (one key per report) to 6 (the default).
+ */
+void BLEHIDTypist::setRollover(uint8_t keys) {
+	m_rollover = keys < 1 ? 1 : (keys > HID_KEYBOARD_ROLLOVER ? HID_KEYBOARD_ROLLOVER : keys);
+} // setRollover
+
+
+/**
+ * @brief Set how long a refused report is retried before typing is abandoned.
+ * @param [in] timeoutMs The timeout in milliseconds.  The default is 1000.
+ */
+void BLEHIDTypist::setTimeout(uint32_t timeoutMs) {
+	m_timeoutMs = timeoutMs;
+} // setTimeout
+
+
+/**
+ * @brief Type a string.
+ *
+ * Characters without a key in the keymap are skipped.  Blocks until the last report has been handed to
+ * the sender.
+ *
+ * @param [in] text The NUL terminated text.
+ * @return The number of characters typed.
+ */
+size_t BLEHIDTypist::type(const char* text) {
+	int64_t  start    = esp_timer_get_time();
+	size_t   typed    = 0;
+	uint8_t  keys[HID_KEYBOARD_ROLLOVER];
+	uint8_t  count    = 0;       // Keys in the group being built.
+	uint8_t  modifiers = 0;      // Modifiers of the group being built.
+	uint8_t  held[HID_KEYBOARD_ROLLOVER];
+	uint8_t  heldCount = 0;      // Keys held down by the last report sent.
+	uint8_t  heldModifiers = 0;
+	m_reportCount = 0;
+
+	for (const uint8_t* p = (const uint8_t*) text; ; p++) {
+		uint8_t usage    = 0;
+		uint8_t modifier = 0;
+		if (*p != 0) {
+			if (*p >= KEYMAP_SIZE || keymap[*p].usage == 0) {
+				ESP_LOGW(LOG_TAG, "No key for character 0x%02x", *p);
+				continue;
+			}
+			usage    = keymap[*p].usage;
+			modifier = keymap[*p].modifier;
+
+			bool repeated = memchr(keys, usage, count) != nullptr;
+			if (count == 0 || (count < m_rollover && modifier == modifiers && !repeated)) {
+				keys[count++] = usage;
+				modifiers     = modifier;
+				continue;
+			}
+		}
+
+		// Send the group.  Release first if it would not register as new presses on its own.
+		if (count > 0) {
+			bool overlap = false;
+			for (uint8_t i = 0; i < count && !overlap; i++) {
+				overlap = memchr(held, keys[i], heldCount) != nullptr;
+			}
+			if ((overlap || modifiers != heldModifiers) && heldCount > 0) {
+				if (!sendReport(0, nullptr, 0)) break;
+			}
+			if (!sendReport(modifiers, keys, count)) break;
+			typed += count;
+			memcpy(held, keys, count);
+			heldCount     = count;
+			heldModifiers = modifiers;
+		}
+		if (*p == 0) break;
+
+		keys[0]   = usage;          // Start the next group with the character that did not fit.
+		count     = 1;
+		modifiers = modifier;
+	}
+	if (heldCount > 0) {
+		sendReport(0, nullptr, 0);     // Release everything.
+	}
+
+	int64_t elapsed  = esp_timer_get_time() - start;
+	m_charsPerSecond = elapsed > 0 ? typed * 1000000.0 / elapsed : 0;
+	ESP_LOGD(LOG_TAG, "Typed %d characters in %d reports, %.1f chars/sec", typed, m_reportCount, m_charsPerSecond);
+	return typed;
+} // type
+
+#endif // CONFIG_BT_ENABLED
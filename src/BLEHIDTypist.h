@@ -0,0 +1,63 @@
+/*
+ * BLEHIDTypist.h
+ *
+ *  Typing text through a BLE HID keyboard.
+ */
+
+#ifndef _BLEHIDTYPIST_H_
+#define _BLEHIDTYPIST_H_
+
+#include "sdkconfig.h"
+#if defined(CONFIG_BT_ENABLED)
+
+#include "BLEHIDReportSender.h"
+
+#define HID_KEYBOARD_REPORT_LENGTH 8     // Modifiers, reserved, 6 key usages.
+#define HID_KEYBOARD_ROLLOVER      6
+#define HID_TYPIST_PACING_CONN_INTERVAL UINT32_MAX   // setPacing(): follow the connection interval.
+
+
+/**
+ * @brief Type text with as few keyboard reports as possible.
+ *
+ * Characters are mapped to key usages and modifiers through the keymap table of HIDKeyboardTypes.h
+ * (US or UK layout, selected by US_KEYBOARD).  Instead of a press and a release report per character,
+ * consecutive characters that need the same modifiers and distinct keys are pressed together in one
+ * report, up to the 6 keys of the boot keyboard report.  Hosts process the newly pressed keys of a report
+ * in array order, so "abc" becomes one report pressing a, b and c followed, only when needed, by a
+ * release.  A release report is inserted only where the next group changes the modifiers or presses a key
+ * that is still held.  setRollover(1) restores one key per report for hosts that do not keep the order.
+ *
+ * Reports go through a BLEHIDReportSender, which notifies by handle and refuses a report while the link
+ * is congested and an earlier one is still pending.  The typist then waits and retries, so characters are
+ * never dropped under congestion, and keeps a minimum interval between reports: by default the connection
+ * interval, as a host takes at most one report per connection event.
+ *
+ * The characters per second of the last type() call are recorded as a benchmark, see getCharsPerSecond().
+ */
+class BLEHIDTypist {
+public:
+	BLEHIDTypist(BLEHIDReportSender* pSender, int report);
+	float    getCharsPerSecond();
+	uint32_t getReportCount();
+	void     setPacing(uint32_t intervalMs);
+	void     setRollover(uint8_t keys);
+	void     setTimeout(uint32_t timeoutMs);
+	size_t   type(const char* text);
+
+private:
+	bool sendReport(uint8_t modifiers, const uint8_t* pKeys, uint8_t count);
+
+	BLEHIDReportSender* m_pSender;
+	int                 m_report;
+	uint8_t             m_rollover;
+	uint32_t            m_pacingMs;        // Minimum time between reports, 0 for flow control only or
+	                                       // HID_TYPIST_PACING_CONN_INTERVAL.
+	uint32_t            m_timeoutMs;       // How long a refused report is retried.
+	int64_t             m_lastReportTime;
+	uint32_t            m_reportCount;     // Reports sent by the last type().
+	float               m_charsPerSecond;  // Throughput of the last type().
+}; // BLEHIDTypist
+
+#endif // CONFIG_BT_ENABLED
+#endif /* _BLEHIDTYPIST_H_ */
@@ -42,7 +42,7 @@ BLERemoteCharacteristic::BLERemoteCharacteristic(
 		BLERemoteService*    pRemoteService) {
 	ESP_LOGD(LOG_TAG, ">> BLERemoteCharacteristic: handle: %d 0x%d, uuid: %s", handle, handle, uuid.toString().c_str());
 	m_handle         = handle;
-	m_uuid           = uuid;
+	m_uuid           = BLEUUIDTable::intern(uuid);
 	m_charProp       = charProp;
 	m_pRemoteService = pRemoteService;
 	m_notifyCallback = nullptr;
@@ -57,6 +57,7 @@ BLERemoteCharacteristic::BLERemoteCharacteristic(
  */
 BLERemoteCharacteristic::~BLERemoteCharacteristic() {
 	removeDescriptors();   // Release resources for any descriptor information we may have allocated.
+	BLEUUIDTable::release(m_uuid);
 } // ~BLERemoteCharacteristic
 
 
@@ -196,10 +197,35 @@ void BLERemoteCharacteristic::gattClientEventHandler(esp_gattc_cb_event_t event,
 				m_value = "";
 			}
 
-			m_semaphoreReadCharEvt.give();
+			m_semaphoreReadCharEvt.give(evtParam->read.status);
 			break;
 		} // ESP_GATTC_READ_CHAR_EVT
 
+		// ESP_GATTC_READ_DESCR_EVT
+		// This event indicates that the server has responded to the read request of a descriptor.
+		//
+		// read:
+		// - esp_gatt_status_t  status
+		// - uint16_t           conn_id
+		// - uint16_t           handle
+		// - uint8_t*           value
+		// - uint16_t           value_len
+		case ESP_GATTC_READ_DESCR_EVT: {
+			// Find the descriptor of this characteristic, if any, that the read was for.
+			for (auto &myPair : m_descriptorMap) {
+				BLERemoteDescriptor* pDescriptor = myPair.second;
+				if (evtParam->read.handle != pDescriptor->getHandle()) continue;
+				if (evtParam->read.status == ESP_GATT_OK) {
+					pDescriptor->m_value = std::string((char*) evtParam->read.value, evtParam->read.value_len);
+				} else {
+					pDescriptor->m_value = "";
+				}
+				pDescriptor->m_semaphoreReadDescrEvt.give(evtParam->read.status);
+				break;
+			}
+			break;
+		} // ESP_GATTC_READ_DESCR_EVT
+
 		// ESP_GATTC_REG_FOR_NOTIFY_EVT
 		//
 		// reg_for_notify:
@@ -238,7 +264,7 @@ void BLERemoteCharacteristic::gattClientEventHandler(esp_gattc_cb_event_t event,
 
 			// There is nothing further we need to do here.  This is merely an indication
 			// that the write has completed and we can unlock the caller.
-			m_semaphoreWriteCharEvt.give();
+			m_semaphoreWriteCharEvt.give(evtParam->write.status);
 			break;
 		} // ESP_GATTC_WRITE_CHAR_EVT
 
@@ -292,7 +318,7 @@ void BLERemoteCharacteristic::retrieveDescriptors() {
 			this
 		);
 
-		m_descriptorMap.insert(std::pair<std::string, BLERemoteDescriptor*>(pNewRemoteDescriptor->getUUID().toString(), pNewRemoteDescriptor));
+		m_descriptorMap.insert(std::pair<ble_uuid_ref_t, BLERemoteDescriptor*>(pNewRemoteDescriptor->m_uuid, pNewRemoteDescriptor));
 
 		offset++;
 	} // while true
@@ -304,7 +330,7 @@ void BLERemoteCharacteristic::retrieveDescriptors() {
 /**
  * @brief Retrieve the map of descriptors keyed by UUID.
  */
-std::map<std::string, BLERemoteDescriptor*>* BLERemoteCharacteristic::getDescriptors() {
+std::map<ble_uuid_ref_t, BLERemoteDescriptor*>* BLERemoteCharacteristic::getDescriptors() {
 	return &m_descriptorMap;
 } // getDescriptors
 
@@ -327,12 +353,10 @@ uint16_t BLERemoteCharacteristic::getHandle() {
  */
 BLERemoteDescriptor* BLERemoteCharacteristic::getDescriptor(BLEUUID uuid) {
 	ESP_LOGD(LOG_TAG, ">> getDescriptor: uuid: %s", uuid.toString().c_str());
-	std::string v = uuid.toString();
-	for (auto &myPair : m_descriptorMap) {
-		if (myPair.first == v) {
-			ESP_LOGD(LOG_TAG, "<< getDescriptor: found");
-			return myPair.second;
-		}
+	auto it = m_descriptorMap.find(BLEUUIDTable::find(uuid));
+	if (it != m_descriptorMap.end()) {
+		ESP_LOGD(LOG_TAG, "<< getDescriptor: found");
+		return it->second;
 	}
 	ESP_LOGD(LOG_TAG, "<< getDescriptor: Not found");
 	return nullptr;
@@ -353,7 +377,7 @@ BLERemoteService* BLERemoteCharacteristic::getRemoteService() {
  * @return The UUID for this characteristic.
  */
 BLEUUID BLERemoteCharacteristic::getUUID() {
-	return m_uuid;
+	return BLEUUIDTable::get(m_uuid);
 } // getUUID
 
 
@@ -399,14 +423,34 @@ uint8_t BLERemoteCharacteristic::readUInt8() {
 /**
  * @brief Read the value of the remote characteristic.
  * @return The value of the remote characteristic.
+ * @throws BLEDisconnectedException if we are not connected (unless built with BLE_NO_EXCEPTIONS).
  */
 std::string BLERemoteCharacteristic::readValue() {
+	std::string value;
+	esp_err_t errRc = tryReadValue(&value);
+#ifndef BLE_NO_EXCEPTIONS
+	if (errRc == ESP_ERR_INVALID_STATE) {
+		throw BLEDisconnectedException();
+	}
+#endif
+	return value;
+} // readValue
+
+
+/**
+ * @brief Read the value of the remote characteristic without throwing.
+ * @param [out] pValue The value read from the remote characteristic.  Cleared on failure.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if we are not connected, ESP_FAIL if the server
+ * reported an error or the error returned by the ESP-IDF read request.
+ */
+esp_err_t BLERemoteCharacteristic::tryReadValue(std::string* pValue) {
 	ESP_LOGD(LOG_TAG, ">> readValue(): uuid: %s, handle: %d 0x%.2x", getUUID().toString().c_str(), getHandle(), getHandle());
+	pValue->clear();
 
 	// Check to see that we are connected.
 	if (!getRemoteService()->getClient()->isConnected()) {
 		ESP_LOGE(LOG_TAG, "Disconnected");
-		throw BLEDisconnectedException();
+		return ESP_ERR_INVALID_STATE;
 	}
 
 	m_semaphoreReadCharEvt.take("readValue");
@@ -422,16 +466,22 @@ std::string BLERemoteCharacteristic::readValue() {
 
 	if (errRc != ESP_OK) {
 		ESP_LOGE(LOG_TAG, "esp_ble_gattc_read_char: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-		return "";
+		m_semaphoreReadCharEvt.give();
+		return errRc;
 	}
 
 	// Block waiting for the event that indicates that the read has completed.  When it has, the std::string found
 	// in m_value will contain our data.
-	m_semaphoreReadCharEvt.wait("readValue");
+	uint32_t status = m_semaphoreReadCharEvt.wait("readValue");
+	if (status != ESP_GATT_OK) {
+		ESP_LOGE(LOG_TAG, "<< readValue(): %s", BLEUtils::gattStatusToString((esp_gatt_status_t) status).c_str());
+		return ESP_FAIL;
+	}
 
+	*pValue = m_value;
 	ESP_LOGD(LOG_TAG, "<< readValue(): length: %d", m_value.length());
-	return m_value;
-} // readValue
+	return ESP_OK;
+} // tryReadValue
 
 
 /**
@@ -441,14 +491,33 @@ std::string BLERemoteCharacteristic::readValue() {
  * @return N/A.
  */
 void BLERemoteCharacteristic::registerForNotify(notify_callback notifyCallback, bool notifications) {
+	esp_err_t errRc = tryRegisterForNotify(notifyCallback, notifications);
+#ifndef BLE_NO_EXCEPTIONS
+	if (errRc == ESP_ERR_INVALID_STATE) {
+		throw BLEDisconnectedException();
+	}
+#endif
+} // registerForNotify
+
+
+/**
+ * @brief Register for notifications without throwing.
+ * @param [in] notifyCallback A callback to be invoked for a notification.  If NULL is provided then we are
+ * unregistering a notification.
+ * @param [in] notifications True for notifications, false for indications.
+ * @return ESP_OK on success or the first error encountered.
+ */
+esp_err_t BLERemoteCharacteristic::tryRegisterForNotify(notify_callback notifyCallback, bool notifications) {
 	ESP_LOGD(LOG_TAG, ">> registerForNotify(): %s", toString().c_str());
 
 	m_notifyCallback = notifyCallback;   // Save the notification callback.
 
 	m_semaphoreRegForNotifyEvt.take("registerForNotify");
 
+	esp_err_t errRc;
+	uint8_t val[] = {0x00, 0x00};
 	if (notifyCallback != nullptr) {   // If we have a callback function, then this is a registration.
-		esp_err_t errRc = ::esp_ble_gattc_register_for_notify(
+		errRc = ::esp_ble_gattc_register_for_notify(
 			m_pRemoteService->getClient()->getGattcIf(),
 			*m_pRemoteService->getClient()->getPeerAddress().getNative(),
 			getHandle()
@@ -458,13 +527,10 @@ void BLERemoteCharacteristic::registerForNotify(notify_callback notifyCallback,
 			ESP_LOGE(LOG_TAG, "esp_ble_gattc_register_for_notify: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
 		}
 
-		uint8_t val[] = {0x01, 0x00};
-		if(!notifications) val[0] = 0x02;
-		BLERemoteDescriptor* desc = getDescriptor(BLEUUID((uint16_t)0x2902));
-		desc->writeValue(val, 2);
+		val[0] = notifications ? 0x01 : 0x02;
 	} // End Register
 	else {   // If we weren't passed a callback function, then this is an unregistration.
-		esp_err_t errRc = ::esp_ble_gattc_unregister_for_notify(
+		errRc = ::esp_ble_gattc_unregister_for_notify(
 			m_pRemoteService->getClient()->getGattcIf(),
 			*m_pRemoteService->getClient()->getPeerAddress().getNative(),
 			getHandle()
@@ -473,16 +539,25 @@ void BLERemoteCharacteristic::registerForNotify(notify_callback notifyCallback,
 		if (errRc != ESP_OK) {
 			ESP_LOGE(LOG_TAG, "esp_ble_gattc_unregister_for_notify: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
 		}
-
-		uint8_t val[] = {0x00, 0x00};
-		BLERemoteDescriptor* desc = getDescriptor((uint16_t)0x2902);
-		desc->writeValue(val, 2);
 	} // End Unregister
 
+	if (errRc != ESP_OK) {
+		m_semaphoreRegForNotifyEvt.give();
+		return errRc;
+	}
+
+	BLERemoteDescriptor* desc = getDescriptor(BLEUUID((uint16_t)0x2902));
+	if (desc != nullptr) {
+		errRc = desc->tryWriteValue(val, 2);
+	} else {
+		ESP_LOGW(LOG_TAG, "No 0x2902 descriptor; server side notifications not changed");
+	}
+
 	m_semaphoreRegForNotifyEvt.wait("registerForNotify");
 
 	ESP_LOGD(LOG_TAG, "<< registerForNotify()");
-} // registerForNotify
+	return errRc;
+} // tryRegisterForNotify
 
 
 /**
@@ -493,12 +568,11 @@ void BLERemoteCharacteristic::registerForNotify(notify_callback notifyCallback,
  * @return N/A.
  */
 void BLERemoteCharacteristic::removeDescriptors() {
-	// Iterate through all the descriptors releasing their storage and erasing them from the map.
+	// Iterate through all the descriptors releasing their storage, then empty the map.
 	for (auto &myPair : m_descriptorMap) {
-	   m_descriptorMap.erase(myPair.first);
 	   delete myPair.second;
 	}
-	m_descriptorMap.clear();   // Technically not neeeded, but just to be sure.
+	m_descriptorMap.clear();
 } // removeCharacteristics
 
 
@@ -508,7 +582,7 @@ void BLERemoteCharacteristic::removeDescriptors() {
  */
 std::string BLERemoteCharacteristic::toString() {
 	std::ostringstream ss;
-	ss << "Characteristic: uuid: " << m_uuid.toString() <<
+	ss << "Characteristic: uuid: " << getUUID().toString() <<
 		", handle: " << getHandle() << " 0x" << std::hex << getHandle() <<
 		", props: " << BLEUtils::characteristicPropertiesToString(m_charProp);
 	return ss.str();
@@ -544,15 +618,33 @@ void BLERemoteCharacteristic::writeValue(uint8_t newValue, bool response) {
  * @param [in] data A pointer to a data buffer.
  * @param [in] length The length of the data in the data buffer.
  * @param [in] response Whether we require a response from the write.
+ * @throws BLEDisconnectedException if we are not connected (unless built with BLE_NO_EXCEPTIONS).
  */
 void BLERemoteCharacteristic::writeValue(uint8_t* data, size_t length, bool response) {
-	// writeValue(std::string((char*)data, length), response);
+	esp_err_t errRc = tryWriteValue(data, length, response);
+#ifndef BLE_NO_EXCEPTIONS
+	if (errRc == ESP_ERR_INVALID_STATE) {
+		throw BLEDisconnectedException();
+	}
+#endif
+} // writeValue
+
+
+/**
+ * @brief Write the new value for the characteristic from a data buffer without throwing.
+ * @param [in] data A pointer to a data buffer.
+ * @param [in] length The length of the data in the data buffer.
+ * @param [in] response Whether we require a response from the write.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if we are not connected, ESP_FAIL if the server
+ * reported an error or the error returned by the ESP-IDF write request.
+ */
+esp_err_t BLERemoteCharacteristic::tryWriteValue(uint8_t* data, size_t length, bool response) {
 	ESP_LOGD(LOG_TAG, ">> writeValue(), length: %d", length);
 
 	// Check to see that we are connected.
 	if (!getRemoteService()->getClient()->isConnected()) {
 		ESP_LOGE(LOG_TAG, "Disconnected");
-		throw BLEDisconnectedException();
+		return ESP_ERR_INVALID_STATE;
 	}
 
 	m_semaphoreWriteCharEvt.take("writeValue");
@@ -569,13 +661,19 @@ void BLERemoteCharacteristic::writeValue(uint8_t* data, size_t length, bool resp
 
 	if (errRc != ESP_OK) {
 		ESP_LOGE(LOG_TAG, "esp_ble_gattc_write_char: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-		return;
+		m_semaphoreWriteCharEvt.give();
+		return errRc;
 	}
 
-	m_semaphoreWriteCharEvt.wait("writeValue");
+	uint32_t status = m_semaphoreWriteCharEvt.wait("writeValue");
+	if (status != ESP_GATT_OK) {
+		ESP_LOGE(LOG_TAG, "<< writeValue: %s", BLEUtils::gattStatusToString((esp_gatt_status_t) status).c_str());
+		return ESP_FAIL;
+	}
 
 	ESP_LOGD(LOG_TAG, "<< writeValue");
-} // writeValue
+	return ESP_OK;
+} // tryWriteValue
 
 /**
  * @brief Read raw data from remote characteristic as hex bytes
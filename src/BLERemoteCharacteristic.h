@@ -17,6 +17,7 @@
 #include "BLERemoteService.h"
 #include "BLERemoteDescriptor.h"
 #include "BLEUUID.h"
+#include "BLEUUIDTable.h"
 #include "FreeRTOS.h"
 
 class BLERemoteService;
@@ -38,7 +39,7 @@ public:
 	bool        canWrite();
 	bool        canWriteNoResponse();
 	BLERemoteDescriptor* getDescriptor(BLEUUID uuid);
-	std::map<std::string, BLERemoteDescriptor*>* getDescriptors();
+	std::map<ble_uuid_ref_t, BLERemoteDescriptor*>* getDescriptors();   // Keyed by BLEUUIDTable reference.
 	uint16_t    getHandle();
 	BLEUUID     getUUID();
 	std::string readValue();
@@ -52,6 +53,11 @@ public:
 	std::string toString();
 	uint8_t*	readRawData();
 
+	// Status returning variants.  These never throw.
+	esp_err_t   tryReadValue(std::string* pValue);
+	esp_err_t   tryRegisterForNotify(notify_callback _callback, bool notifications = true);
+	esp_err_t   tryWriteValue(uint8_t* data, size_t length, bool response = false);
+
 private:
 	BLERemoteCharacteristic(uint16_t handle, BLEUUID uuid, esp_gatt_char_prop_t charProp, BLERemoteService* pRemoteService);
 	friend class BLEClient;
@@ -66,7 +72,7 @@ private:
 	void              retrieveDescriptors();
 
 	// Private properties
-	BLEUUID              m_uuid;
+	ble_uuid_ref_t       m_uuid;           // In the BLEUUIDTable.
 	esp_gatt_char_prop_t m_charProp;
 	uint16_t             m_handle;
 	BLERemoteService*    m_pRemoteService;
@@ -78,7 +84,7 @@ private:
 	notify_callback		 m_notifyCallback;
 
 	// We maintain a map of descriptors owned by this characteristic keyed by a string representation of the UUID.
-	std::map<std::string, BLERemoteDescriptor*> m_descriptorMap;
+	std::map<ble_uuid_ref_t, BLERemoteDescriptor*> m_descriptorMap;
 }; // BLERemoteCharacteristic
 #endif /* CONFIG_BT_ENABLED */
 #endif /* COMPONENTS_CPP_UTILS_BLEREMOTECHARACTERISTIC_H_ */
@@ -9,6 +9,8 @@
 #include <sstream>
 #include "BLERemoteDescriptor.h"
 #include "GeneralUtils.h"
+#include "BLEUtils.h"
+#include "BLEExceptions.h"
 #if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_ARDUHAL_ESP_LOG)
 #include "esp32-hal-log.h"
 #define LOG_TAG ""
@@ -26,11 +28,16 @@ BLERemoteDescriptor::BLERemoteDescriptor(
 	BLERemoteCharacteristic* pRemoteCharacteristic) {
 
 	m_handle                = handle;
-	m_uuid                  = uuid;
+	m_uuid                  = BLEUUIDTable::intern(uuid);
 	m_pRemoteCharacteristic = pRemoteCharacteristic;
 }
 
 
+BLERemoteDescriptor::~BLERemoteDescriptor() {
+	BLEUUIDTable::release(m_uuid);
+} // ~BLERemoteDescriptor
+
+
 /**
  * @brief Retrieve the handle associated with this remote descriptor.
  * @return The handle associated with this remote descriptor.
@@ -54,17 +61,41 @@ BLERemoteCharacteristic* BLERemoteDescriptor::getRemoteCharacteristic() {
  * @return The UUID associated this remote descriptor.
  */
 BLEUUID BLERemoteDescriptor::getUUID() {
-	return m_uuid;
+	return BLEUUIDTable::get(m_uuid);
 } // getUUID
 
 
+/**
+ * @brief Read the value of the remote descriptor.
+ * @return The value of the remote descriptor.
+ * @throws BLEDisconnectedException if we are not connected (unless built with BLE_NO_EXCEPTIONS).
+ */
 std::string BLERemoteDescriptor::readValue() {
+	std::string value;
+	esp_err_t errRc = tryReadValue(&value);
+#ifndef BLE_NO_EXCEPTIONS
+	if (errRc == ESP_ERR_INVALID_STATE) {
+		throw BLEDisconnectedException();
+	}
+#endif
+	return value;
+} // readValue
+
+
+/**
+ * @brief Read the value of the remote descriptor without throwing.
+ * @param [out] pValue The value read from the remote descriptor.  Cleared on failure.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if we are not connected, ESP_FAIL if the server
+ * reported an error or the error returned by the ESP-IDF read request.
+ */
+esp_err_t BLERemoteDescriptor::tryReadValue(std::string* pValue) {
 	ESP_LOGD(LOG_TAG, ">> readValue: %s", toString().c_str());
+	pValue->clear();
 
 	// Check to see that we are connected.
 	if (!getRemoteCharacteristic()->getRemoteService()->getClient()->isConnected()) {
 		ESP_LOGE(LOG_TAG, "Disconnected");
-		throw BLEDisconnectedException();
+		return ESP_ERR_INVALID_STATE;
 	}
 
 	m_semaphoreReadDescrEvt.take("readValue");
@@ -77,17 +108,23 @@ std::string BLERemoteDescriptor::readValue() {
 		ESP_GATT_AUTH_REQ_NONE);                       // Security
 
 	if (errRc != ESP_OK) {
-		ESP_LOGE(LOG_TAG, "esp_ble_gattc_read_char: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-		return "";
+		ESP_LOGE(LOG_TAG, "esp_ble_gattc_read_char_descr: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		m_semaphoreReadDescrEvt.give();
+		return errRc;
 	}
 
 	// Block waiting for the event that indicates that the read has completed.  When it has, the std::string found
-	// in m_value will contain our data.
-	m_semaphoreReadDescrEvt.wait("readValue");
+	// in m_value will contain our data.  The owning characteristic gives the semaphore with the GATT status.
+	uint32_t status = m_semaphoreReadDescrEvt.wait("readValue");
+	if (status != ESP_GATT_OK) {
+		ESP_LOGE(LOG_TAG, "<< readValue(): %s", BLEUtils::gattStatusToString((esp_gatt_status_t) status).c_str());
+		return ESP_FAIL;
+	}
 
+	*pValue = m_value;
 	ESP_LOGD(LOG_TAG, "<< readValue(): length: %d", m_value.length());
-	return m_value;
-} // readValue
+	return ESP_OK;
+} // tryReadValue
 
 
 uint8_t BLERemoteDescriptor::readUInt8() {
@@ -133,13 +170,32 @@ std::string BLERemoteDescriptor::toString() {
  * @param [in] data The data to send to the remote descriptor.
  * @param [in] length The length of the data to send.
  * @param [in] response True if we expect a response.
+ * @throws BLEDisconnectedException if we are not connected (unless built with BLE_NO_EXCEPTIONS).
  */
 void BLERemoteDescriptor::writeValue(uint8_t* data, size_t length, bool response) {
+	esp_err_t errRc = tryWriteValue(data, length, response);
+#ifndef BLE_NO_EXCEPTIONS
+	if (errRc == ESP_ERR_INVALID_STATE) {
+		throw BLEDisconnectedException();
+	}
+#endif
+} // writeValue
+
+
+/**
+ * @brief Write data to the BLE Remote Descriptor without throwing.
+ * @param [in] data The data to send to the remote descriptor.
+ * @param [in] length The length of the data to send.
+ * @param [in] response True if we expect a response.
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if we are not connected or the error returned by
+ * the ESP-IDF write request.
+ */
+esp_err_t BLERemoteDescriptor::tryWriteValue(uint8_t* data, size_t length, bool response) {
 	ESP_LOGD(LOG_TAG, ">> writeValue: %s", toString().c_str());
 	// Check to see that we are connected.
 	if (!getRemoteCharacteristic()->getRemoteService()->getClient()->isConnected()) {
 		ESP_LOGE(LOG_TAG, "Disconnected");
-		throw BLEDisconnectedException();
+		return ESP_ERR_INVALID_STATE;
 	}
 
 	esp_err_t errRc = ::esp_ble_gattc_write_char_descr(
@@ -155,7 +211,8 @@ void BLERemoteDescriptor::writeValue(uint8_t* data, size_t length, bool response
 		ESP_LOGE(LOG_TAG, "esp_ble_gattc_write_char_descr: %d", errRc);
 	}
 	ESP_LOGD(LOG_TAG, "<< writeValue");
-} // writeValue
+	return errRc;
+} // tryWriteValue
 
 
 /**
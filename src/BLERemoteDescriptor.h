@@ -15,6 +15,7 @@
 
 #include "BLERemoteCharacteristic.h"
 #include "BLEUUID.h"
+#include "BLEUUIDTable.h"
 #include "FreeRTOS.h"
 
 class BLERemoteCharacteristic;
@@ -23,6 +24,7 @@ class BLERemoteCharacteristic;
  */
 class BLERemoteDescriptor {
 public:
+	~BLERemoteDescriptor();
 	uint16_t    getHandle();
 	BLERemoteCharacteristic* getRemoteCharacteristic();
 	BLEUUID     getUUID();
@@ -35,6 +37,9 @@ public:
 	void        writeValue(std::string newValue, bool response = false);
 	void        writeValue(uint8_t newValue, bool response = false);
 
+	// Status returning variants.  These never throw.
+	esp_err_t   tryReadValue(std::string* pValue);
+	esp_err_t   tryWriteValue(uint8_t* data, size_t length, bool response = false);
 
 private:
 	friend class BLERemoteCharacteristic;
@@ -44,7 +49,7 @@ private:
 		BLERemoteCharacteristic* pRemoteCharacteristic
 	);
 	uint16_t                 m_handle;                  // Server handle of this descriptor.
-	BLEUUID                  m_uuid;                    // UUID of this descriptor.
+	ble_uuid_ref_t           m_uuid;                    // UUID of this descriptor, in the BLEUUIDTable.
 	std::string              m_value;                   // Last received value of the descriptor.
 	BLERemoteCharacteristic* m_pRemoteCharacteristic;   // Reference to the Remote characteristic of which this descriptor is associated.
 	FreeRTOS::Semaphore      m_semaphoreReadDescrEvt      = FreeRTOS::Semaphore("ReadDescrEvt");
@@ -32,7 +32,7 @@ BLERemoteService::BLERemoteService(
 	ESP_LOGD(LOG_TAG, ">> BLERemoteService()");
 	m_srvcId  = srvcId;
 	m_pClient = pClient;
-	m_uuid    = BLEUUID(m_srvcId);
+	m_uuid    = BLEUUIDTable::intern(BLEUUID(m_srvcId));
 	m_haveCharacteristics = false;
 	m_startHandle = startHandle;
 	m_endHandle = endHandle;
@@ -43,6 +43,7 @@ BLERemoteService::BLERemoteService(
 
 BLERemoteService::~BLERemoteService() {
 	removeCharacteristics();
+	BLEUUIDTable::release(m_uuid);
 }
 
 /*
@@ -148,11 +149,9 @@ BLERemoteCharacteristic* BLERemoteService::getCharacteristic(BLEUUID uuid) {
 	if (!m_haveCharacteristics) {
 		retrieveCharacteristics();
 	}
-	std::string v = uuid.toString();
-	for (auto &myPair : m_characteristicMap) {
-		if (myPair.first == v) {
-			return myPair.second;
-		}
+	auto it = m_characteristicMap.find(BLEUUIDTable::find(uuid));
+	if (it != m_characteristicMap.end()) {
+		return it->second;
 	}
 	// throw new BLEUuidNotFoundException();  // <-- we dont want exception here, which will cause app crash, we want to search if any characteristic can be found one after another
 	return nullptr;
@@ -206,7 +205,7 @@ void BLERemoteService::retrieveCharacteristics() {
 			this
 		);
 
-		m_characteristicMap.insert(std::pair<std::string, BLERemoteCharacteristic*>(pNewRemoteCharacteristic->getUUID().toString(), pNewRemoteCharacteristic));
+		m_characteristicMap.insert(std::pair<ble_uuid_ref_t, BLERemoteCharacteristic*>(pNewRemoteCharacteristic->m_uuid, pNewRemoteCharacteristic));
 		m_characteristicMapByHandle.insert(std::pair<uint16_t, BLERemoteCharacteristic*>(result.char_handle, pNewRemoteCharacteristic));
 		offset++;   // Increment our count of number of descriptors found.
 	} // Loop forever (until we break inside the loop).
@@ -220,7 +219,7 @@ void BLERemoteService::retrieveCharacteristics() {
  * @brief Retrieve a map of all the characteristics of this service.
  * @return A map of all the characteristics of this service.
  */
-std::map<std::string, BLERemoteCharacteristic*>* BLERemoteService::getCharacteristics() {
+std::map<ble_uuid_ref_t, BLERemoteCharacteristic*>* BLERemoteService::getCharacteristics() {
 	ESP_LOGD(LOG_TAG, ">> getCharacteristics() for service: %s", getUUID().toString().c_str());
 	// If is possible that we have not read the characteristics associated with the service so do that
 	// now.  The request to retrieve the characteristics by calling "retrieveCharacteristics" is a blocking
@@ -272,7 +271,7 @@ uint16_t BLERemoteService::getHandle() {
 
 
 BLEUUID BLERemoteService::getUUID() {
-	return m_uuid;
+	return BLEUUIDTable::get(m_uuid);
 }
 
 /**
@@ -295,11 +294,7 @@ std::string BLERemoteService::getValue(BLEUUID characteristicUuid) {
  * @return N/A.
  */
 void BLERemoteService::removeCharacteristics() {
-	for (auto &myPair : m_characteristicMap) {
-	   delete myPair.second;
-	   //m_characteristicMap.erase(myPair.first);  // Should be no need to delete as it will be deleted by the clear
-	}
-	m_characteristicMap.clear();   // Clear the map
+	m_characteristicMap.clear();   // Clear the map; every characteristic is also in the map by handle.
 	for (auto &myPair : m_characteristicMapByHandle) {
 	   delete myPair.second;
 	}
@@ -307,6 +302,39 @@ void BLERemoteService::removeCharacteristics() {
 } // removeCharacteristics
 
 
+/**
+ * @brief Get the value of a characteristic without throwing.
+ * @param [in] characteristicUuid The characteristic to read.
+ * @param [out] pValue The value that was read.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no such characteristic or the read status.
+ */
+esp_err_t BLERemoteService::tryGetValue(BLEUUID characteristicUuid, std::string* pValue) {
+	BLERemoteCharacteristic* pCharacteristic = getCharacteristic(characteristicUuid);
+	if (pCharacteristic == nullptr) {
+		ESP_LOGE(LOG_TAG, "tryGetValue: no characteristic %s", characteristicUuid.toString().c_str());
+		pValue->clear();
+		return ESP_ERR_NOT_FOUND;
+	}
+	return pCharacteristic->tryReadValue(pValue);
+} // tryGetValue
+
+
+/**
+ * @brief Set the value of a characteristic without throwing.
+ * @param [in] characteristicUuid The characteristic to set.
+ * @param [in] value The value to set.
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no such characteristic or the write status.
+ */
+esp_err_t BLERemoteService::trySetValue(BLEUUID characteristicUuid, std::string value) {
+	BLERemoteCharacteristic* pCharacteristic = getCharacteristic(characteristicUuid);
+	if (pCharacteristic == nullptr) {
+		ESP_LOGE(LOG_TAG, "trySetValue: no characteristic %s", characteristicUuid.toString().c_str());
+		return ESP_ERR_NOT_FOUND;
+	}
+	return pCharacteristic->tryWriteValue((uint8_t*) value.data(), value.length());
+} // trySetValue
+
+
 /**
  * @brief Set the value of a characteristic.
  * @param [in] characteristicUuid The characteristic to set.
@@ -326,7 +354,7 @@ void BLERemoteService::setValue(BLEUUID characteristicUuid, std::string value) {
  */
 std::string BLERemoteService::toString() {
 	std::ostringstream ss;
-	ss << "Service: uuid: " + m_uuid.toString();
+	ss << "Service: uuid: " + getUUID().toString();
 	ss << ", start_handle: " << std::dec << m_startHandle << " 0x" << std::hex << m_startHandle <<
 			", end_handle: " << std::dec << m_endHandle << " 0x" << std::hex << m_endHandle;
 	for (auto &myPair : m_characteristicMap) {
@@ -15,6 +15,7 @@
 #include "BLEClient.h"
 #include "BLERemoteCharacteristic.h"
 #include "BLEUUID.h"
+#include "BLEUUIDTable.h"
 #include "FreeRTOS.h"
 
 class BLEClient;
@@ -32,7 +33,7 @@ public:
 	BLERemoteCharacteristic* getCharacteristic(const char* uuid);	  // Get the specified characteristic reference.
 	BLERemoteCharacteristic* getCharacteristic(BLEUUID uuid);       // Get the specified characteristic reference.
 	BLERemoteCharacteristic* getCharacteristic(uint16_t uuid);      // Get the specified characteristic reference.
-	std::map<std::string, BLERemoteCharacteristic*>* getCharacteristics();
+	std::map<ble_uuid_ref_t, BLERemoteCharacteristic*>* getCharacteristics();   // Keyed by BLEUUIDTable reference.
 	std::map<uint16_t, BLERemoteCharacteristic*>* getCharacteristicsByHandle();  // Get the characteristics map.
 	void getCharacteristics(std::map<uint16_t, BLERemoteCharacteristic*>* pCharacteristicMap);
 
@@ -41,6 +42,8 @@ public:
 	BLEUUID                  getUUID(void);                                             // Get the UUID of this service.
 	std::string              getValue(BLEUUID characteristicUuid);                      // Get the value of a characteristic.
 	void                     setValue(BLEUUID characteristicUuid, std::string value);   // Set the value of a characteristic.
+	esp_err_t                tryGetValue(BLEUUID characteristicUuid, std::string* pValue);  // Get the value of a characteristic, never throws.
+	esp_err_t                trySetValue(BLEUUID characteristicUuid, std::string value);    // Set the value of a characteristic, never throws.
 	std::string              toString(void);
 
 private:
@@ -66,8 +69,8 @@ private:
 
 	// Properties
 
-	// We maintain a map of characteristics owned by this service keyed by a string representation of the UUID.
-	std::map<std::string, BLERemoteCharacteristic*> m_characteristicMap;
+	// We maintain a map of characteristics owned by this service keyed by the table reference of the UUID.
+	std::map<ble_uuid_ref_t, BLERemoteCharacteristic*> m_characteristicMap;
 
 	// We maintain a map of characteristics owned by this service keyed by a handle.
 	std::map<uint16_t, BLERemoteCharacteristic*> m_characteristicMapByHandle;
@@ -76,7 +79,7 @@ private:
 	BLEClient*          m_pClient;
 	FreeRTOS::Semaphore m_semaphoreGetCharEvt = FreeRTOS::Semaphore("GetCharEvt");
 	esp_gatt_id_t       m_srvcId;
-	BLEUUID             m_uuid;             // The UUID of this service.
+	ble_uuid_ref_t      m_uuid;             // The UUID of this service, in the BLEUUIDTable.
 	uint16_t            m_startHandle;      // The starting handle of this service.
 	uint16_t            m_endHandle;        // The ending handle of this service.
 }; // BLERemoteService
@@ -27,6 +27,28 @@ static const char* LOG_TAG = "BLEScan";
 
 
 
+/**
+ * @brief Find the manufacturer specific data in a raw advert.
+ * @param [in] payload The advert and scan response data.
+ * @param [in] length The length of the data.
+ * @param [out] pLength Receives the length of the manufacturer data.
+ * @return A pointer to the manufacturer data (starting with the company identifier) or nullptr if there is none.
+ */
+static const uint8_t* findManufacturerData(const uint8_t* payload, size_t length, size_t* pLength) {
+	size_t i = 0;
+	while (i + 1 < length && payload[i] != 0) {
+		size_t fieldLength = payload[i];
+		if (i + 1 + fieldLength > length) break;
+		if (payload[i + 1] == ESP_BLE_AD_MANUFACTURER_SPECIFIC_TYPE) {
+			*pLength = fieldLength - 1;
+			return payload + i + 2;
+		}
+		i += 1 + fieldLength;
+	}
+	return nullptr;
+} // findManufacturerData
+
+
 /**
  * Constructor
  */
@@ -96,9 +118,27 @@ void BLEScan::handleGAPEvent(
 // Examine our list of previously scanned addresses and, if we found this one already,
 // ignore it.
 					BLEAddress advertisedAddress(param->scan_rst.bda);
+
+					// Beacon ranging and the manufacturer handlers see every advert, including those from
+					// devices we have already reported.
+					if (m_pBeaconRanging != nullptr || m_manufacturerHandlerCount > 0) {
+						size_t length;
+						const uint8_t* pData = findManufacturerData(param->scan_rst.ble_adv, param->scan_rst.adv_data_len + param->scan_rst.scan_rsp_len, &length);
+						if (pData != nullptr) {
+							if (m_pBeaconRanging != nullptr) m_pBeaconRanging->update(pData, length, param->scan_rst.rssi);
+							if (length >= 2) {
+								int index = findManufacturerHandler(pData[0] | (pData[1] << 8));
+								if (index >= 0) {
+									manufacturer_handler_t& entry = m_manufacturerHandlers[index];
+									entry.handler(advertisedAddress, pData, length, param->scan_rst.rssi, entry.pArg);
+								}
+							}
+						}
+					}
+
 					bool found = false;
 
-					if (m_scanResults.m_vectorAdvertisedDevices.count(advertisedAddress.toString()) != 0) {
+					if (m_scanResults.m_vectorAdvertisedDevices.count(advertisedAddress) != 0) {
 						found = true;
 					}
 
@@ -121,7 +161,7 @@ void BLEScan::handleGAPEvent(
 					advertisedDevice->setAddressType(param->scan_rst.ble_addr_type);
 
 					if (!found) {   // If we have previously seen this device, don't record it again.
-						m_scanResults.m_vectorAdvertisedDevices.insert(std::pair<std::string, BLEAdvertisedDevice*>(advertisedAddress.toString(), advertisedDevice));
+						m_scanResults.m_vectorAdvertisedDevices.insert(std::pair<BLEAddress, BLEAdvertisedDevice*>(advertisedAddress, advertisedDevice));
 					}
 
 					if (m_pAdvertisedDeviceCallbacks) {
@@ -149,6 +189,75 @@ void BLEScan::handleGAPEvent(
 } // gapEventHandler
 
 
+/**
+ * @brief Find the handler registered for a company.
+ * @param [in] companyId The company identifier.
+ * @return The index of the handler in the table or -1 if there is none.
+ */
+int BLEScan::findManufacturerHandler(uint16_t companyId) {
+	int low  = 0;
+	int high = m_manufacturerHandlerCount - 1;
+	while (low <= high) {
+		int middle = (low + high) / 2;
+		uint16_t id = m_manufacturerHandlers[middle].companyId;
+		if (id == companyId) return middle;
+		if (id < companyId) {
+			low = middle + 1;
+		} else {
+			high = middle - 1;
+		}
+	}
+	return -1;
+} // findManufacturerHandler
+
+
+/**
+ * @brief Get the name given when the handler of a company was registered.
+ * @param [in] companyId The company identifier.
+ * @return The name or nullptr if no handler with a name is registered for the company.
+ */
+const char* BLEScan::getManufacturerName(uint16_t companyId) {
+	int index = findManufacturerHandler(companyId);
+	return index < 0 ? nullptr : m_manufacturerHandlers[index].name;
+} // getManufacturerName
+
+
+/**
+ * @brief Route the manufacturer data of a company to a handler.
+ *
+ * Each advert that carries manufacturer data is routed with a single lookup, by the company identifier in
+ * its first two bytes, to the registered handler.  The handler receives a pointer into the received advert;
+ * nothing is copied.  Handlers see every advert, duplicates included, and run on the Bluetooth task so
+ * they should return quickly.  Handlers should be registered while not scanning.
+ *
+ * @param [in] companyId The company identifier, e.g. 0x004C for Apple or 0x0499 for Ruuvi.
+ * @param [in] handler The handler.  Replaces any handler already registered for the company.
+ * @param [in] pArg An argument passed to the handler.
+ * @param [in] name An optional name of the company returned by getManufacturerName(); not copied.
+ * @return True on success, false if the table is full.
+ */
+bool BLEScan::registerManufacturerHandler(uint16_t companyId, ble_manufacturer_data_handler_t handler, void* pArg, const char* name) {
+	int index = findManufacturerHandler(companyId);
+	if (index < 0) {
+		if (m_manufacturerHandlerCount >= BLE_SCAN_MAX_MANUFACTURER_HANDLERS) {
+			ESP_LOGE(LOG_TAG, "Unable to register a handler for company 0x%04x, the table is full", companyId);
+			return false;
+		}
+		index = m_manufacturerHandlerCount;
+		while (index > 0 && m_manufacturerHandlers[index - 1].companyId > companyId) {   // Keep the table sorted.
+			m_manufacturerHandlers[index] = m_manufacturerHandlers[index - 1];
+			index--;
+		}
+		m_manufacturerHandlerCount++;
+	}
+	m_manufacturerHandlers[index].companyId = companyId;
+	m_manufacturerHandlers[index].handler   = handler;
+	m_manufacturerHandlers[index].pArg      = pArg;
+	m_manufacturerHandlers[index].name      = name;
+	return true;
+} // registerManufacturerHandler
+
+
 /**
  * @brief Should we perform an active or passive scan?
  * The default is a passive scan.  An active scan means that we will wish a scan response.
@@ -164,6 +273,18 @@ void BLEScan::setActiveScan(bool active) {
 } // setActiveScan
 
 
+/**
+ * @brief Feed every advert received while scanning to a beacon distance estimator.
+ *
+ * The estimator sees duplicate adverts even when the callbacks do not want them.
+ *
+ * @param [in] pBeaconRanging The estimator or nullptr to stop feeding it.
+ */
+void BLEScan::setBeaconRanging(BLEBeaconRanging* pBeaconRanging) {
+	m_pBeaconRanging = pBeaconRanging;
+} // setBeaconRanging
+
+
 /**
  * @brief Set the call backs to be invoked.
  * @param [in] pAdvertisedDeviceCallbacks Call backs to be invoked.
@@ -175,6 +296,20 @@ void BLEScan::setAdvertisedDeviceCallbacks(BLEAdvertisedDeviceCallbacks* pAdvert
 } // setAdvertisedDeviceCallbacks
 
 
+/**
+ * @brief Stop routing the manufacturer data of a company.
+ * @param [in] companyId The company identifier.
+ */
+void BLEScan::unregisterManufacturerHandler(uint16_t companyId) {
+	int index = findManufacturerHandler(companyId);
+	if (index < 0) return;
+	m_manufacturerHandlerCount--;
+	for (int i = index; i < m_manufacturerHandlerCount; i++) {
+		m_manufacturerHandlers[i] = m_manufacturerHandlers[i + 1];
+	}
+} // unregisterManufacturerHandler
+
+
 /**
  * @brief Set the interval to scan.
  * @param [in] The interval in msecs.
@@ -274,9 +409,10 @@ void BLEScan::stop() {
 // delete peer device from cache after disconnecting, it is required in case we are connecting to devices with not public address
 void BLEScan::erase(BLEAddress address) {
 	ESP_LOGI(LOG_TAG, "erase device: %s", address.toString().c_str());
-	BLEAdvertisedDevice *advertisedDevice = m_scanResults.m_vectorAdvertisedDevices.find(address.toString())->second;
-	m_scanResults.m_vectorAdvertisedDevices.erase(address.toString());
-	delete advertisedDevice;
+	auto it = m_scanResults.m_vectorAdvertisedDevices.find(address);
+	if (it == m_scanResults.m_vectorAdvertisedDevices.end()) return;
+	delete it->second;
+	m_scanResults.m_vectorAdvertisedDevices.erase(it);
 }
 
 
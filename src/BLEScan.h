@@ -14,6 +14,7 @@
 // #include <vector>
 #include <string>
 #include "BLEAdvertisedDevice.h"
+#include "BLEBeaconRanging.h"
 #include "BLEClient.h"
 #include "FreeRTOS.h"
 
@@ -22,6 +23,19 @@ class BLEAdvertisedDeviceCallbacks;
 class BLEClient;
 class BLEScan;
 
+#define BLE_SCAN_MAX_MANUFACTURER_HANDLERS 8
+
+/**
+ * @brief Handler of the manufacturer data of one company.
+ * @param [in] address The address of the advertiser.
+ * @param [in] pData The manufacturer data in the received advert, starting with the company identifier.
+ * Only valid for the duration of the call.
+ * @param [in] length The length of the manufacturer data.
+ * @param [in] rssi The RSSI of the advert.
+ * @param [in] pArg The argument given when the handler was registered.
+ */
+typedef void (*ble_manufacturer_data_handler_t)(BLEAddress& address, const uint8_t* pData, size_t length, int rssi, void* pArg);
+
 
 /**
  * @brief The result of having performed a scan.
@@ -38,7 +52,7 @@ public:
 
 private:
 	friend BLEScan;
-	std::map<std::string, BLEAdvertisedDevice*> m_vectorAdvertisedDevices;
+	std::map<BLEAddress, BLEAdvertisedDevice*> m_vectorAdvertisedDevices;   // Ordered as the address strings.
 };
 
 /**
@@ -48,7 +62,12 @@ private:
  */
 class BLEScan {
 public:
+	bool           registerManufacturerHandler(uint16_t companyId, ble_manufacturer_data_handler_t handler,
+	                                           void* pArg = nullptr, const char* name = nullptr);
+	void           unregisterManufacturerHandler(uint16_t companyId);
+	const char*    getManufacturerName(uint16_t companyId);
 	void           setActiveScan(bool active);
+	void           setBeaconRanging(BLEBeaconRanging* pBeaconRanging);
 	void           setAdvertisedDeviceCallbacks(
 			              BLEAdvertisedDeviceCallbacks* pAdvertisedDeviceCallbacks,
 										bool wantDuplicates = false);
@@ -68,6 +87,14 @@ private:
 		esp_gap_ble_cb_event_t  event,
 		esp_ble_gap_cb_param_t* param);
 	void parseAdvertisement(BLEClient* pRemoteDevice, uint8_t *payload);
+	int  findManufacturerHandler(uint16_t companyId);
+
+	typedef struct {
+		uint16_t                        companyId;
+		ble_manufacturer_data_handler_t handler;
+		void*                           pArg;
+		const char*                     name;
+	} manufacturer_handler_t;
 
 
 	esp_ble_scan_params_t         m_scan_params;
@@ -76,6 +103,9 @@ private:
 	FreeRTOS::Semaphore           m_semaphoreScanEnd = FreeRTOS::Semaphore("ScanEnd");
 	BLEScanResults                m_scanResults;
 	bool                          m_wantDuplicates;
+	BLEBeaconRanging*             m_pBeaconRanging = nullptr;
+	manufacturer_handler_t        m_manufacturerHandlers[BLE_SCAN_MAX_MANUFACTURER_HANDLERS];   // Sorted by company id.
+	uint8_t                       m_manufacturerHandlerCount = 0;
 	void                        (*m_scanCompleteCB)(BLEScanResults scanResults);
 }; // BLEScan
 
@@ -126,6 +126,35 @@ uint16_t BLEServer::getConnId() {
 }
 
 
+/**
+ * @brief Get the interval of the latest connection, as connected or last updated.
+ * @return The connection interval in units of 1.25ms or 0 if it is not known.
+ */
+uint16_t BLEServer::getConnInterval() {
+	return m_connInterval;
+} // getConnInterval
+
+
+/**
+ * @brief Has the stack reported the link as congested?
+ * @return True while notifications can not be queued.
+ */
+bool BLEServer::isCongested() {
+	return m_congested;
+} // isCongested
+
+
+/**
+ * @brief Set the handler called when the congestion of a connection changes.
+ * @param [in] handler The handler or nullptr to remove it.
+ * @param [in] pArg An argument passed to the handler.
+ */
+void BLEServer::setCongestionHandler(ble_congestion_handler_t handler, void* pArg) {
+	m_pCongestionHandler = handler;
+	m_pCongestionArg     = pArg;
+} // setCongestionHandler
+
+
 /**
  * @brief Return the number of connected clients.
  * @return The number of connected clients.
@@ -135,6 +164,75 @@ uint32_t BLEServer::getConnectedCount() {
 } // getConnectedCount
 
 
+/**
+ * @brief Measure the memory used by the services, characteristics and descriptors of this server.
+ * Sizes are the sizeof() of each object plus the heap it owns (lists, value storage and semaphore
+ * kernel objects).  Heap allocator headers are not included.
+ * @return The footprint of the attribute database.
+ */
+ble_footprint_t BLEServer::getFootprint() {
+	ble_footprint_t footprint;
+	memset(&footprint, 0, sizeof(footprint));
+
+	BLEService* pService = m_serviceMap.getFirst();
+	while (pService != nullptr) {
+		footprint.services++;
+		footprint.serviceBytes += pService->getFootprint();
+		BLECharacteristic* pCharacteristic = pService->m_characteristicMap.getFirst();
+		while (pCharacteristic != nullptr) {
+			footprint.characteristics++;
+			footprint.characteristicBytes += pCharacteristic->getFootprint();
+			BLEDescriptor* pDescriptor = pCharacteristic->m_descriptorMap.getFirst();
+			while (pDescriptor != nullptr) {
+				footprint.descriptors++;
+				footprint.descriptorBytes += pDescriptor->getFootprint();
+				pDescriptor = pCharacteristic->m_descriptorMap.getNext();
+			}
+			pCharacteristic = pService->m_characteristicMap.getNext();
+		}
+		pService = m_serviceMap.getNext();
+	}
+
+	// Value slots are already counted by their characteristics; add only the unassigned part of the arena.
+	footprint.arenaReservedBytes = BLEValueArena::getReservedBytes();
+	footprint.totalBytes = footprint.serviceBytes + footprint.characteristicBytes + footprint.descriptorBytes +
+		(footprint.arenaReservedBytes - BLEValueArena::getUsedBytes());
+	size_t attributes = footprint.services + footprint.characteristics + footprint.descriptors;
+	footprint.bytesPerAttribute = attributes == 0 ? 0 : footprint.totalBytes / attributes;
+	return footprint;
+} // getFootprint
+
+
+/**
+ * @brief Log the memory used by each service, characteristic and descriptor of this server.
+ */
+void BLEServer::dumpFootprint() {
+	BLEService* pService = m_serviceMap.getFirst();
+	while (pService != nullptr) {
+		ESP_LOGI(LOG_TAG, "service %s: %d bytes", pService->getUUID().toString().c_str(), pService->getFootprint());
+		BLECharacteristic* pCharacteristic = pService->m_characteristicMap.getFirst();
+		while (pCharacteristic != nullptr) {
+			ESP_LOGI(LOG_TAG, "  characteristic %s: %d bytes", pCharacteristic->getUUID().toString().c_str(), pCharacteristic->getFootprint());
+			BLEDescriptor* pDescriptor = pCharacteristic->m_descriptorMap.getFirst();
+			while (pDescriptor != nullptr) {
+				ESP_LOGI(LOG_TAG, "    descriptor %s: %d bytes", pDescriptor->getUUID().toString().c_str(), pDescriptor->getFootprint());
+				pDescriptor = pCharacteristic->m_descriptorMap.getNext();
+			}
+			pCharacteristic = pService->m_characteristicMap.getNext();
+		}
+		pService = m_serviceMap.getNext();
+	}
+
+	ble_footprint_t footprint = getFootprint();
+	ESP_LOGI(LOG_TAG, "services: %d (%d bytes), characteristics: %d (%d bytes), descriptors: %d (%d bytes)",
+		footprint.services, footprint.serviceBytes,
+		footprint.characteristics, footprint.characteristicBytes,
+		footprint.descriptors, footprint.descriptorBytes);
+	ESP_LOGI(LOG_TAG, "value arena: %d bytes, total: %d bytes, %d bytes per attribute",
+		footprint.arenaReservedBytes, footprint.totalBytes, footprint.bytesPerAttribute);
+} // dumpFootprint
+
+
 uint16_t BLEServer::getGattsIf() {
 	return m_gatts_if;
 }
@@ -168,13 +266,47 @@ void BLEServer::handleGATTServerEvent(esp_gatts_cb_event_t event, esp_gatt_if_t
 			updatePeerMTU(param->mtu.conn_id, param->mtu.mtu);
 			break;
 
+		// ESP_GATTS_CONF_EVT
+		//
+		// conf:
+		// - esp_gatt_status_t status  – The status code.
+		// - uint16_t          conn_id – The connection used.
+		//
+		// Only one indication is outstanding at a time so a single semaphore serves every characteristic.
+		case ESP_GATTS_CONF_EVT: {
+			if (param->conf.conn_id == m_connId) { // && param->conf.handle == m_handle) // bug in esp-idf and not implemented in arduino yet
+				m_semaphoreConfEvt.give(param->conf.status);
+			}
+			break;
+		} // ESP_GATTS_CONF_EVT
+
+		// ESP_GATTS_CONGEST_EVT
+		//
+		// congest:
+		// - uint16_t conn_id
+		// - bool     congested
+		//
+		case ESP_GATTS_CONGEST_EVT: {
+			m_congested = param->congest.congested;
+			if (m_pCongestionHandler != nullptr) {
+				m_pCongestionHandler(param->congest.conn_id, param->congest.congested, m_pCongestionArg);
+			}
+			break;
+		} // ESP_GATTS_CONGEST_EVT
+
 		// ESP_GATTS_CONNECT_EVT
 		// connect:
 		// - uint16_t      conn_id
 		// - esp_bd_addr_t remote_bda
+		// - esp_gatt_conn_params_t conn_params (ESP-IDF 4.0 and later)
 		//
 		case ESP_GATTS_CONNECT_EVT: {
 			m_connId = param->connect.conn_id;
+#if defined(ESP_IDF_VERSION)
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 0, 0)
+			m_connInterval = param->connect.conn_params.interval;
+#endif
+#endif
 			addPeerDevice((void*)this, false, m_connId);
 			if (m_pServerCallbacks != nullptr) {
 				m_pServerCallbacks->onConnect(this);
@@ -201,6 +333,20 @@ void BLEServer::handleGATTServerEvent(esp_gatts_cb_event_t event, esp_gatt_if_t
 		} // ESP_GATTS_CREATE_EVT
 
 
+		// ESP_GATTS_CREAT_ATTR_TAB_EVT
+		// Called when a service has been registered from its attribute table (see resume()).
+		//
+		case ESP_GATTS_CREAT_ATTR_TAB_EVT: {
+			if (param->add_attr_tab.status == ESP_GATT_OK && param->add_attr_tab.num_handle > 0) {
+				BLEService* pService = m_serviceMap.getByUUID(param->add_attr_tab.svc_uuid, param->add_attr_tab.svc_inst_id);
+				if (pService != nullptr) {
+					m_serviceMap.setByHandle(param->add_attr_tab.handles[0], pService);
+				}
+			}
+			break;
+		} // ESP_GATTS_CREAT_ATTR_TAB_EVT
+
+
 		// ESP_GATTS_DISCONNECT_EVT
 		//
 		// disconnect
@@ -212,11 +358,13 @@ void BLEServer::handleGATTServerEvent(esp_gatts_cb_event_t event, esp_gatt_if_t
 		// we also want to start advertising again.
 		case ESP_GATTS_DISCONNECT_EVT: {
 			m_connectedCount--;                          // Decrement the number of connected devices count.
+			m_congested = false;
 			if (m_pServerCallbacks != nullptr) {         // If we have callbacks, call now.
 				m_pServerCallbacks->onDisconnect(this);
 			}
 			startAdvertising(); //- do this with some delay from the loop()
 			removePeerDevice(param->disconnect.conn_id, false);
+			m_semaphoreConfEvt.give();                   // Release any indication waiting for a confirm.
 			break;
 		} // ESP_GATTS_DISCONNECT_EVT
 
@@ -295,6 +443,50 @@ void BLEServer::registerApp(uint16_t m_appId) {
 } // registerApp
 
 
+/**
+ * @brief Prepare for the BLE stack being suspended.
+ * The attribute table of every service is precomputed and all handles and connections are forgotten.
+ * The service, characteristic and descriptor objects themselves are kept.
+ */
+void BLEServer::prepareSuspend() {
+	BLEService* pService = m_serviceMap.getFirst();
+	while (pService != nullptr) {
+		pService->buildAttrTable();
+		pService->resetHandles();
+		pService = m_serviceMap.getNext();
+	}
+	m_serviceMap.clearHandles();
+	m_connectedServersMap.clear();
+	m_connectedCount = 0;
+	m_connId         = ESP_GATT_IF_NONE;
+	m_gatts_if       = ESP_GATT_IF_NONE;
+} // prepareSuspend
+
+
+/**
+ * @brief Register the server again after the BLE stack has been resumed.
+ * Each service is registered with a single attribute table request and services that were running are started.
+ * @return True if every service was registered.
+ */
+bool BLEServer::resume() {
+	ESP_LOGD(LOG_TAG, ">> resume");
+	registerApp(m_appId);
+
+	bool rc = true;
+	BLEService* pService = m_serviceMap.getFirst();
+	while (pService != nullptr) {
+		if (!pService->executeCreateTable(this)) {
+			rc = false;
+		} else if (pService->m_started && !pService->executeStart()) {
+			rc = false;
+		}
+		pService = m_serviceMap.getNext();
+	}
+	ESP_LOGD(LOG_TAG, "<< resume: %s", rc ? "ok" : "failed");
+	return rc;
+} // resume
+
+
 /**
  * @brief Set the server callbacks.
  *
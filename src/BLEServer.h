@@ -13,6 +13,7 @@
 
 #include <string>
 #include <string.h>
+#include <map>
 // #include "BLEDevice.h"
 
 #include "BLEUUID.h"
@@ -31,6 +32,21 @@ typedef struct {
 	uint16_t mtu;			// every peer device negotiate own mtu
 } conn_status_t;
 
+/**
+ * @brief Memory used by the attributes of a server, see BLEServer::getFootprint().
+ */
+typedef struct {
+	uint16_t services;              // Number of services.
+	uint16_t characteristics;       // Number of characteristics.
+	uint16_t descriptors;           // Number of descriptors.
+	size_t   serviceBytes;          // Bytes used by all services.
+	size_t   characteristicBytes;   // Bytes used by all characteristics, including their values.
+	size_t   descriptorBytes;       // Bytes used by all descriptors, including their values.
+	size_t   arenaReservedBytes;    // Heap held by the shared value arena.
+	size_t   totalBytes;            // Sum of the above (value slots are counted once).
+	size_t   bytesPerAttribute;     // totalBytes divided by the number of attributes.
+} ble_footprint_t;
+
 
 /**
  * @brief A data structure that manages the %BLE servers owned by a BLE server.
@@ -49,6 +65,7 @@ public:
 	BLEService* getNext();
 	void 		removeService(BLEService *service);
 	int 		getRegisteredServiceCount();
+	void        clearHandles();
 
 private:
 	std::map<uint16_t, BLEService*>    m_handleMap;
@@ -57,6 +74,15 @@ private:
 };
 
 
+/**
+ * @brief Handler of a change in the congestion of a connection.
+ * @param [in] connId The connection.
+ * @param [in] congested True while the stack has no room for more notifications.
+ * @param [in] pArg The argument given when the handler was set.
+ */
+typedef void (*ble_congestion_handler_t)(uint16_t connId, bool congested, void* pArg);
+
+
 /**
  * @brief The model of a %BLE server.
  */
@@ -83,6 +109,12 @@ public:
 	void updatePeerMTU(uint16_t connId, uint16_t mtu);
 	uint16_t getPeerMTU(uint16_t conn_id);
 	uint16_t        getConnId();
+	uint16_t        getConnInterval();
+	bool            isCongested();
+	void            setCongestionHandler(ble_congestion_handler_t handler, void* pArg);
+
+	ble_footprint_t getFootprint();
+	void            dumpFootprint();
 
 
 private:
@@ -90,6 +122,7 @@ private:
 	friend class BLEService;
 	friend class BLECharacteristic;
 	friend class BLEDevice;
+	friend class BLEHIDReportSender;
 	esp_ble_adv_data_t  m_adv_data;
 	// BLEAdvertising      m_bleAdvertising;
 	uint16_t			m_connId;
@@ -100,13 +133,20 @@ private:
 	FreeRTOS::Semaphore m_semaphoreRegisterAppEvt 	= FreeRTOS::Semaphore("RegisterAppEvt");
 	FreeRTOS::Semaphore m_semaphoreCreateEvt 		= FreeRTOS::Semaphore("CreateEvt");
 	FreeRTOS::Semaphore m_semaphoreOpenEvt   		= FreeRTOS::Semaphore("OpenEvt");
+	FreeRTOS::Semaphore m_semaphoreConfEvt   		= FreeRTOS::Semaphore("ConfEvt");
 	BLEServiceMap       m_serviceMap;
 	BLEServerCallbacks* m_pServerCallbacks = nullptr;
+	bool                m_congested = false;
+	uint16_t            m_connInterval = 0;   // Connection interval in units of 1.25ms, 0 if not known.
+	ble_congestion_handler_t m_pCongestionHandler = nullptr;
+	void*               m_pCongestionArg = nullptr;
 
 	void            createApp(uint16_t appId);
 	uint16_t        getGattsIf();
 	void            handleGATTServerEvent(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param);
 	void            registerApp(uint16_t);
+	void            prepareSuspend();
+	bool            resume();
 }; // BLEServer
 
 
@@ -154,17 +154,192 @@ void BLEService::start() {
 	}
 	// Start each of the characteristics ... these are found in the m_characteristicMap.
 
+	executeStart();
+	ESP_LOGD(LOG_TAG, "<< start()");
+} // start
+
+
+/**
+ * @brief Ask the BLE runtime to start the service and wait for it to be started.
+ * @return True if the service was started.
+ */
+bool BLEService::executeStart() {
 	m_semaphoreStartEvt.take("start");
 	esp_err_t errRc = ::esp_ble_gatts_start_service(m_handle);
 
 	if (errRc != ESP_OK) {
 		ESP_LOGE(LOG_TAG, "<< esp_ble_gatts_start_service: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
-		return;
+		m_semaphoreStartEvt.give();
+		return false;
 	}
 	m_semaphoreStartEvt.wait("start");
+	m_started = true;
+	return true;
+} // executeStart
 
-	ESP_LOGD(LOG_TAG, "<< start()");
-} // start
+
+/**
+ * @brief Append an attribute to the precomputed registration table.
+ * 32 bit UUIDs are not accepted in attribute tables so they are stored as their 128 bit form.
+ * @param [in] pUUID The UUID of the attribute.  It must outlive the table.
+ * @param [in] perm The attribute permissions.
+ * @param [in] maxLength The maximum length of the attribute value.
+ * @param [in] length The current length of the attribute value.
+ * @param [in] pValue The attribute value.
+ * @param [in] autoRsp ESP_GATT_AUTO_RSP or ESP_GATT_RSP_BY_APP.
+ */
+void BLEService::addAttr(BLEUUID* pUUID, uint16_t perm, uint16_t maxLength, uint16_t length, uint8_t* pValue, uint8_t autoRsp) {
+	if (pUUID->getNative()->len == ESP_UUID_LEN_32) {
+		m_attrUUIDs.push_back(*pUUID);
+		m_attrUUIDs.back().to128();
+		pUUID = &m_attrUUIDs.back();
+	}
+	esp_gatts_attr_db_t attr;
+	attr.attr_control.auto_rsp = autoRsp;
+	attr.att_desc.uuid_length  = pUUID->getNative()->len;
+	attr.att_desc.uuid_p       = (uint8_t*) &pUUID->getNative()->uuid;
+	attr.att_desc.perm         = perm;
+	attr.att_desc.max_length   = maxLength;
+	attr.att_desc.length       = length;
+	attr.att_desc.value        = pValue;
+	m_attrTable.push_back(attr);
+} // addAttr
+
+
+/**
+ * @brief Precompute the attribute table describing this service, its characteristics and their descriptors.
+ * The table references the UUIDs and descriptor values held by the attribute objects themselves.
+ */
+void BLEService::buildAttrTable() {
+	// Size every vector up front so that the pointers held in the table stay valid.
+	size_t attrCount  = 1;
+	size_t charCount  = 0;
+	size_t uuid32Count = m_uuid.getNative()->len == ESP_UUID_LEN_32 ? 1 : 0;
+	BLECharacteristic* pCharacteristic = m_characteristicMap.getFirst();
+	while (pCharacteristic != nullptr) {
+		charCount++;
+		attrCount += 2 + pCharacteristic->m_descriptorMap.getCount();
+		if (pCharacteristic->m_bleUUID.getNative()->len == ESP_UUID_LEN_32) uuid32Count++;
+		BLEDescriptor* pDescriptor = pCharacteristic->m_descriptorMap.getFirst();
+		while (pDescriptor != nullptr) {
+			if (pDescriptor->m_bleUUID.getNative()->len == ESP_UUID_LEN_32) uuid32Count++;
+			pDescriptor = pCharacteristic->m_descriptorMap.getNext();
+		}
+		pCharacteristic = m_characteristicMap.getNext();
+	}
+
+	m_attrTable.clear();
+	m_attrUUIDs.clear();
+	m_attrProperties.clear();
+	m_attrTable.reserve(attrCount);
+	m_attrUUIDs.reserve(uuid32Count);
+	m_attrProperties.reserve(charCount);
+
+	static BLEUUID primaryService((uint16_t) ESP_GATT_UUID_PRI_SERVICE);
+	static BLEUUID characteristicDeclare((uint16_t) ESP_GATT_UUID_CHAR_DECLARE);
+
+	// The service declaration is the 0x2800 attribute whose value is the service UUID.
+	BLEUUID* pServiceUUID = &m_uuid;
+	if (m_uuid.getNative()->len == ESP_UUID_LEN_32) {
+		m_attrUUIDs.push_back(m_uuid);
+		m_attrUUIDs.back().to128();
+		pServiceUUID = &m_attrUUIDs.back();
+	}
+	uint16_t serviceUUIDLength = pServiceUUID->getNative()->len;
+	addAttr(&primaryService, ESP_GATT_PERM_READ, serviceUUIDLength, serviceUUIDLength,
+		(uint8_t*) &pServiceUUID->getNative()->uuid, ESP_GATT_AUTO_RSP);
+
+	pCharacteristic = m_characteristicMap.getFirst();
+	while (pCharacteristic != nullptr) {
+		m_attrProperties.push_back(pCharacteristic->getProperties());
+		addAttr(&characteristicDeclare, ESP_GATT_PERM_READ, 1, 1, &m_attrProperties.back(), ESP_GATT_AUTO_RSP);
+		// Values are served by BLECharacteristic::handleGATTServerEvent so the stack holds no copy.
+		addAttr(&pCharacteristic->m_bleUUID, pCharacteristic->m_permissions, ESP_GATT_MAX_ATTR_LEN, 0, nullptr, ESP_GATT_RSP_BY_APP);
+
+		BLEDescriptor* pDescriptor = pCharacteristic->m_descriptorMap.getFirst();
+		while (pDescriptor != nullptr) {
+			addAttr(&pDescriptor->m_bleUUID, pDescriptor->m_permissions, pDescriptor->m_value.attr_max_len,
+				pDescriptor->m_value.attr_len, pDescriptor->m_value.attr_value, ESP_GATT_AUTO_RSP);
+			pDescriptor = pCharacteristic->m_descriptorMap.getNext();
+		}
+		pCharacteristic = m_characteristicMap.getNext();
+	}
+	ESP_LOGD(LOG_TAG, "buildAttrTable: %s, %d attributes", m_uuid.toString().c_str(), m_attrTable.size());
+} // buildAttrTable
+
+
+/**
+ * @brief Register the service and all of its attributes with a single request.
+ * The table must have been built by buildAttrTable().  On success every attribute object has its new handle.
+ * @param [in] pServer The server that owns the service.
+ * @return True if the service was created.
+ */
+bool BLEService::executeCreateTable(BLEServer* pServer) {
+	ESP_LOGD(LOG_TAG, ">> executeCreateTable() - %s", getUUID().toString().c_str());
+	m_pServer = pServer;
+	if (m_attrTable.empty() || m_attrTable.size() > ESP_GATT_ATTR_HANDLE_MAX) {   // The most Bluedroid creates at once.
+		ESP_LOGE(LOG_TAG, "<< executeCreateTable: no usable attribute table (%d entries, at most %d)", m_attrTable.size(), ESP_GATT_ATTR_HANDLE_MAX);
+		return false;
+	}
+
+	m_semaphoreCreateEvt.take("executeCreateTable");
+	esp_err_t errRc = ::esp_ble_gatts_create_attr_tab(m_attrTable.data(), pServer->getGattsIf(), m_attrTable.size(), m_instId);
+	if (errRc != ESP_OK) {
+		ESP_LOGE(LOG_TAG, "<< esp_ble_gatts_create_attr_tab: rc=%d %s", errRc, GeneralUtils::errorToString(errRc));
+		m_semaphoreCreateEvt.give();
+		return false;
+	}
+	uint32_t status = m_semaphoreCreateEvt.wait("executeCreateTable");
+	if (status != ESP_GATT_OK || m_handle == NULL_HANDLE) {
+		ESP_LOGE(LOG_TAG, "<< executeCreateTable: %s", BLEUtils::gattStatusToString((esp_gatt_status_t) status).c_str());
+		return false;
+	}
+	ESP_LOGD(LOG_TAG, "<< executeCreateTable");
+	return true;
+} // executeCreateTable
+
+
+/**
+ * @brief Forget the handles of the service and all of its attributes.
+ * Called when the BLE stack is suspended; the handles are assigned again when the service is re-registered.
+ */
+void BLEService::resetHandles() {
+	m_handle = NULL_HANDLE;
+	m_lastCreatedCharacteristic = nullptr;
+	BLECharacteristic* pCharacteristic = m_characteristicMap.getFirst();
+	while (pCharacteristic != nullptr) {
+		pCharacteristic->m_handle = NULL_HANDLE;
+		BLEDescriptor* pDescriptor = pCharacteristic->m_descriptorMap.getFirst();
+		while (pDescriptor != nullptr) {
+			pDescriptor->m_handle = NULL_HANDLE;
+			pDescriptor = pCharacteristic->m_descriptorMap.getNext();
+		}
+		pCharacteristic = m_characteristicMap.getNext();
+	}
+} // resetHandles
+
+
+/**
+ * @brief Assign the handles reported for the attribute table, in table order.
+ * @param [in] handles The handles, one per entry of m_attrTable.
+ */
+void BLEService::setAttrHandles(uint16_t* handles) {
+	size_t index = 0;
+	m_handle = handles[index++];
+	BLECharacteristic* pCharacteristic = m_characteristicMap.getFirst();
+	while (pCharacteristic != nullptr) {
+		index++;   // Characteristic declaration.
+		pCharacteristic->m_handle = handles[index++];
+		pCharacteristic->m_pService = this;
+		BLEDescriptor* pDescriptor = pCharacteristic->m_descriptorMap.getFirst();
+		while (pDescriptor != nullptr) {
+			pDescriptor->m_handle = handles[index++];
+			pDescriptor->m_pCharacteristic = pCharacteristic;
+			pDescriptor = pCharacteristic->m_descriptorMap.getNext();
+		}
+		pCharacteristic = m_characteristicMap.getNext();
+	}
+} // setAttrHandles
 
 
 /**
@@ -188,6 +363,7 @@ void BLEService::stop() {
 		return;
 	}
 	m_semaphoreStopEvt.wait("stop");
+	m_started = false;
 
 	ESP_LOGD(LOG_TAG, "<< stop()");
 } // start
@@ -208,6 +384,19 @@ void BLEService::setHandle(uint16_t handle) {
 } // setHandle
 
 
+/**
+ * @brief Get the memory used by this service.
+ * This counts the object, its characteristic list and the kernel objects of its semaphores.  The
+ * characteristics are reported separately by BLECharacteristic::getFootprint().
+ * @return The number of bytes used.
+ */
+size_t BLEService::getFootprint() {
+	return sizeof(BLEService) + m_characteristicMap.getFootprint() +
+		m_semaphoreCreateEvt.getFootprint() + m_semaphoreDeleteEvt.getFootprint() +
+		m_semaphoreStartEvt.getFootprint() + m_semaphoreStopEvt.getFootprint();
+} // getFootprint
+
+
 /**
  * @brief Get the handle associated with this service.
  * @return The handle associated with this service.
@@ -347,6 +536,33 @@ void BLEService::handleGATTServerEvent(esp_gatts_cb_event_t event, esp_gatt_if_t
 		} // ESP_GATTS_CREATE_EVT
 
 
+		// ESP_GATTS_CREAT_ATTR_TAB_EVT
+		// Called when a service has been registered from an attribute table.
+		//
+		// add_attr_tab:
+		// * esp_gatt_status_t status
+		// * esp_bt_uuid_t     svc_uuid
+		// * uint8_t           svc_inst_id
+		// * uint16_t          num_handle
+		// * uint16_t*         handles
+		//
+		case ESP_GATTS_CREAT_ATTR_TAB_EVT: {
+			if (m_handle == NULL_HANDLE && !m_attrTable.empty() &&
+					getUUID().equals(BLEUUID(param->add_attr_tab.svc_uuid)) && m_instId == param->add_attr_tab.svc_inst_id) {
+				esp_gatt_status_t status = param->add_attr_tab.status;
+				if (status == ESP_GATT_OK && param->add_attr_tab.num_handle != m_attrTable.size()) {
+					ESP_LOGE(LOG_TAG, "Expected %d handles, got %d", m_attrTable.size(), param->add_attr_tab.num_handle);
+					status = ESP_GATT_ERROR;
+				}
+				if (status == ESP_GATT_OK) {
+					setAttrHandles(param->add_attr_tab.handles);
+				}
+				m_semaphoreCreateEvt.give(status);
+			}
+			break;
+		} // ESP_GATTS_CREAT_ATTR_TAB_EVT
+
+
 		// ESP_GATTS_DELETE_EVT
 		// Called when a service is deleted.
 		//
@@ -11,6 +11,7 @@
 #if defined(CONFIG_BT_ENABLED)
 
 #include <esp_gatts_api.h>
+#include <vector>
 
 #include "BLECharacteristic.h"
 #include "BLEServer.h"
@@ -32,13 +33,15 @@ public:
 	BLECharacteristic* getByHandle(uint16_t handle);
 	BLECharacteristic* getFirst();
 	BLECharacteristic* getNext();
+	size_t getCount();
+	size_t getFootprint();
 	std::string toString();
 	void handleGATTServerEvent(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t* param);
 
 private:
-	std::map<BLECharacteristic*, std::string> m_uuidMap;
-	std::map<uint16_t, BLECharacteristic*> m_handleMap;
-	std::map<BLECharacteristic*, std::string>::iterator m_iterator;
+	// Characteristics in the order they were added.  Lookups scan the list, see BLEDescriptorMap.
+	std::vector<BLECharacteristic*> m_characteristics;
+	size_t                          m_iterator = 0;
 };
 
 
@@ -62,6 +65,7 @@ public:
 	void			   stop();
 	std::string        toString();
 	uint16_t           getHandle();
+	size_t             getFootprint();
 	uint8_t			   m_instId = 0;
 
 private:
@@ -85,7 +89,20 @@ private:
 	FreeRTOS::Semaphore  m_semaphoreStopEvt   = FreeRTOS::Semaphore("StopEvt");
 
 	uint16_t             m_numHandles;
+	bool                 m_started = false;
 
+	// Registration data precomputed by buildAttrTable() so that the whole service can be registered
+	// again with a single esp_ble_gatts_create_attr_tab() call, see BLEDevice::resume().
+	std::vector<esp_gatts_attr_db_t> m_attrTable;
+	std::vector<BLEUUID>             m_attrUUIDs;        // 128 bit copies of 32 bit UUIDs referenced by m_attrTable.
+	std::vector<uint8_t>             m_attrProperties;   // Characteristic declaration values.
+
+	void addAttr(BLEUUID* pUUID, uint16_t perm, uint16_t maxLength, uint16_t length, uint8_t* pValue, uint8_t autoRsp);
+	void buildAttrTable();
+	bool executeCreateTable(BLEServer* pServer);
+	bool executeStart();
+	void resetHandles();
+	void setAttrHandles(uint16_t* handles);
 	BLECharacteristic* getLastCreatedCharacteristic();
 	void handleGATTServerEvent(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t* param);
 	void               setHandle(uint16_t handle);
@@ -64,10 +64,20 @@ void BLEServiceMap::setByUUID(BLEUUID uuid, BLEService* service) {
  * @return N/A.
  */
 void BLEServiceMap::setByHandle(uint16_t handle, BLEService* service) {
-	m_handleMap.insert(std::pair<uint16_t, BLEService*>(handle, service));
+	m_handleMap[handle] = service;
 } // setByHandle
 
 
+/**
+ * @brief Forget the handles of all services.
+ * The services stay known by UUID and are mapped again when they are re-registered.
+ * @return N/A.
+ */
+void BLEServiceMap::clearHandles() {
+	m_handleMap.clear();
+} // clearHandles
+
+
 /**
  * @brief Return a string representation of the service map.
  * @return A string representation of the service map.
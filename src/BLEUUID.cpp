@@ -7,8 +7,6 @@
 #include "sdkconfig.h"
 #if defined(CONFIG_BT_ENABLED)
 #include <string.h>
-#include <sstream>
-#include <iomanip>
 #include <stdio.h>
 #include <assert.h>
 #include <stdlib.h>
@@ -23,6 +21,10 @@ static const char* LOG_TAG = "BLEUUID";
 #endif
 
 
+static const uint8_t baseUUID[12] = { 0xfb, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00 };
+static const char     hexDigits[]  = "0123456789abcdef";
+
+
 /**
  * @brief Copy memory from source to target but in reverse order.
  *
@@ -150,14 +152,13 @@ BLEUUID::BLEUUID(uint8_t* pData, size_t size, bool msbFirst) {
 
 
 /**
- * @brief Create a UUID from the 16bit value.
+ * @brief Create a UUID from a string.
+ *
+ * Preferred over the BLEStaticUUID conversion for string literals, which keep parsing at run time.
  *
- * @param [in] uuid The 16bit short form UUID.
+ * @param [in] uuid The NUL terminated string, as for BLEUUID(std::string).
  */
-BLEUUID::BLEUUID(uint16_t uuid) {
-	m_uuid.len         = ESP_UUID_LEN_16;
-	m_uuid.uuid.uuid16 = uuid;
-	m_valueSet         = true;
+BLEUUID::BLEUUID(const char* uuid) : BLEUUID(std::string(uuid)) {
 } // BLEUUID
 
 
@@ -193,6 +194,38 @@ BLEUUID::BLEUUID(esp_gatt_id_t gattId) : BLEUUID(gattId.uuid) {
 } // BLEUUID
 
 
+/**
+ * @brief Report a malformed BLEStaticUUID string found at run time.
+ *
+ * Not constexpr, so a malformed string in a constant expression fails to compile.  A BLEStaticUUID built
+ * at run time from a non-literal array gets here instead and has 0 in place of what could not be parsed.
+ *
+ * @return 0.
+ */
+int bleInvalidUUIDString() {
+	ESP_LOGE(LOG_TAG, "BLEStaticUUID: malformed UUID string");
+	return 0;
+} // bleInvalidUUIDString
+
+
+/**
+ * @brief Create a UUID from one built at compile time.
+ *
+ * @param [in] uuid The compile time UUID, kept in its short form if it has one.
+ */
+BLEUUID::BLEUUID(const BLEStaticUUID& uuid) {
+	m_uuid.len = uuid.getLength();
+	if (m_uuid.len == ESP_UUID_LEN_16) {
+		m_uuid.uuid.uuid16 = uuid.getByte(12) | (uuid.getByte(13) << 8);
+	} else if (m_uuid.len == ESP_UUID_LEN_32) {
+		m_uuid.uuid.uuid32 = uuid.getByte(12) | (uuid.getByte(13) << 8) | (uuid.getByte(14) << 16) | ((uint32_t) uuid.getByte(15) << 24);
+	} else {
+		for (int i = 0; i < 16; i++) m_uuid.uuid.uuid128[i] = uuid.getByte(i);
+	}
+	m_valueSet = true;
+} // BLEUUID
+
+
 BLEUUID::BLEUUID() {
 	m_valueSet = false;
 } // BLEUUID
@@ -202,7 +235,7 @@ BLEUUID::BLEUUID() {
  * @brief Get the number of bits in this uuid.
  * @return The number of bits in the UUID.  One of 16, 32 or 128.
  */
-uint8_t BLEUUID::bitSize() {
+uint8_t BLEUUID::bitSize() const {
 	if (!m_valueSet) return 0;
 	switch (m_uuid.len) {
 		case ESP_UUID_LEN_16:
@@ -221,27 +254,55 @@ uint8_t BLEUUID::bitSize() {
 /**
  * @brief Compare a UUID against this UUID.
  *
+ * UUIDs of different lengths are compared on their canonical 128 bit form, so 0x180d equals
+ * 0000180d-0000-1000-8000-00805f9b34fb.
+ *
  * @param [in] uuid The UUID to compare against.
  * @return True if the UUIDs are equal and false otherwise.
  */
-bool BLEUUID::equals(BLEUUID uuid) {
-	//ESP_LOGD(TAG, "Comparing: %s to %s", toString().c_str(), uuid.toString().c_str());
+bool BLEUUID::equals(const BLEUUID& uuid) const {
 	if (!m_valueSet || !uuid.m_valueSet) return false;
 
-	if (uuid.m_uuid.len != m_uuid.len) {
-		return uuid.toString() == toString();
+	if (uuid.m_uuid.len == m_uuid.len) {
+		if (m_uuid.len == ESP_UUID_LEN_16) {
+			return uuid.m_uuid.uuid.uuid16 == m_uuid.uuid.uuid16;
+		}
+		if (m_uuid.len == ESP_UUID_LEN_32) {
+			return uuid.m_uuid.uuid.uuid32 == m_uuid.uuid.uuid32;
+		}
+		return memcmp(uuid.m_uuid.uuid.uuid128, m_uuid.uuid.uuid128, 16) == 0;
 	}
 
-	if (uuid.m_uuid.len == ESP_UUID_LEN_16) {
-		return uuid.m_uuid.uuid.uuid16 == m_uuid.uuid.uuid16;
-	}
+	uint8_t mine[16];
+	uint8_t theirs[16];
+	getCanonical(mine);
+	uuid.getCanonical(theirs);
+	return memcmp(mine, theirs, 16) == 0;
+} // equals
 
-	if (uuid.m_uuid.len == ESP_UUID_LEN_32) {
-		return uuid.m_uuid.uuid.uuid32 == m_uuid.uuid.uuid32;
-	}
 
-	return memcmp(uuid.m_uuid.uuid.uuid128, m_uuid.uuid.uuid128, 16) == 0;
-} // equals
+/**
+ * @brief Get the canonical 128 bit form of the UUID without changing it.
+ *
+ * @param [out] pBytes 16 bytes, least significant first as in esp_bt_uuid_t.  All zero if the UUID is
+ * not set.
+ */
+void BLEUUID::getCanonical(uint8_t* pBytes) const {
+	if (!m_valueSet) {
+		memset(pBytes, 0, 16);
+		return;
+	}
+	if (m_uuid.len == ESP_UUID_LEN_128) {
+		memcpy(pBytes, m_uuid.uuid.uuid128, 16);
+		return;
+	}
+	memcpy(pBytes, baseUUID, 12);
+	uint32_t value = m_uuid.len == ESP_UUID_LEN_16 ? m_uuid.uuid.uuid16 : m_uuid.uuid.uuid32;
+	pBytes[12] = value;
+	pBytes[13] = value >> 8;
+	pBytes[14] = value >> 16;
+	pBytes[15] = value >> 24;
+} // getCanonical
 
 
 /**
@@ -343,6 +404,27 @@ BLEUUID BLEUUID::to128() {
 } // to128
 
 
+/**
+ * @brief Order UUIDs by their canonical 128 bit form, as their strings would sort.
+ *
+ * A UUID that is not set orders before every UUID that is.
+ *
+ * @param [in] uuid The UUID to compare against.
+ * @return True if this UUID orders before the other.
+ */
+bool BLEUUID::operator<(const BLEUUID& uuid) const {
+	if (!uuid.m_valueSet) return false;
+	if (!m_valueSet) return true;
+
+	uint8_t mine[16];
+	uint8_t theirs[16];
+	getCanonical(mine);
+	uuid.getCanonical(theirs);
+	for (int i = 15; i >= 0; i--) {
+		if (mine[i] != theirs[i]) return mine[i] < theirs[i];
+	}
+	return false;
+} // operator<
 
 
 /**
@@ -356,52 +438,34 @@ BLEUUID BLEUUID::to128() {
  * @return A string representation of the UUID.
  */
 std::string BLEUUID::toString() {
-	if (!m_valueSet) return "<NULL>";   // If we have no value, nothing to format.
-
-	// If the UUIDs are 16 or 32 bit, pad correctly.
-	std::stringstream ss;
-
-	if (m_uuid.len == ESP_UUID_LEN_16) {  // If the UUID is 16bit, pad correctly.
-		ss << "0000" <<
-			std::hex <<
-			std::setfill('0') <<
-			std::setw(4) <<
-			m_uuid.uuid.uuid16 <<
-			"-0000-1000-8000-00805f9b34fb";
-		return ss.str();                    // Return the string
-	} // End 16bit UUID
-
-	if (m_uuid.len == ESP_UUID_LEN_32) {  // If the UUID is 32bit, pad correctly.
-		ss << std::hex <<
-			std::setfill('0') <<
-			std::setw(8) <<
-			m_uuid.uuid.uuid32 <<
-			"-0000-1000-8000-00805f9b34fb";
-		return ss.str();                    // return the string
-	} // End 32bit UUID
-
-	// The UUID is not 16bit or 32bit which means that it is 128bit.
-	//
-	// UUID string format:
-	// AABBCCDD-EEFF-GGHH-IIJJ-KKLLMMNNOOPP
-	ss << std::hex << std::setfill('0') <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[15] <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[14] <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[13] <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[12] << "-" <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[11] <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[10] << "-" <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[9]  <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[8]  << "-" <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[7]  <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[6]  << "-" <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[5]  <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[4]  <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[3]  <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[2]  <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[1]  <<
-		std::setw(2) << (int) m_uuid.uuid.uuid128[0];
-	return ss.str();
+	char buffer[BLE_UUID_STRING_LENGTH];
+	return std::string(toString(buffer));
+} // toString
+
+
+/**
+ * @brief Format the UUID into a buffer without allocating.
+ *
+ * @param [out] pBuffer At least BLE_UUID_STRING_LENGTH bytes, receives the 128 bit form of the UUID
+ * or "<NULL>" if it is not set.
+ * @return pBuffer.
+ */
+char* BLEUUID::toString(char* pBuffer) const {
+	if (!m_valueSet) {                   // If we have no value, nothing to format.
+		strcpy(pBuffer, "<NULL>");
+		return pBuffer;
+	}
+
+	uint8_t bytes[16];
+	getCanonical(bytes);
+	char* p = pBuffer;
+	for (int i = 15; i >= 0; i--) {
+		*p++ = hexDigits[bytes[i] >> 4];
+		*p++ = hexDigits[bytes[i] & 0x0f];
+		if (i == 12 || i == 10 || i == 8 || i == 6) *p++ = '-';
+	}
+	*p = 0;
+	return pBuffer;
 } // toString
 
 #endif /* CONFIG_BT_ENABLED */
@@ -11,29 +11,119 @@
 #if defined(CONFIG_BT_ENABLED)
 #include <esp_gatt_defs.h>
 #include <string>
+#include <functional>
+
+#define BLE_UUID_STRING_LENGTH 37   // "0000180d-0000-1000-8000-00805f9b34fb" + NUL.
+
+int bleInvalidUUIDString();   // Not constexpr: a malformed BLEStaticUUID string fails to compile as a constant.
+
+/**
+ * @brief A UUID built at compile time.
+ *
+ * A BLEStaticUUID is a literal type: it can be constructed with constexpr from a 16 or 32 bit value or
+ * from a string literal of 4, 8 or 36 characters, so a string UUID is parsed by the compiler rather than
+ * at run time, and a malformed one fails to compile when the UUID is declared constexpr:
+ *
+ *   static constexpr BLEStaticUUID SERVICE_UUID("4fafc201-1fb5-459e-8fcc-c5c9c331914b");
+ *   pServer->createService(SERVICE_UUID);
+ *
+ * Built at run time from an array that is not a literal, a malformed string logs an error instead.
+ *
+ * The bytes are kept in the canonical 128 bit form, least significant byte first as in esp_bt_uuid_t.
+ */
+class BLEStaticUUID {
+public:
+	constexpr BLEStaticUUID(uint16_t uuid) : BLEStaticUUID(ESP_UUID_LEN_16, uuid, nullptr) {}
+	constexpr BLEStaticUUID(uint32_t uuid) : BLEStaticUUID(ESP_UUID_LEN_32, uuid, nullptr) {}
+	template<size_t N>
+	constexpr BLEStaticUUID(const char (&uuid)[N]) : BLEStaticUUID(
+			N == 37 ? ESP_UUID_LEN_128 : (N == 9 ? ESP_UUID_LEN_32 : ESP_UUID_LEN_16),
+			N == 37 ? 0 : hexValue(uuid, 0, N - 1), uuid) {
+		static_assert(N == 5 || N == 9 || N == 37, "A UUID string has 4, 8 or 36 characters");
+	}
+	constexpr uint8_t getLength() const { return m_len; }
+	constexpr uint8_t getByte(int index) const { return m_bytes[index]; }
+
+private:
+	constexpr BLEStaticUUID(uint8_t len, uint32_t value, const char* pString) : m_len(len), m_bytes{
+		byteAt(0, len, value, pString),  byteAt(1, len, value, pString),  byteAt(2, len, value, pString),
+		byteAt(3, len, value, pString),  byteAt(4, len, value, pString),  byteAt(5, len, value, pString),
+		byteAt(6, len, value, pString),  byteAt(7, len, value, pString),  byteAt(8, len, value, pString),
+		byteAt(9, len, value, pString),  byteAt(10, len, value, pString), byteAt(11, len, value, pString),
+		byteAt(12, len, value, pString), byteAt(13, len, value, pString), byteAt(14, len, value, pString),
+		byteAt(15, len, value, pString) } {}
+
+	static constexpr uint32_t hexDigit(char c) {
+		return c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 :
+			c >= 'A' && c <= 'F' ? c - 'A' + 10 : bleInvalidUUIDString();
+	}
+	static constexpr uint32_t hexValue(const char* pString, int start, int count) {
+		return count == 0 ? 0 : hexValue(pString, start, count - 1) * 16 + hexDigit(pString[start + count - 1]);
+	}
+	// Offset in "xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx" of the pair of digits of byte j, counted from the left.
+	static constexpr int pairOffset(int j) {
+		return 2 * j + (j >= 4) + (j >= 6) + (j >= 8) + (j >= 10);
+	}
+	static constexpr bool dashesValid(const char* pString) {
+		return pString[8] == '-' && pString[13] == '-' && pString[18] == '-' && pString[23] == '-';
+	}
+	static constexpr uint8_t byteAt(int index, uint8_t len, uint32_t value, const char* pString) {
+		return len == ESP_UUID_LEN_128
+			? ((index == 0 && !dashesValid(pString)) ? bleInvalidUUIDString() : hexValue(pString, pairOffset(15 - index), 2))
+			: index >= 12 ? (uint8_t) (value >> (8 * (index - 12)))
+			: (uint8_t) "\xfb\x34\x9b\x5f\x80\x00\x00\x80\x00\x10\x00\x00"[index];   // Bluetooth base UUID.
+	}
+
+	uint8_t m_len;          // ESP_UUID_LEN_16, ESP_UUID_LEN_32 or ESP_UUID_LEN_128.
+	uint8_t m_bytes[16];
+}; // BLEStaticUUID
+
 
 /**
  * @brief A model of a %BLE UUID.
+ *
+ * UUIDs compare, order and hash on their canonical 128 bit form, so a 16 bit UUID equals the 128 bit
+ * UUID it abbreviates.  None of these allocate.
  */
 class BLEUUID {
 public:
 	BLEUUID(std::string uuid);
-	BLEUUID(uint16_t uuid);
+	BLEUUID(const char* uuid);
+	constexpr BLEUUID(uint16_t uuid) : m_uuid{ ESP_UUID_LEN_16, { uuid } }, m_valueSet(true) {}
 	BLEUUID(uint32_t uuid);
+	BLEUUID(const BLEStaticUUID& uuid);
 	BLEUUID(esp_bt_uuid_t uuid);
 	BLEUUID(uint8_t* pData, size_t size, bool msbFirst);
 	BLEUUID(esp_gatt_id_t gattId);
 	BLEUUID();
-	uint8_t        bitSize();   // Get the number of bits in this uuid.
-	bool           equals(BLEUUID uuid);
+	uint8_t        bitSize() const;   // Get the number of bits in this uuid.
+	bool           equals(const BLEUUID& uuid) const;
+	void           getCanonical(uint8_t* pBytes) const;
 	esp_bt_uuid_t* getNative();
 	BLEUUID        to128();
 	std::string    toString();
+	char*          toString(char* pBuffer) const;
 	static BLEUUID fromString(std::string uuid);  // Create a BLEUUID from a string
 
+	bool operator==(const BLEUUID& uuid) const { return equals(uuid); }
+	bool operator!=(const BLEUUID& uuid) const { return !equals(uuid); }
+	bool operator<(const BLEUUID& uuid) const;
+
 private:
 	esp_bt_uuid_t m_uuid;       		// The underlying UUID structure that this class wraps.
 	bool          m_valueSet = false;   // Is there a value set for this instance.
 }; // BLEUUID
+
+namespace std {
+template<> struct hash<BLEUUID> {
+	size_t operator()(const BLEUUID& uuid) const {
+		uint8_t bytes[16];
+		uuid.getCanonical(bytes);
+		uint32_t hash = 2166136261u;   // FNV-1a.
+		for (int i = 0; i < 16; i++) hash = (hash ^ bytes[i]) * 16777619u;
+		return hash;
+	}
+};
+} // namespace std
 #endif /* CONFIG_BT_ENABLED */
 #endif /* COMPONENTS_CPP_UTILS_BLEUUID_H_ */
@@ -0,0 +1,160 @@
+/*
+ * BLEUUIDTable.cpp
+ *
+ *  Shared storage of the UUIDs of discovered attributes.
+ */
+#include "sdkconfig.h"
+#if defined(CONFIG_BT_ENABLED)
+#include <string.h>
+#include "BLEUUIDTable.h"
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_ARDUHAL_ESP_LOG)
+#include "esp32-hal-log.h"
+#define LOG_TAG ""
+#else
+#include "esp_log.h"
+static const char* LOG_TAG = "BLEUUIDTable";
+#endif
+
+std::vector<BLEUUIDTable::uuid_entry_t> BLEUUIDTable::m_entries;
+size_t                                  BLEUUIDTable::m_count = 0;
+
+
+/**
+ * @brief Find the reference of a UUID without adding it.
+ * @param [in] uuid The UUID to look up.
+ * @return The reference or BLE_UUID_REF_NONE if the UUID is not in the table.
+ */
+/* STATIC */ ble_uuid_ref_t BLEUUIDTable::find(const BLEUUID& uuid) {
+	uint8_t canonical[16];
+	uuid.getCanonical(canonical);
+	xSemaphoreTake(getLock(), portMAX_DELAY);
+	ble_uuid_ref_t ref = lookup(canonical);
+	xSemaphoreGive(getLock());
+	return ref;
+} // find
+
+
+/**
+ * @brief Get the UUID of a reference.
+ *
+ * The UUID is returned in its shortest form: 16 bit, 32 bit or 128 bit.
+ *
+ * @param [in] ref The reference.
+ * @return The UUID, not set if the reference is not in use.
+ */
+/* STATIC */ BLEUUID BLEUUIDTable::get(ble_uuid_ref_t ref) {
+	uint8_t canonical[16];
+	xSemaphoreTake(getLock(), portMAX_DELAY);
+	bool found = ref < m_entries.size() && m_entries[ref].refs != 0;
+	if (found) memcpy(canonical, m_entries[ref].uuid, 16);
+	xSemaphoreGive(getLock());
+	if (!found) return BLEUUID();
+
+	BLEUUID uuid(canonical, 16, false);
+	uint8_t base[16];
+	BLEUUID((uint16_t) 0).getCanonical(base);
+	if (memcmp(canonical, base, 12) != 0) return uuid;        // Not derived from the Bluetooth base UUID.
+	uint32_t value = canonical[12] | (canonical[13] << 8) | (canonical[14] << 16) | ((uint32_t) canonical[15] << 24);
+	return value <= 0xffff ? BLEUUID((uint16_t) value) : BLEUUID(value);
+} // get
+
+
+/**
+ * @brief Get the number of distinct UUIDs in the table.
+ * @return The number of entries in use.
+ */
+/* STATIC */ size_t BLEUUIDTable::getCount() {
+	return m_count;
+} // getCount
+
+
+/**
+ * @brief Get the memory used by the table.
+ * @return The bytes reserved for entries, in use or free.
+ */
+/* STATIC */ size_t BLEUUIDTable::getFootprint() {
+	return m_entries.capacity() * sizeof(uuid_entry_t);
+} // getFootprint
+
+
+/**
+ * @brief Get the mutex guarding the table.
+ * Attributes are discovered from application tasks and from the BLE event task.
+ * @return The table mutex.
+ */
+/* STATIC */ SemaphoreHandle_t BLEUUIDTable::getLock() {
+	static SemaphoreHandle_t lock = ::xSemaphoreCreateMutex();
+	return lock;
+} // getLock
+
+
+/**
+ * @brief Add a reference to a UUID, adding the UUID to the table if it is not there yet.
+ * @param [in] uuid The UUID.
+ * @return The reference, to be given back with release(), or BLE_UUID_REF_NONE if the UUID is not set
+ * or the table is full.
+ */
+/* STATIC */ ble_uuid_ref_t BLEUUIDTable::intern(const BLEUUID& uuid) {
+	uint8_t canonical[16];
+	uuid.getCanonical(canonical);
+	if (uuid.bitSize() == 0) return BLE_UUID_REF_NONE;
+
+	xSemaphoreTake(getLock(), portMAX_DELAY);
+	ble_uuid_ref_t ref = lookup(canonical);
+	if (ref == BLE_UUID_REF_NONE) {
+		for (size_t i = 0; i < m_entries.size(); i++) {     // Reuse a released entry if there is one.
+			if (m_entries[i].refs == 0) {
+				ref = i;
+				break;
+			}
+		}
+		if (ref == BLE_UUID_REF_NONE && m_entries.size() < BLE_UUID_REF_NONE) {
+			ref = m_entries.size();
+			m_entries.push_back(uuid_entry_t());
+		}
+		if (ref != BLE_UUID_REF_NONE) {
+			memcpy(m_entries[ref].uuid, canonical, 16);
+			m_entries[ref].refs = 0;
+			m_count++;
+		}
+	}
+	if (ref != BLE_UUID_REF_NONE && m_entries[ref].refs != UINT16_MAX) {
+		m_entries[ref].refs++;
+	}
+	xSemaphoreGive(getLock());
+
+	if (ref == BLE_UUID_REF_NONE) {
+		char text[BLE_UUID_STRING_LENGTH];
+		ESP_LOGE(LOG_TAG, "UUID table full, unable to add %s", uuid.toString(text));
+	}
+	return ref;
+} // intern
+
+
+/**
+ * @brief Find the entry holding a canonical UUID.  Called with the lock held.
+ * @param [in] pCanonical The 16 bytes of the UUID.
+ * @return The reference or BLE_UUID_REF_NONE if the UUID is not in the table.
+ */
+/* STATIC */ ble_uuid_ref_t BLEUUIDTable::lookup(const uint8_t* pCanonical) {
+	for (size_t i = 0; i < m_entries.size(); i++) {
+		if (m_entries[i].refs != 0 && memcmp(m_entries[i].uuid, pCanonical, 16) == 0) return i;
+	}
+	return BLE_UUID_REF_NONE;
+} // lookup
+
+
+/**
+ * @brief Give back a reference obtained from intern().
+ * @param [in] ref The reference.  BLE_UUID_REF_NONE is ignored.
+ */
+/* STATIC */ void BLEUUIDTable::release(ble_uuid_ref_t ref) {
+	xSemaphoreTake(getLock(), portMAX_DELAY);
+	if (ref < m_entries.size() && m_entries[ref].refs != 0 && m_entries[ref].refs != UINT16_MAX) {
+		if (--m_entries[ref].refs == 0) m_count--;
+	}
+	xSemaphoreGive(getLock());
+} // release
+
+#endif // CONFIG_BT_ENABLED
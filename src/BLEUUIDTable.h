@@ -0,0 +1,57 @@
+/*
+ * BLEUUIDTable.h
+ *
+ *  Shared storage of the UUIDs of discovered attributes.
+ */
+
+#ifndef _BLEUUIDTABLE_H_
+#define _BLEUUIDTABLE_H_
+
+#include "sdkconfig.h"
+#if defined(CONFIG_BT_ENABLED)
+
+#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "BLEUUID.h"
+
+typedef uint16_t ble_uuid_ref_t;       // A reference to a UUID held in the BLEUUIDTable.
+#define BLE_UUID_REF_NONE 0xffff        // No UUID, returned when a UUID is not in the table.
+
+
+/**
+ * @brief A table holding each distinct UUID once.
+ *
+ * A BLEUUID takes 20 bytes and the remote attribute maps used to add a 36 character string key on top
+ * of that, while a discovered profile typically repeats a handful of UUIDs (0x2902, a vendor base)
+ * across dozens of attributes.  The remote services, characteristics and descriptors instead hold a
+ * 16 bit reference into this table, which is also the key of their maps.
+ *
+ * UUIDs are interned on their canonical 128 bit form, so 0x180d and 0000180d-0000-1000-8000-00805f9b34fb
+ * get the same reference and two references are equal exactly when their UUIDs are.  Entries are
+ * reference counted: each intern() must be matched by a release(), after which the entry is reused.
+ */
+class BLEUUIDTable {
+public:
+	static ble_uuid_ref_t find(const BLEUUID& uuid);
+	static BLEUUID        get(ble_uuid_ref_t ref);
+	static size_t         getCount();
+	static size_t         getFootprint();
+	static ble_uuid_ref_t intern(const BLEUUID& uuid);
+	static void           release(ble_uuid_ref_t ref);
+
+private:
+	typedef struct {
+		uint8_t  uuid[16];     // Canonical form, least significant byte first.
+		uint16_t refs;         // 0 for a free entry, UINT16_MAX pins the entry.
+	} uuid_entry_t;
+
+	static SemaphoreHandle_t getLock();
+	static ble_uuid_ref_t    lookup(const uint8_t* pCanonical);
+
+	static std::vector<uuid_entry_t> m_entries;
+	static size_t                    m_count;     // Entries in use.
+}; // BLEUUIDTable
+
+#endif // CONFIG_BT_ENABLED
+#endif /* _BLEUUIDTABLE_H_ */
@@ -767,6 +767,9 @@ esp_gatt_srvc_id_t BLEUtils::buildGattSrvcId(esp_gatt_id_t gattId, bool is_prima
 /**
  * @brief Create a hex representation of data.
  *
+ * At most 100 bytes are converted.  Prefer the variant taking a buffer size, which neither allocates
+ * nor limits the length.
+ *
  * @param [in] target Where to write the hex string.  If this is null, we malloc storage.
  * @param [in] source The start of the binary data.
  * @param [in] length The length of the data to convert.
@@ -783,20 +786,21 @@ char* BLEUtils::buildHexData(uint8_t* target, uint8_t* source, uint8_t length) {
 			return nullptr;
 		}
 	}
-	char* startOfData = (char*) target;
-
-	for (int i = 0; i < length; i++) {
-		sprintf((char*) target, "%.2x", (char) *source);
-		source++;
-		target += 2;
-	}
+	return GeneralUtils::hexEncode((char*) target, length * 2 + 1, source, length);
+} // buildHexData
 
-	// Handle the special case where there was no data.
-	if (length == 0) {
-		*startOfData = 0;
-	}
 
-	return startOfData;
+/**
+ * @brief Create a hex representation of data in a buffer.
+ *
+ * @param [out] pBuffer Where to write the hex string.
+ * @param [in] bufferSize The size of the buffer.  Data that does not fit is cut and marked with "...".
+ * @param [in] source The start of the binary data.
+ * @param [in] length The length of the data to convert.
+ * @return pBuffer.
+ */
+char* BLEUtils::buildHexData(char* pBuffer, size_t bufferSize, const uint8_t* source, size_t length) {
+	return GeneralUtils::hexEncode(pBuffer, bufferSize, source, length);
 } // buildHexData
 
 
@@ -1711,9 +1715,8 @@ void BLEUtils::dumpGattServerEvent(
 					evtParam->write.need_rsp,
 					evtParam->write.is_prep,
 					evtParam->write.len);
-			char* pHex = buildHexData(nullptr, evtParam->write.value, evtParam->write.len);
-			ESP_LOGV(LOG_TAG, "[Data: %s]", pHex);
-			free(pHex);
+			char hex[BLE_HEX_LOG_MAX * 2 + 1];
+			ESP_LOGV(LOG_TAG, "[Data: %s]", buildHexData(hex, sizeof(hex), evtParam->write.value, evtParam->write.len));
 			break;
 		} // ESP_GATTS_WRITE_EVT
 #endif
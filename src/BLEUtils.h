@@ -15,6 +15,8 @@
 #include <string>
 #include "BLEClient.h"
 
+#define BLE_HEX_LOG_MAX 64     // Bytes of data shown in hex in a log line.
+
 /**
  * @brief A set of general %BLE utilities.
  */
@@ -24,6 +26,7 @@ public:
 	static std::string        adFlagsToString(uint8_t adFlags);
 	static const char*        advTypeToString(uint8_t advType);
 	static char*              buildHexData(uint8_t* target, uint8_t* source, uint8_t length);
+	static char*              buildHexData(char* pBuffer, size_t bufferSize, const uint8_t* source, size_t length);
 	static std::string        buildPrintData(uint8_t* source, size_t length);
 	static std::string        characteristicPropertiesToString(esp_gatt_char_prop_t prop);
 	static const char*        devTypeToString(esp_bt_dev_type_t type);
@@ -7,6 +7,8 @@
 #include "sdkconfig.h"
 #if defined(CONFIG_BT_ENABLED)
 #include "BLEValue.h"
+#include <stdlib.h>
+#include <string.h>
 
 #if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_ARDUHAL_ESP_LOG)
 #include "esp32-hal-log.h"
@@ -18,21 +20,180 @@ static const char* LOG_TAG="BLEValue";
 
 
 
+void*  BLEValueArena::m_freeList[BLEValueArena::CLASS_COUNT] = { nullptr };
+size_t BLEValueArena::m_reservedBytes = 0;
+size_t BLEValueArena::m_usedBytes     = 0;
+
+
+/**
+ * @brief Get the mutex guarding the arena.
+ * Values are written both from application tasks and from the BLE event task.
+ * @return The arena mutex.
+ */
+SemaphoreHandle_t BLEValueArena::getLock() {
+	static SemaphoreHandle_t lock = ::xSemaphoreCreateMutex();
+	return lock;
+} // getLock
+
+
+/**
+ * @brief Get the size class for a length.
+ * @param [in] length The number of bytes needed.
+ * @return The index of the smallest slot class that holds length bytes.
+ */
+uint8_t BLEValueArena::getClass(size_t length) {
+	uint8_t sizeClass = 0;
+	while (((size_t) 1 << (sizeClass + MIN_SLOT_SHIFT)) < length) {
+		sizeClass++;
+	}
+	return sizeClass;
+} // getClass
+
+
+/**
+ * @brief Allocate storage from the arena.
+ * @param [in] length The number of bytes needed.
+ * @param [out] pCapacity The number of bytes actually reserved.
+ * @return A pointer to the storage or nullptr if length was 0 or memory is exhausted.
+ */
+uint8_t* BLEValueArena::allocate(size_t length, uint16_t* pCapacity) {
+	*pCapacity = 0;
+	if (length == 0) return nullptr;
+
+	if (length > CHUNK_SIZE) {
+		uint8_t* pData = (uint8_t*) malloc(length);
+		if (pData == nullptr) return nullptr;
+		::xSemaphoreTake(getLock(), portMAX_DELAY);
+		m_reservedBytes += length;
+		m_usedBytes     += length;
+		::xSemaphoreGive(getLock());
+		*pCapacity = length;
+		return pData;
+	}
+
+	uint8_t  sizeClass = getClass(length);
+	uint16_t slotSize  = 1 << (sizeClass + MIN_SLOT_SHIFT);
+
+	::xSemaphoreTake(getLock(), portMAX_DELAY);
+	if (m_freeList[sizeClass] == nullptr) {
+		// Carve a new chunk into slots of this class.
+		uint8_t* pChunk = (uint8_t*) malloc(CHUNK_SIZE);
+		if (pChunk == nullptr) {
+			::xSemaphoreGive(getLock());
+			ESP_LOGE(LOG_TAG, "allocate: out of memory (%d bytes)", CHUNK_SIZE);
+			return nullptr;
+		}
+		m_reservedBytes += CHUNK_SIZE;
+		for (uint16_t offset = 0; offset < CHUNK_SIZE; offset += slotSize) {
+			*(void**) (pChunk + offset) = m_freeList[sizeClass];
+			m_freeList[sizeClass] = pChunk + offset;
+		}
+	}
+	uint8_t* pData = (uint8_t*) m_freeList[sizeClass];
+	m_freeList[sizeClass] = *(void**) pData;
+	m_usedBytes += slotSize;
+	::xSemaphoreGive(getLock());
+
+	*pCapacity = slotSize;
+	return pData;
+} // allocate
+
+
+/**
+ * @brief Return storage to the arena.
+ * @param [in] pData Storage previously returned by allocate().
+ * @param [in] capacity The capacity reported by allocate().
+ */
+void BLEValueArena::release(uint8_t* pData, uint16_t capacity) {
+	if (pData == nullptr) return;
+
+	if (capacity > CHUNK_SIZE) {
+		free(pData);
+		::xSemaphoreTake(getLock(), portMAX_DELAY);
+		m_reservedBytes -= capacity;
+		m_usedBytes     -= capacity;
+		::xSemaphoreGive(getLock());
+		return;
+	}
+
+	uint8_t sizeClass = getClass(capacity);
+	::xSemaphoreTake(getLock(), portMAX_DELAY);
+	*(void**) pData = m_freeList[sizeClass];
+	m_freeList[sizeClass] = pData;
+	m_usedBytes -= capacity;
+	::xSemaphoreGive(getLock());
+} // release
+
+
+/**
+ * @brief Get the number of heap bytes held by the arena.
+ * @return The size of all chunks and large values.
+ */
+size_t BLEValueArena::getReservedBytes() {
+	return m_reservedBytes;
+} // getReservedBytes
+
+
+/**
+ * @brief Get the number of arena bytes currently assigned to values.
+ * @return The capacity of all live slots.
+ */
+size_t BLEValueArena::getUsedBytes() {
+	return m_usedBytes;
+} // getUsedBytes
+
+
 BLEValue::BLEValue() {
-	m_accumulation = "";
-	m_value        = "";
-	m_readOffset   = 0;
+	m_pValue               = nullptr;
+	m_pAccumulation        = nullptr;
+	m_length               = 0;
+	m_capacity             = 0;
+	m_accumulationLength   = 0;
+	m_accumulationCapacity = 0;
+	m_readOffset           = 0;
 } // BLEValue
 
 
+BLEValue::~BLEValue() {
+	BLEValueArena::release(m_pValue, m_capacity);
+	BLEValueArena::release(m_pAccumulation, m_accumulationCapacity);
+} // ~BLEValue
+
+
+/**
+ * @brief Make sure a buffer can hold length bytes, moving it to a larger arena slot if needed.
+ * @param [in,out] ppData The buffer.
+ * @param [in,out] pCapacity The capacity of the buffer.
+ * @param [in] length The number of bytes needed.
+ * @param [in] keep The number of existing bytes to carry over to a new buffer.
+ * @return True if the buffer can hold length bytes.
+ */
+bool BLEValue::reserve(uint8_t** ppData, uint16_t* pCapacity, size_t length, size_t keep) {
+	if (length <= *pCapacity) return true;
+	if (length > UINT16_MAX) {
+		ESP_LOGE(LOG_TAG, "Value of %d bytes is too large", length);
+		return false;
+	}
+	uint16_t capacity;
+	uint8_t* pData = BLEValueArena::allocate(length, &capacity);
+	if (pData == nullptr) return false;
+	if (keep > 0) {
+		memcpy(pData, *ppData, keep);
+	}
+	BLEValueArena::release(*ppData, *pCapacity);
+	*ppData    = pData;
+	*pCapacity = capacity;
+	return true;
+} // reserve
+
+
 /**
  * @brief Add a message part to the accumulation.
  * The accumulation is a growing set of data that is added to until a commit or cancel.
  * @param [in] part A message part being added.
  */
 void BLEValue::addPart(std::string part) {
-	ESP_LOGD(LOG_TAG, ">> addPart: length=%d", part.length());
-	m_accumulation += part;
+	addPart((uint8_t*) part.data(), part.length());
 } // addPart
 
 
@@ -44,7 +205,11 @@ void BLEValue::addPart(std::string part) {
  */
 void BLEValue::addPart(uint8_t* pData, size_t length) {
 	ESP_LOGD(LOG_TAG, ">> addPart: length=%d", length);
-	m_accumulation += std::string((char*) pData, length);
+	if (!reserve(&m_pAccumulation, &m_accumulationCapacity, m_accumulationLength + length, m_accumulationLength)) {
+		return;
+	}
+	memcpy(m_pAccumulation + m_accumulationLength, pData, length);
+	m_accumulationLength += length;
 } // addPart
 
 
@@ -53,8 +218,11 @@ void BLEValue::addPart(uint8_t* pData, size_t length) {
  */
 void BLEValue::cancel() {
 	ESP_LOGD(LOG_TAG, ">> cancel");
-	m_accumulation = "";
-	m_readOffset   = 0;
+	BLEValueArena::release(m_pAccumulation, m_accumulationCapacity);
+	m_pAccumulation        = nullptr;
+	m_accumulationLength   = 0;
+	m_accumulationCapacity = 0;
+	m_readOffset           = 0;
 } // cancel
 
 
@@ -62,15 +230,21 @@ void BLEValue::cancel() {
  * @brief Commit the current accumulation.
  * When writing a value, we may find that we write it in "parts" meaning that the writes come in in pieces
  * of the overall message.  After the last part has been received, we may perform a commit which means that
- * we now have the complete message and commit the change as a unit.
+ * we now have the complete message and commit the change as a unit.  The accumulated slot becomes the value
+ * so nothing is copied.
  */
 void BLEValue::commit() {
 	ESP_LOGD(LOG_TAG, ">> commit");
 	// If there is nothing to commit, do nothing.
-	if (m_accumulation.length() == 0) return;
-	setValue(m_accumulation);
-	m_accumulation = "";
-	m_readOffset   = 0;
+	if (m_accumulationLength == 0) return;
+	BLEValueArena::release(m_pValue, m_capacity);
+	m_pValue               = m_pAccumulation;
+	m_length               = m_accumulationLength;
+	m_capacity             = m_accumulationCapacity;
+	m_pAccumulation        = nullptr;
+	m_accumulationLength   = 0;
+	m_accumulationCapacity = 0;
+	m_readOffset           = 0;
 } // commit
 
 
@@ -79,16 +253,26 @@ void BLEValue::commit() {
  * @return A pointer to the data.
  */
 uint8_t* BLEValue::getData() {
-	return (uint8_t*) m_value.data();
+	static uint8_t empty = 0;
+	return m_pValue != nullptr ? m_pValue : &empty;
 }
 
 
+/**
+ * @brief Get the heap bytes held by this value.
+ * @return The capacity of the value and accumulation slots.
+ */
+size_t BLEValue::getFootprint() {
+	return m_capacity + m_accumulationCapacity;
+} // getFootprint
+
+
 /**
  * @brief Get the length of the data in bytes.
  * @return The length of the data in bytes.
  */
 size_t BLEValue::getLength() {
-	return m_value.length();
+	return m_length;
 } // getLength
 
 
@@ -105,7 +289,7 @@ uint16_t BLEValue::getReadOffset() {
  * @brief Get the current value.
  */
 std::string BLEValue::getValue() {
-	return m_value;
+	return std::string((char*) getData(), m_length);
 } // getValue
 
 
@@ -122,17 +306,24 @@ void BLEValue::setReadOffset(uint16_t readOffset) {
  * @brief Set the current value.
  */
 void BLEValue::setValue(std::string value) {
-	m_value = value;
+	setValue((uint8_t*) value.data(), value.length());
 } // setValue
 
 
 /**
  * @brief Set the current value.
+ * The value is written in place when it fits the current arena slot.
  * @param [in] pData The data for the current value.
  * @param [in] The length of the new current value.
  */
 void BLEValue::setValue(uint8_t* pData, size_t length) {
-	m_value = std::string((char*) pData, length);
+	if (!reserve(&m_pValue, &m_capacity, length, 0)) {
+		return;
+	}
+	if (length > 0) {
+		memcpy(m_pValue, pData, length);
+	}
+	m_length = length;
 } // setValue
 
 
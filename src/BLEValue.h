@@ -10,6 +10,38 @@
 #include "sdkconfig.h"
 #if defined(CONFIG_BT_ENABLED)
 #include <string>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+/**
+ * @brief A shared arena holding the storage of every %BLE value.
+ *
+ * Values are placed in power of two slots (8 to 512 bytes) carved out of 512 byte chunks.  Released
+ * slots are kept on a free list per size class and reused by the next value of that class, so a value
+ * that changes size does not go back to the heap.  Chunks are never returned to the heap.  Values larger
+ * than the biggest slot are allocated from the heap directly.
+ */
+class BLEValueArena {
+public:
+	static uint8_t* allocate(size_t length, uint16_t* pCapacity);
+	static void     release(uint8_t* pData, uint16_t capacity);
+	static size_t   getReservedBytes();
+	static size_t   getUsedBytes();
+
+	static const uint16_t CHUNK_SIZE = 512;
+
+private:
+	static const uint8_t MIN_SLOT_SHIFT = 3;   // Smallest slot is 8 bytes.
+	static const uint8_t CLASS_COUNT    = 7;   // 8, 16, 32, 64, 128, 256, 512.
+
+	static SemaphoreHandle_t getLock();
+	static uint8_t           getClass(size_t length);
+
+	static void*  m_freeList[CLASS_COUNT];
+	static size_t m_reservedBytes;
+	static size_t m_usedBytes;
+}; // BLEValueArena
+
 
 /**
  * @brief The model of a %BLE value.
@@ -17,11 +49,13 @@
 class BLEValue {
 public:
 	BLEValue();
+	~BLEValue();
 	void		addPart(std::string part);
 	void		addPart(uint8_t* pData, size_t length);
 	void		cancel();
 	void		commit();
 	uint8_t*	getData();
+	size_t      getFootprint();
 	size_t	  getLength();
 	uint16_t	getReadOffset();
 	std::string getValue();
@@ -30,9 +64,18 @@ public:
 	void        setValue(uint8_t* pData, size_t length);
 
 private:
-	std::string m_accumulation;
+	BLEValue(const BLEValue&) = delete;
+	BLEValue& operator=(const BLEValue&) = delete;
+
+	static bool reserve(uint8_t** ppData, uint16_t* pCapacity, size_t length, size_t keep);
+
+	uint8_t*    m_pValue;
+	uint8_t*    m_pAccumulation;
+	uint16_t    m_length;
+	uint16_t    m_capacity;
+	uint16_t    m_accumulationLength;
+	uint16_t    m_accumulationCapacity;
 	uint16_t    m_readOffset;
-	std::string m_value;
 
 };
 #endif // CONFIG_BT_ENABLED
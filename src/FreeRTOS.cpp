@@ -10,6 +10,7 @@
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include <stdlib.h>
 #include "FreeRTOS.h"
 #include "sdkconfig.h"
 #if defined(ARDUINO_ARCH_ESP32) && defined(CONFIG_ARDUHAL_ESP_LOG)
@@ -211,11 +212,21 @@ bool FreeRTOS::Semaphore::take(uint32_t timeoutMs, std::string owner) {
  */
 std::string FreeRTOS::Semaphore::toString() {
 	std::stringstream stringStream;
-	stringStream << "name: "<< m_name << " (0x" << std::hex << std::setfill('0') << (uint32_t)m_semaphore << "), owner: " << m_owner;
+	stringStream << "name: "<< m_name << " (0x" << std::hex << std::setfill('0') << (uintptr_t)m_semaphore << "), owner: " << m_owner;
 	return stringStream.str();
 } // toString
 
 
+/**
+ * @brief Get the memory used by the kernel object behind the semaphore.
+ * The object itself is counted by whoever holds it.
+ * @return The number of bytes allocated by the kernel; 0 for a pthread mutex, which lives in the object.
+ */
+size_t FreeRTOS::Semaphore::getFootprint() {
+	return m_usePthreads ? 0 : sizeof(StaticSemaphore_t);
+} // getFootprint
+
+
 /**
  * @brief Set the name of the semaphore.
  * @param [in] name The name of the semaphore.
@@ -231,15 +242,84 @@ void FreeRTOS::Semaphore::setName(std::string name) {
  * @param [in] type The type of buffer.  One of RINGBUF_TYPE_NOSPLIT, RINGBUF_TYPE_ALLOWSPLIT, RINGBUF_TYPE_BYTEBUF.
  */
 Ringbuffer::Ringbuffer(size_t length, ringbuf_type_t type) {
-	m_handle = ::xRingbufferCreate(length, type);
+	m_handle         = ::xRingbufferCreate(length, type);
+	m_type           = type;
+	m_pAcquired      = nullptr;
+	m_acquiredLength = 0;
+	m_acquiredWait   = 0;
+	m_pStaging       = nullptr;
+	m_stagingSize    = 0;
 } // Ringbuffer
 
 
 Ringbuffer::~Ringbuffer() {
 	::vRingbufferDelete(m_handle);
+	free(m_pStaging);
 } // ~Ringbuffer
 
 
+/**
+ * @brief Reserve space for an item so that it can be built in place.
+ *
+ * The returned storage is owned by the ring buffer until commit() is called.  Only one item may be
+ * outstanding at a time.  For RINGBUF_TYPE_NOSPLIT buffers the storage is inside the ring itself and
+ * nothing is copied; for other buffer types (or older frameworks) the item is staged and copied into
+ * the ring on commit().
+ * @param [in] length The size of the item to reserve.
+ * @param [in] wait How long to wait for space before giving up.  The default is to wait indefinitely.
+ * @return A pointer to the reserved storage or nullptr if no space could be obtained.
+ */
+void* Ringbuffer::acquire(size_t length, TickType_t wait) {
+	if (m_pAcquired != nullptr) {
+		ESP_LOGE(LOG_TAG, "acquire: previous item has not been committed");
+		return nullptr;
+	}
+#ifdef RINGBUFFER_HAS_SEND_ACQUIRE
+	if (m_type == RINGBUF_TYPE_NOSPLIT) {
+		if (::xRingbufferSendAcquire(m_handle, &m_pAcquired, length, wait) != pdTRUE) {
+			m_pAcquired = nullptr;
+			return nullptr;
+		}
+		m_acquiredLength = length;
+		return m_pAcquired;
+	}
+#endif
+	if (length > m_stagingSize) {
+		uint8_t* pStaging = (uint8_t*) realloc(m_pStaging, length);
+		if (pStaging == nullptr) {
+			ESP_LOGE(LOG_TAG, "acquire: unable to allocate %d bytes of staging", length);
+			return nullptr;
+		}
+		m_pStaging    = pStaging;
+		m_stagingSize = length;
+	}
+	m_pAcquired      = m_pStaging;
+	m_acquiredLength = length;
+	m_acquiredWait   = wait;
+	return m_pAcquired;
+} // acquire
+
+
+/**
+ * @brief Publish the item previously reserved with acquire().
+ * @return True if the item is now available to receivers.
+ */
+bool Ringbuffer::commit() {
+	if (m_pAcquired == nullptr) {
+		ESP_LOGE(LOG_TAG, "commit: no item has been acquired");
+		return false;
+	}
+	void* pItem = m_pAcquired;
+	m_pAcquired = nullptr;
+#ifdef RINGBUFFER_HAS_SEND_ACQUIRE
+	if (pItem != m_pStaging) {
+		return ::xRingbufferSendComplete(m_handle, pItem) == pdTRUE;
+	}
+#endif
+	return ::xRingbufferSend(m_handle, pItem, m_acquiredLength, m_acquiredWait) == pdTRUE;
+} // commit
+
+
 /**
  * @brief Receive data from the buffer.
  * @param [out] size On return, the size of data returned.
@@ -251,6 +331,29 @@ void* Ringbuffer::receive(size_t* size, TickType_t wait) {
 } // receive
 
 
+/**
+ * @brief Receive up to maxItems items from the buffer in one call.
+ *
+ * We wait (up to the supplied period) for the first item only and then collect whatever else is
+ * already queued without blocking.  Each returned item must be released with returnItem() or,
+ * for the whole batch, returnItems().
+ * @param [out] items Storage for at least maxItems item pointers.
+ * @param [out] sizes Storage for at least maxItems item sizes.
+ * @param [in] maxItems The maximum number of items to return.
+ * @param [in] wait How long to wait for the first item.
+ * @return The number of items retrieved.
+ */
+size_t Ringbuffer::receiveBatch(void** items, size_t* sizes, size_t maxItems, TickType_t wait) {
+	size_t count = 0;
+	while (count < maxItems) {
+		void* pItem = ::xRingbufferReceive(m_handle, &sizes[count], count == 0 ? wait : 0);
+		if (pItem == nullptr) break;
+		items[count++] = pItem;
+	}
+	return count;
+} // receiveBatch
+
+
 /**
  * @brief Return an item.
  * @param [in] item The item to be returned/released.
@@ -260,6 +363,18 @@ void Ringbuffer::returnItem(void* item) {
 } // returnItem
 
 
+/**
+ * @brief Return a batch of items obtained from receiveBatch().
+ * @param [in] items The items to be returned/released.
+ * @param [in] count The number of items.
+ */
+void Ringbuffer::returnItems(void** items, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		::vRingbufferReturnItem(m_handle, items[i]);
+	}
+} // returnItems
+
+
 /**
  * @brief Send data to the buffer.
  * @param [in] data The data to place into the buffer.
@@ -16,6 +16,21 @@
 #include <freertos/semphr.h>     // Include the semaphore definitions.
 #include <freertos/ringbuf.h>    // Include the ringbuffer definitions.
 
+#if defined(__has_include)
+#if __has_include(<esp_idf_version.h>)
+#include <esp_idf_version.h>
+#endif
+#endif
+
+// In-place sends (xRingbufferSendAcquire/xRingbufferSendComplete) arrived with ESP-IDF 4.1.  On older
+// frameworks the Ringbuffer class stages acquired items in a private buffer and copies them on commit.
+// Nested so that frameworks without esp_idf_version.h never see the ESP_IDF_VERSION_VAL() call.
+#if defined(ESP_IDF_VERSION)
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 1, 0)
+#define RINGBUFFER_HAS_SEND_ACQUIRE 1
+#endif
+#endif
+
 
 /**
  * @brief Interface to %FreeRTOS functions.
@@ -35,6 +50,7 @@ public:
 		void        give();
 		void        give(uint32_t value);
 		void        giveFromISR();
+		size_t      getFootprint();
 		void        setName(std::string name);
 		bool        take(std::string owner = "<Unknown>");
 		bool        take(uint32_t timeoutMs, std::string owner = "<Unknown>");
@@ -61,11 +77,21 @@ public:
 	Ringbuffer(size_t length, ringbuf_type_t type = RINGBUF_TYPE_NOSPLIT);
 	~Ringbuffer();
 
+	void*    acquire(size_t length, TickType_t wait = portMAX_DELAY);
+	bool     commit();
 	void*    receive(size_t* size, TickType_t wait = portMAX_DELAY);
+	size_t   receiveBatch(void** items, size_t* sizes, size_t maxItems, TickType_t wait = portMAX_DELAY);
 	void     returnItem(void* item);
+	void     returnItems(void** items, size_t count);
 	bool     send(void* data, size_t length, TickType_t wait = portMAX_DELAY);
 private:
 	RingbufHandle_t m_handle;
+	ringbuf_type_t  m_type;
+	void*           m_pAcquired;      // Item handed out by acquire() and not yet committed.
+	size_t          m_acquiredLength;
+	TickType_t      m_acquiredWait;
+	uint8_t*        m_pStaging;       // Staging storage used when the ring can't be written in place.
+	size_t          m_stagingSize;
 };
 
 #endif /* MAIN_FREERTOS_H_ */
@@ -32,6 +32,26 @@ static const char kBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
 	"abcdefghijklmnopqrstuvwxyz"
 	"0123456789+/";
 
+
+// The two hex digits of every byte value, so encoding is one table copy per byte.
+static const char kHexPairs[] =
+	"000102030405060708090a0b0c0d0e0f"
+	"101112131415161718191a1b1c1d1e1f"
+	"202122232425262728292a2b2c2d2e2f"
+	"303132333435363738393a3b3c3d3e3f"
+	"404142434445464748494a4b4c4d4e4f"
+	"505152535455565758595a5b5c5d5e5f"
+	"606162636465666768696a6b6c6d6e6f"
+	"707172737475767778797a7b7c7d7e7f"
+	"808182838485868788898a8b8c8d8e8f"
+	"909192939495969798999a9b9c9d9e9f"
+	"a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+	"b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+	"c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+	"d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+	"e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+	"f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
 static int base64EncodedLength(size_t length) {
 	return (length + 2 - ((length + 2) % 3)) / 3 * 4;
 } // base64EncodedLength
@@ -297,43 +317,60 @@ void GeneralUtils::hexDump(uint8_t* pData, uint32_t length) {
  * @return N/A.
  */
 void GeneralUtils::hexDump(const uint8_t* pData, uint32_t length) {
-	char ascii[80];
-	char hex[80];
-	char tempBuf[80];
-	uint32_t lineNumber = 0;
+	char hex[16 * 3 + 1];
+	char ascii[16 + 1];
 
 	ESP_LOGV(LOG_TAG, "     00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f");
 	ESP_LOGV(LOG_TAG, "     -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --");
-	strcpy(ascii, "");
-	strcpy(hex, "");
-	uint32_t index = 0;
-	while (index < length) {
-		sprintf(tempBuf, "%.2x ", pData[index]);
-		strcat(hex, tempBuf);
-		if (isprint(pData[index])) {
-			sprintf(tempBuf, "%c", pData[index]);
-		} else {
-			sprintf(tempBuf, ".");
-		}
-		strcat(ascii, tempBuf);
-		index++;
-		if (index % 16 == 0) {
-			ESP_LOGV(LOG_TAG, "%.4x %s %s", lineNumber * 16, hex, ascii);
-			strcpy(ascii, "");
-			strcpy(hex, "");
-			lineNumber++;
-		}
-	}
-	if (index %16 != 0) {
-		while (index % 16 != 0) {
-			strcat(hex, "   ");
-			index++;
+	for (uint32_t offset = 0; offset < length; offset += 16) {
+		uint32_t count = std::min(length - offset, (uint32_t) 16);
+		char*    p     = hex;
+		for (uint32_t i = 0; i < 16; i++, p += 3) {
+			if (i < count) {
+				uint8_t c = pData[offset + i];
+				memcpy(p, kHexPairs + 2 * c, 2);
+				p[2]     = ' ';
+				ascii[i] = isprint(c) ? c : '.';
+			} else {
+				memcpy(p, "   ", 3);
+			}
 		}
-		ESP_LOGV(LOG_TAG, "%.4x %s %s", lineNumber * 16, hex, ascii);
+		*p           = 0;
+		ascii[count] = 0;
+		ESP_LOGV(LOG_TAG, "%.4x %s %s", offset, hex, ascii);
 	}
 } // hexDump
 
 
+/**
+ * @brief Encode binary data as lower case hex into a buffer.
+ *
+ * Each byte is one copy from a table of digit pairs, without sprintf or allocation.  If the buffer is too
+ * small the output is cut after the last whole byte that fits with "..." behind it.
+ *
+ * @param [out] pBuffer The buffer receiving the NUL terminated hex.
+ * @param [in] bufferSize The size of the buffer; length * 2 + 1 holds all of the data.
+ * @param [in] pData The data to encode.
+ * @param [in] length The length of the data in bytes.
+ * @return pBuffer.
+ */
+char* GeneralUtils::hexEncode(char* pBuffer, size_t bufferSize, const uint8_t* pData, size_t length) {
+	if (bufferSize == 0) return pBuffer;
+	bool   cut   = length > (bufferSize - 1) / 2;
+	size_t count = !cut ? length : (bufferSize >= 4 ? (bufferSize - 4) / 2 : 0);   // Keep room for "...".
+	char*  p     = pBuffer;
+	for (size_t i = 0; i < count; i++, p += 2) {
+		memcpy(p, kHexPairs + 2 * pData[i], 2);
+	}
+	if (cut && bufferSize >= 4) {
+		memcpy(p, "...", 3);
+		p += 3;
+	}
+	*p = 0;
+	return pBuffer;
+} // hexEncode
+
+
 /**
  * @brief Convert an IP address to string.
  * @param ip The 4 byte IP address.
@@ -25,6 +25,7 @@ public:
 	static const char* errorToString(esp_err_t errCode);
 	static const char* wifiErrorToString(uint8_t value);
 	static void        hexDump(const uint8_t* pData, uint32_t length);
+	static char*       hexEncode(char* pBuffer, size_t bufferSize, const uint8_t* pData, size_t length);
 	static std::string ipToString(uint8_t* ip);
 	static std::vector<std::string> split(std::string source, char delimiter);
 	static std::string toLower(std::string& value);
@@ -0,0 +1,183 @@
+/*
+ * BLEAddressTest.cpp
+ *
+ *  Host tests of BLEAddress: formatting, parsing and ordering, and microbenchmarks against the
+ *  stringstream, sscanf and string keyed paths they replaced.
+ *
+ *  Build and run from the root of the repository:
+ *
+ *    g++ -std=gnu++11 -O2 -Itest/host/stubs -Isrc test/host/BLEAddressTest.cpp -o ble_address_test
+ *    ./ble_address_test
+ *
+ *  The exit status is the number of failed checks.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include "BLEAddress.cpp"
+
+static int failures = 0;
+
+#define CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+		failures++; \
+	} \
+} while (0)
+
+
+/**
+ * @brief The formatting BLEAddress::toString() replaced: one stringstream insertion per byte.
+ */
+static std::string streamToString(const uint8_t* pAddress) {
+	std::stringstream stream;
+	for (int i = 0; i < ESP_BD_ADDR_LEN; i++) {
+		if (i > 0) stream << ':';
+		stream << std::setfill('0') << std::setw(2) << std::hex << (int) pAddress[i];
+	}
+	return stream.str();
+} // streamToString
+
+
+/**
+ * @brief The parsing BLEAddress(std::string) replaced: sscanf into six ints.
+ */
+static void sscanfParse(const std::string& stringAddress, uint8_t* pAddress) {
+	if (stringAddress.length() != 17) return;
+	int data[6];
+	sscanf(stringAddress.c_str(), "%x:%x:%x:%x:%x:%x", &data[0], &data[1], &data[2], &data[3], &data[4], &data[5]);
+	for (int i = 0; i < ESP_BD_ADDR_LEN; i++) pAddress[i] = (uint8_t) data[i];
+} // sscanfParse
+
+
+/**
+ * @brief Addresses format, parse back and match the old implementations.
+ */
+static void testRoundTrip() {
+	BLEAddress address((uint64_t) 0x0123456789abULL);
+	CHECK(address.toString() == "01:23:45:67:89:ab");
+	CHECK(address.toString() == streamToString(*address.getNative()));
+	CHECK(address.toUint64() == 0x0123456789abULL);
+
+	CHECK(BLEAddress("01:23:45:67:89:AB") == address);
+	CHECK(BLEAddress(std::string("01:23:45:67:89:ab")).equals(address));
+
+	uint8_t parsed[ESP_BD_ADDR_LEN];
+	sscanfParse("01:23:45:67:89:ab", parsed);
+	CHECK(memcmp(parsed, *address.getNative(), ESP_BD_ADDR_LEN) == 0);
+} // testRoundTrip
+
+
+/**
+ * @brief Malformed strings are rejected and give the zero address.
+ */
+static void testRejected() {
+	const char* invalid[] = {
+		"",
+		"01:23:45:67:89",
+		"01:23:45:67:89:ab:",
+		"01-23-45-67-89-ab",
+		"01:23:45:67:89:ag",
+		"1:23:45:67:89:ab"
+	};
+	BLEAddress address((uint64_t) 0x0123456789abULL);
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+		CHECK(!BLEAddress::parse(invalid[i], &address));
+		CHECK(BLEAddress(invalid[i]).toUint64() == 0);
+	}
+	CHECK(!BLEAddress::parse(nullptr, &address));
+	CHECK(address.toUint64() == 0x0123456789abULL);   // Unchanged by the failed parses.
+} // testRejected
+
+
+/**
+ * @brief Addresses order as their strings do.
+ */
+static void testOrder() {
+	BLEAddress low((uint64_t) 0x00ff00000000ULL);
+	BLEAddress high((uint64_t) 0x010000000000ULL);
+	CHECK(low < high);
+	CHECK(!(high < low));
+	CHECK(low != high);
+	CHECK(low.toString() < high.toString());
+	CHECK(std::hash<BLEAddress>()(low) != std::hash<BLEAddress>()(high));
+} // testOrder
+
+
+/**
+ * @brief Time formatting, parsing and a scan results sized map lookup, old path against new.
+ */
+static void testThroughput() {
+	const int rounds = 200000;
+	const int entries = 50;
+	size_t checksum = 0;
+	char buffer[BLE_ADDRESS_STRING_LENGTH];
+
+	std::map<std::string, int> byString;
+	std::map<BLEAddress, int>  byAddress;
+	std::string keys[entries];
+	for (int i = 0; i < entries; i++) {
+		BLEAddress address((uint64_t) (0x240ac4000000ULL + i * 0x010203ULL));
+		keys[i] = address.toString();
+		byString[keys[i]] = i;
+		byAddress[address] = i;
+	}
+
+	BLEAddress address((uint64_t) 0x240ac4123456ULL);
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		(*address.getNative())[5] = i;
+		checksum += streamToString(*address.getNative())[16];
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		(*address.getNative())[5] = i;
+		checksum += address.toString()[16];
+	}
+	auto t2 = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		(*address.getNative())[5] = i;
+		checksum += address.toString(buffer)[16];
+	}
+	auto t3 = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		uint8_t parsed[ESP_BD_ADDR_LEN];
+		sscanfParse(keys[i % entries], parsed);
+		checksum += parsed[5];
+	}
+	auto t4 = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		BLEAddress parsed(keys[i % entries].c_str());
+		checksum += (*parsed.getNative())[5];
+	}
+	auto t5 = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		checksum += byString.find(keys[i % entries])->second;
+	}
+	auto t6 = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		checksum += byAddress.find(BLEAddress((uint64_t) (0x240ac4000000ULL + (i % entries) * 0x010203ULL)))->second;
+	}
+	auto t7 = std::chrono::steady_clock::now();
+
+	auto ns = [rounds](std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+		return std::chrono::duration<double, std::nano>(to - from).count() / rounds;
+	};
+	printf("toString:    %.0f ns stringstream, %.0f ns string, %.0f ns buffer\n", ns(start, t1), ns(t1, t2), ns(t2, t3));
+	printf("parse:       %.0f ns sscanf, %.0f ns parse()\n", ns(t3, t4), ns(t4, t5));
+	printf("map lookup:  %.0f ns by string, %.0f ns by address (%d entries)\n", ns(t5, t6), ns(t6, t7), entries);
+	CHECK(checksum != 0);
+} // testThroughput
+
+
+int main() {
+	testRoundTrip();
+	testRejected();
+	testOrder();
+	testThroughput();
+	printf("%s: %d failure(s)\n", failures == 0 ? "PASS" : "FAIL", failures);
+	return failures;
+} // main
@@ -0,0 +1,165 @@
+/*
+ * BLEEddystoneURLTest.cpp
+ *
+ *  Host tests of the Eddystone URL encoding: round trips, rejected input and throughput.
+ *
+ *  Build and run from the root of the repository:
+ *
+ *    g++ -std=gnu++11 -O2 -Itest/host/stubs -Isrc test/host/BLEEddystoneURLTest.cpp -o eddystone_url_test
+ *    ./eddystone_url_test
+ *
+ *  The exit status is the number of failed checks.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "BLEEddystoneURL.cpp"
+
+// The only out of line BLEUUID member the Eddystone code uses.
+esp_bt_uuid_t* BLEUUID::getNative() {
+	return &m_uuid;
+} // getNative
+
+static int failures = 0;
+
+#define CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+		failures++; \
+	} \
+} while (0)
+
+
+/**
+ * @brief URLs that encode, with the length of their encoding.
+ */
+static const struct {
+	const char* url;
+	size_t      encodedLength;
+} validURLs[] = {
+	{ "http://www.", 1 },
+	{ "https://www.example.com/", 9 },
+	{ "http://goo.gl/S6zT6P", 14 },
+	{ "https://espressif.com", 11 },
+	{ "http://a.info/b.org", 5 },
+	{ "https://www.abcdefghijklmnopq", 18 },
+	{ "https://x.com/.org/.edu/.net/.info/.biz/.gov/.com.org.edu.net.info.biz.gov", 16 }
+};
+
+
+/**
+ * @brief Every valid URL encodes to the expected length and decodes back to itself.
+ */
+static void testRoundTrip() {
+	for (size_t i = 0; i < sizeof(validURLs) / sizeof(validURLs[0]); i++) {
+		uint8_t encoded[EDDYSTONE_URL_ENCODED_MAX];
+		size_t length = BLEEddystoneURL::encodeURL(validURLs[i].url, encoded, sizeof(encoded));
+		CHECK(length == validURLs[i].encodedLength);
+
+		BLEEddystoneURL beacon;
+		CHECK(beacon.setDecodedURL(validURLs[i].url));
+		CHECK(beacon.getURLLength() == length);
+		CHECK(memcmp(beacon.getURLData(), encoded, length) == 0);
+		CHECK(beacon.getDecodedURL() == validURLs[i].url);
+
+		// Through the frame as it is advertised and received.
+		beacon.setPower(-20);
+		std::string frame = beacon.getData();
+		BLEEddystoneURL received;
+		CHECK(received.parse((const uint8_t*) frame.data(), frame.length()));
+		CHECK(received.getPower() == -20);
+		CHECK(received.getDecodedURL() == validURLs[i].url);
+
+		BLEEddystoneURL copied;
+		copied.setData(frame);
+		CHECK(copied.getData() == frame);
+	}
+} // testRoundTrip
+
+
+/**
+ * @brief URLs without a scheme, with characters that cannot be sent or that do not fit are rejected.
+ */
+static void testRejected() {
+	const char* invalidURLs[] = {
+		"ftp://example.com",
+		"https://exa mple.com",
+		"https://www.abcdefghijklmnopqr",
+		"http://\x7f"
+	};
+	for (size_t i = 0; i < sizeof(invalidURLs) / sizeof(invalidURLs[0]); i++) {
+		uint8_t encoded[EDDYSTONE_URL_ENCODED_MAX];
+		CHECK(BLEEddystoneURL::encodeURL(invalidURLs[i], encoded, sizeof(encoded)) == 0);
+		BLEEddystoneURL beacon;
+		CHECK(!beacon.setDecodedURL(invalidURLs[i]));
+		CHECK(beacon.getURLLength() == 0);
+	}
+
+	// Frames shorter than the header plus scheme or longer than the frame leave the beacon unchanged.
+	BLEEddystoneURL beacon;
+	CHECK(beacon.setDecodedURL("https://www.example.com/"));
+	std::string frame = beacon.getData();
+	const uint8_t shortFrame[] = { EDDYSTONE_URL_FRAME_TYPE, 0 };
+	for (size_t length = 0; length <= sizeof(shortFrame); length++) {
+		CHECK(!beacon.parse(shortFrame, length));
+		beacon.setData(std::string((const char*) shortFrame, length));
+		CHECK(beacon.getData() == frame);
+	}
+	std::string longFrame(21, 'a');
+	longFrame[0] = EDDYSTONE_URL_FRAME_TYPE;
+	CHECK(!beacon.parse((const uint8_t*) longFrame.data(), longFrame.length()));
+	beacon.setData(longFrame);
+	CHECK(beacon.getData() == frame);
+} // testRejected
+
+
+/**
+ * @brief A buffer too small for the decoded URL is filled and terminated and the full length returned.
+ */
+static void testTruncatedDecode() {
+	BLEEddystoneURL beacon;
+	CHECK(beacon.setDecodedURL("https://www.example.com/"));
+	char buffer[8];
+	CHECK(beacon.getDecodedURL(buffer, sizeof(buffer)) == strlen("https://www.example.com/"));
+	CHECK(strcmp(buffer, "https:/") == 0);
+} // testTruncatedDecode
+
+
+/**
+ * @brief Time encoding and decoding, the work of a beacon scanner per received frame.
+ */
+static void testThroughput() {
+	const int rounds = 200000;
+	size_t count = sizeof(validURLs) / sizeof(validURLs[0]);
+	size_t checksum = 0;
+	uint8_t encoded[EDDYSTONE_URL_ENCODED_MAX];
+	char decoded[EDDYSTONE_URL_DECODED_MAX];
+	BLEEddystoneURL beacon;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		checksum += BLEEddystoneURL::encodeURL(validURLs[i % count].url, encoded, sizeof(encoded));
+	}
+	auto encoded_at = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		beacon.setDecodedURL(validURLs[i % count].url);
+		checksum += beacon.getDecodedURL(decoded, sizeof(decoded));
+	}
+	auto decoded_at = std::chrono::steady_clock::now();
+
+	double encodeSeconds = std::chrono::duration<double>(encoded_at - start).count();
+	double roundTripSeconds = std::chrono::duration<double>(decoded_at - encoded_at).count();
+	printf("encodeURL:        %.0f URLs/s\n", rounds / encodeSeconds);
+	printf("encode + decode:  %.0f URLs/s\n", rounds / roundTripSeconds);
+	CHECK(checksum != 0);
+} // testThroughput
+
+
+int main() {
+	testRoundTrip();
+	testRejected();
+	testTruncatedDecode();
+	testThroughput();
+	printf("%s: %d failure(s)\n", failures == 0 ? "PASS" : "FAIL", failures);
+	return failures;
+} // main
@@ -0,0 +1,117 @@
+/*
+ * BLEServerFootprintTest.cpp
+ *
+ *  Host test of BLEServer::getFootprint(): builds a reference attribute database and reports the bytes
+ *  used per attribute.  The figures are for the host ABI (64 bit pointers, host std::string and
+ *  std::vector); on the ESP32 the objects are smaller but the attribute counts and arena use are the same.
+ *
+ *  Build and run from the root of the repository:
+ *
+ *    g++ -std=gnu++11 -O2 -Itest/host/stubs -Isrc test/host/BLEServerFootprintTest.cpp \
+ *      src/BLEServer.cpp src/BLEServiceMap.cpp src/BLEService.cpp src/BLECharacteristic.cpp \
+ *      src/BLECharacteristicMap.cpp src/BLEDescriptor.cpp src/BLEDescriptorMap.cpp src/BLE2902.cpp \
+ *      src/BLEValue.cpp src/BLEUUID.cpp src/BLEAddress.cpp src/FreeRTOS.cpp src/GeneralUtils.cpp \
+ *      -o ble_server_footprint_test
+ *    ./ble_server_footprint_test
+ *
+ *  The exit status is the number of failed checks.
+ */
+#include <stdio.h>
+#include "BLEDevice.h"
+#include "BLEServer.h"
+#include "BLEUtils.h"
+#include "BLE2902.h"
+
+// The only BLEDevice and BLEUtils members the server code links against.  No GAP events are raised on
+// the host so advertising is never restarted.
+BLEServer* BLEDevice::createServer() {
+	return new BLEServer();
+} // createServer
+
+BLEAdvertising* BLEDevice::getAdvertising() {
+	return nullptr;
+} // getAdvertising
+
+void BLEDevice::startAdvertising() {
+} // startAdvertising
+
+std::string BLEUtils::gattStatusToString(esp_gatt_status_t status) {
+	return "";
+} // gattStatusToString
+
+static int failures = 0;
+
+#define CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+		failures++; \
+	} \
+} while (0)
+
+
+/**
+ * @brief An empty server uses nothing.
+ */
+static void testEmpty() {
+	BLEServer* pServer = BLEDevice::createServer();
+	ble_footprint_t footprint = pServer->getFootprint();
+	CHECK(footprint.services == 0);
+	CHECK(footprint.characteristics == 0);
+	CHECK(footprint.descriptors == 0);
+	CHECK(footprint.bytesPerAttribute == 0);
+} // testEmpty
+
+
+/**
+ * @brief A reference database: a sensor with three services, six characteristics of 1 to 20 byte values
+ * and a client configuration descriptor on each notifying characteristic.
+ */
+static void testReference() {
+	BLEServer* pServer = BLEDevice::createServer();
+	uint8_t value[20] = { 0 };
+
+	BLEService* pBattery = pServer->createService(BLEUUID((uint16_t) 0x180f));
+	BLECharacteristic* pLevel = pBattery->createCharacteristic(BLEUUID((uint16_t) 0x2a19),
+		BLECharacteristic::PROPERTY_READ | BLECharacteristic::PROPERTY_NOTIFY);
+	pLevel->addDescriptor(new BLE2902());
+	pLevel->setValue(value, 1);
+
+	BLEService* pInfo = pServer->createService(BLEUUID((uint16_t) 0x180a));
+	pInfo->createCharacteristic(BLEUUID((uint16_t) 0x2a29), BLECharacteristic::PROPERTY_READ)->setValue("Espressif");
+	pInfo->createCharacteristic(BLEUUID((uint16_t) 0x2a24), BLECharacteristic::PROPERTY_READ)->setValue("ESP32-DevKitC");
+	pInfo->createCharacteristic(BLEUUID((uint16_t) 0x2a26), BLECharacteristic::PROPERTY_READ)->setValue("1.0.0");
+
+	BLEService* pData = pServer->createService(BLEUUID("4fafc201-1fb5-459e-8fcc-c5c9c331914b"));
+	BLECharacteristic* pStream = pData->createCharacteristic(BLEUUID("beb5483e-36e1-4688-b7f5-ea07361b26a8"),
+		BLECharacteristic::PROPERTY_NOTIFY);
+	pStream->addDescriptor(new BLE2902());
+	pStream->setValue(value, sizeof(value));
+	BLECharacteristic* pControl = pData->createCharacteristic(BLEUUID("beb5483e-36e1-4688-b7f5-ea07361b26a9"),
+		BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_INDICATE);
+	pControl->addDescriptor(new BLE2902());
+	pControl->setValue(value, 4);
+
+	ble_footprint_t footprint = pServer->getFootprint();
+	CHECK(footprint.services == 3);
+	CHECK(footprint.characteristics == 6);
+	CHECK(footprint.descriptors == 3);
+	CHECK(footprint.totalBytes >= footprint.serviceBytes + footprint.characteristicBytes + footprint.descriptorBytes);
+	CHECK(footprint.bytesPerAttribute == footprint.totalBytes / 12);
+
+	// A service counts the kernel objects of its four event semaphores.
+	CHECK(pBattery->getFootprint() >= sizeof(BLEService) + 4 * sizeof(StaticSemaphore_t));
+
+	printf("services:        %d, %d bytes\n", footprint.services, (int) footprint.serviceBytes);
+	printf("characteristics: %d, %d bytes\n", footprint.characteristics, (int) footprint.characteristicBytes);
+	printf("descriptors:     %d, %d bytes\n", footprint.descriptors, (int) footprint.descriptorBytes);
+	printf("value arena:     %d bytes reserved\n", (int) footprint.arenaReservedBytes);
+	printf("total:           %d bytes, %d bytes per attribute\n", (int) footprint.totalBytes, (int) footprint.bytesPerAttribute);
+} // testReference
+
+
+int main() {
+	testEmpty();
+	testReference();
+	printf("%s: %d failure(s)\n", failures == 0 ? "PASS" : "FAIL", failures);
+	return failures;
+} // main
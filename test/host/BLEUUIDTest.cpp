@@ -0,0 +1,156 @@
+/*
+ * BLEUUIDTest.cpp
+ *
+ *  Host tests of BLEUUID: formatting, canonical comparison, compile time UUIDs, and microbenchmarks
+ *  against the stringstream formatting and string comparison they replaced.
+ *
+ *  Build and run from the root of the repository:
+ *
+ *    g++ -std=gnu++11 -O2 -Itest/host/stubs -Isrc test/host/BLEUUIDTest.cpp -o ble_uuid_test
+ *    ./ble_uuid_test
+ *
+ *  The exit status is the number of failed checks.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include "BLEUUID.cpp"
+
+static int failures = 0;
+
+#define CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+		failures++; \
+	} \
+} while (0)
+
+static constexpr BLEStaticUUID STATIC_SERVICE("4fafc201-1fb5-459e-8fcc-c5c9c331914b");
+static constexpr BLEStaticUUID STATIC_HEART_RATE((uint16_t) 0x180d);
+
+
+/**
+ * @brief The formatting BLEUUID::toString() replaced: stringstream insertions per field.
+ */
+static std::string streamToString(BLEUUID& uuid) {
+	esp_bt_uuid_t* pNative = uuid.getNative();
+	std::stringstream ss;
+	if (pNative->len == ESP_UUID_LEN_16) {
+		ss << "0000" << std::hex << std::setfill('0') << std::setw(4) << pNative->uuid.uuid16 << "-0000-1000-8000-00805f9b34fb";
+		return ss.str();
+	}
+	if (pNative->len == ESP_UUID_LEN_32) {
+		ss << std::hex << std::setfill('0') << std::setw(8) << pNative->uuid.uuid32 << "-0000-1000-8000-00805f9b34fb";
+		return ss.str();
+	}
+	ss << std::hex << std::setfill('0');
+	for (int i = 15; i >= 0; i--) {
+		ss << std::setw(2) << (int) pNative->uuid.uuid128[i];
+		if (i == 12 || i == 10 || i == 8 || i == 6) ss << "-";
+	}
+	return ss.str();
+} // streamToString
+
+
+/**
+ * @brief The comparison BLEUUID::equals() replaced: UUIDs of different lengths compared as strings.
+ */
+static bool stringEquals(BLEUUID& a, BLEUUID& b) {
+	if (a.getNative()->len != b.getNative()->len) return streamToString(a) == streamToString(b);
+	return a.equals(b);
+} // stringEquals
+
+
+/**
+ * @brief UUIDs of every length format as the old code did and equal their 128 bit spellings.
+ */
+static void testCanonical() {
+	BLEUUID short16((uint16_t) 0x180d);
+	BLEUUID short32((uint32_t) 0x0000180d);
+	BLEUUID long128("0000180d-0000-1000-8000-00805f9b34fb");
+	BLEUUID custom("4fafc201-1fb5-459e-8fcc-c5c9c331914b");
+
+	CHECK(short16.toString() == "0000180d-0000-1000-8000-00805f9b34fb");
+	CHECK(short16.toString() == streamToString(short16));
+	CHECK(custom.toString() == streamToString(custom));
+	CHECK(short16 == long128);
+	CHECK(short32 == long128);
+	CHECK(short16 != custom);
+	CHECK(stringEquals(short16, long128));
+	CHECK(std::hash<BLEUUID>()(short16) == std::hash<BLEUUID>()(long128));
+	CHECK((short16 < custom) == (short16.toString() < custom.toString()));
+} // testCanonical
+
+
+/**
+ * @brief Compile time UUIDs match the same UUIDs parsed at run time.
+ */
+static void testStatic() {
+	CHECK(BLEUUID(STATIC_SERVICE) == BLEUUID("4fafc201-1fb5-459e-8fcc-c5c9c331914b"));
+	CHECK(BLEUUID(STATIC_HEART_RATE) == BLEUUID((uint16_t) 0x180d));
+	CHECK(BLEUUID(STATIC_HEART_RATE).getNative()->len == ESP_UUID_LEN_16);
+
+	// A non-literal array is parsed at run time and a malformed one is reported rather than refused.
+	char valid[] = "4fafc201-1fb5-459e-8fcc-c5c9c331914b";
+	CHECK(BLEUUID(BLEStaticUUID(valid)) == BLEUUID(STATIC_SERVICE));
+	char malformed[] = "4fafc201_1fb5-459e-8fcc-c5c9c331914b";
+	CHECK(BLEStaticUUID(malformed).getByte(0) == 0);
+} // testStatic
+
+
+/**
+ * @brief Time formatting and mixed length comparison, old path against new.
+ */
+static void testThroughput() {
+	const int rounds = 200000;
+	size_t checksum = 0;
+	char buffer[BLE_UUID_STRING_LENGTH];
+	BLEUUID short16((uint16_t) 0x180d);
+	BLEUUID long128("0000180d-0000-1000-8000-00805f9b34fb");
+	BLEUUID custom("4fafc201-1fb5-459e-8fcc-c5c9c331914b");
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		checksum += streamToString(custom)[i % 36];
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		checksum += custom.toString()[i % 36];
+	}
+	auto t2 = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		checksum += custom.toString(buffer)[i % 36];
+	}
+	auto t3 = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		checksum += stringEquals(short16, long128);
+	}
+	auto t4 = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		checksum += short16.equals(long128);
+	}
+	auto t5 = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		checksum += std::hash<BLEUUID>()(custom) & 1;
+	}
+	auto t6 = std::chrono::steady_clock::now();
+
+	auto ns = [rounds](std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+		return std::chrono::duration<double, std::nano>(to - from).count() / rounds;
+	};
+	printf("toString 128 bit:     %.0f ns stringstream, %.0f ns string, %.0f ns buffer\n", ns(start, t1), ns(t1, t2), ns(t2, t3));
+	printf("equals 16 vs 128 bit: %.0f ns as strings, %.0f ns canonical\n", ns(t3, t4), ns(t4, t5));
+	printf("hash:                 %.0f ns\n", ns(t5, t6));
+	CHECK(checksum != 0);
+} // testThroughput
+
+
+int main() {
+	testCanonical();
+	testStatic();
+	testThroughput();
+	printf("%s: %d failure(s)\n", failures == 0 ? "PASS" : "FAIL", failures);
+	return failures;
+} // main
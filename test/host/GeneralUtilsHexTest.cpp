@@ -0,0 +1,133 @@
+/*
+ * GeneralUtilsHexTest.cpp
+ *
+ *  Host tests of GeneralUtils::hexEncode(): full and truncated output, and its throughput against the
+ *  sprintf per byte encoding it replaced in BLEUtils::buildHexData().
+ *
+ *  Build and run from the root of the repository:
+ *
+ *    g++ -std=gnu++11 -O2 -Itest/host/stubs -Isrc test/host/GeneralUtilsHexTest.cpp -o general_utils_hex_test
+ *    ./general_utils_hex_test
+ *
+ *  The exit status is the number of failed checks.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include "GeneralUtils.cpp"
+
+static int failures = 0;
+
+#define CHECK(condition) do { \
+	if (!(condition)) { \
+		fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+		failures++; \
+	} \
+} while (0)
+
+
+/**
+ * @brief The encoding hexEncode() replaced: one sprintf per byte into a malloc'd buffer.
+ */
+static char* sprintfEncode(const uint8_t* pData, size_t length) {
+	char* pTarget = (char*) malloc(length * 2 + 1);
+	char* p = pTarget;
+	for (size_t i = 0; i < length; i++, p += 2) {
+		sprintf(p, "%.2x", pData[i]);
+	}
+	*p = 0;
+	return pTarget;
+} // sprintfEncode
+
+
+/**
+ * @brief Every byte value encodes to its two lower case digits.
+ */
+static void testFull() {
+	uint8_t data[256];
+	for (int i = 0; i < 256; i++) data[i] = i;
+	char hex[sizeof(data) * 2 + 1];
+	GeneralUtils::hexEncode(hex, sizeof(hex), data, sizeof(data));
+	char* pExpected = sprintfEncode(data, sizeof(data));
+	CHECK(strcmp(hex, pExpected) == 0);
+	free(pExpected);
+
+	char empty[4] = "xyz";
+	GeneralUtils::hexEncode(empty, sizeof(empty), data, 0);
+	CHECK(empty[0] == 0);
+} // testFull
+
+
+/**
+ * @brief A buffer too small keeps the whole bytes that fit in front of "..." and is always terminated.
+ */
+static void testTruncated() {
+	const uint8_t data[] = { 0xde, 0xad, 0xbe, 0xef, 0x01 };
+	static const struct {
+		size_t      bufferSize;
+		const char* expected;
+	} cases[] = {
+		{ 11, "deadbeef01" },    // Exactly fits.
+		{ 10, "deadbe..." },
+		{ 9,  "dead..." },
+		{ 8,  "dead..." },
+		{ 7,  "de..." },
+		{ 5,  "..." },
+		{ 4,  "..." },
+		{ 3,  "" },              // No room for "...".
+		{ 1,  "" }
+	};
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		char buffer[16];
+		memset(buffer, 'x', sizeof(buffer));
+		GeneralUtils::hexEncode(buffer, cases[i].bufferSize, data, sizeof(data));
+		CHECK(strcmp(buffer, cases[i].expected) == 0);
+		CHECK(strlen(buffer) < cases[i].bufferSize);
+		CHECK(buffer[cases[i].bufferSize] == 'x');       // Nothing written past the buffer.
+	}
+
+	char untouched = 'x';
+	GeneralUtils::hexEncode(&untouched, 0, data, sizeof(data));
+	CHECK(untouched == 'x');
+} // testTruncated
+
+
+/**
+ * @brief Time both encodings over log sized values (20 bytes, a notification at the default MTU).
+ */
+static void testThroughput() {
+	const int rounds = 500000;
+	uint8_t data[20];
+	for (size_t i = 0; i < sizeof(data); i++) data[i] = i * 37;
+	char   hex[sizeof(data) * 2 + 1];
+	size_t checksum = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		data[0] = i;
+		char* pHex = sprintfEncode(data, sizeof(data));
+		checksum += pHex[i % (sizeof(data) * 2)];
+		free(pHex);
+	}
+	auto sprintfDone = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		data[0] = i;
+		checksum += GeneralUtils::hexEncode(hex, sizeof(hex), data, sizeof(data))[i % (sizeof(data) * 2)];
+	}
+	auto tableDone = std::chrono::steady_clock::now();
+
+	double sprintfSeconds = std::chrono::duration<double>(sprintfDone - start).count();
+	double tableSeconds   = std::chrono::duration<double>(tableDone - sprintfDone).count();
+	printf("sprintf + malloc: %.1f MB/s\n", rounds * sizeof(data) / sprintfSeconds / 1e6);
+	printf("hexEncode:        %.1f MB/s (%.1fx)\n", rounds * sizeof(data) / tableSeconds / 1e6, sprintfSeconds / tableSeconds);
+	CHECK(checksum != 0);
+} // testThroughput
+
+
+int main() {
+	testFull();
+	testTruncated();
+	testThroughput();
+	printf("%s: %d failure(s)\n", failures == 0 ? "PASS" : "FAIL", failures);
+	return failures;
+} // main
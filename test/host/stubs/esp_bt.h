@@ -0,0 +1,22 @@
+/*
+ * esp_bt.h
+ *
+ *  Host replacement for the ESP-IDF Bluetooth controller API.
+ */
+#ifndef _HOST_ESP_BT_H_
+#define _HOST_ESP_BT_H_
+#include "esp_err.h"
+
+typedef enum {
+	ESP_PWR_LVL_N12 = 0,
+	ESP_PWR_LVL_P9  = 7
+} esp_power_level_t;
+
+typedef enum {
+	ESP_BLE_PWR_TYPE_ADV     = 9,
+	ESP_BLE_PWR_TYPE_DEFAULT = 12
+} esp_ble_power_type_t;
+
+static inline esp_err_t esp_ble_tx_power_set(esp_ble_power_type_t type, esp_power_level_t level) { return ESP_OK; }
+static inline esp_power_level_t esp_ble_tx_power_get(esp_ble_power_type_t type) { return ESP_PWR_LVL_P9; }
+#endif /* _HOST_ESP_BT_H_ */
@@ -0,0 +1,29 @@
+/*
+ * esp_bt_defs.h
+ *
+ *  Host replacement for the ESP-IDF Bluetooth address and status types.
+ */
+#ifndef _HOST_ESP_BT_DEFS_H_
+#define _HOST_ESP_BT_DEFS_H_
+#include <stdint.h>
+#include "esp_err.h"
+
+#define ESP_BD_ADDR_LEN 6
+typedef uint8_t esp_bd_addr_t[ESP_BD_ADDR_LEN];
+
+typedef enum {
+	BLE_ADDR_TYPE_PUBLIC = 0,
+	BLE_ADDR_TYPE_RANDOM,
+	BLE_ADDR_TYPE_RPA_PUBLIC,
+	BLE_ADDR_TYPE_RPA_RANDOM
+} esp_ble_addr_type_t;
+
+typedef enum {
+	ESP_BT_DEVICE_TYPE_BREDR = 1,
+	ESP_BT_DEVICE_TYPE_BLE,
+	ESP_BT_DEVICE_TYPE_DUMO
+} esp_bt_dev_type_t;
+
+typedef int esp_bt_status_t;
+#define ESP_BT_STATUS_SUCCESS 0
+#endif /* _HOST_ESP_BT_DEFS_H_ */
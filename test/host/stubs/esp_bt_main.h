@@ -0,0 +1,17 @@
+/*
+ * esp_bt_main.h
+ *
+ *  Host replacement for the ESP-IDF Bluedroid stack control.  The stack is never running.
+ */
+#ifndef _HOST_ESP_BT_MAIN_H_
+#define _HOST_ESP_BT_MAIN_H_
+#include "esp_err.h"
+
+typedef enum {
+	ESP_BLUEDROID_STATUS_UNINITIALIZED = 0,
+	ESP_BLUEDROID_STATUS_INITIALIZED,
+	ESP_BLUEDROID_STATUS_ENABLED
+} esp_bluedroid_status_t;
+
+static inline esp_bluedroid_status_t esp_bluedroid_get_status() { return ESP_BLUEDROID_STATUS_UNINITIALIZED; }
+#endif /* _HOST_ESP_BT_MAIN_H_ */
@@ -0,0 +1,115 @@
+/*
+ * esp_gatt_defs.h
+ *
+ *  Host replacement for the ESP-IDF GATT definitions.
+ */
+#ifndef _HOST_ESP_GATT_DEFS_H_
+#define _HOST_ESP_GATT_DEFS_H_
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_bt_defs.h"
+
+#define ESP_UUID_LEN_16  2
+#define ESP_UUID_LEN_32  4
+#define ESP_UUID_LEN_128 16
+
+typedef struct {
+	uint16_t len;
+	union {
+		uint16_t uuid16;
+		uint32_t uuid32;
+		uint8_t  uuid128[ESP_UUID_LEN_128];
+	} uuid;
+} __attribute__((packed)) esp_bt_uuid_t;
+
+typedef struct {
+	esp_bt_uuid_t uuid;
+	uint8_t       inst_id;
+} __attribute__((packed)) esp_gatt_id_t;
+
+typedef struct {
+	esp_gatt_id_t id;
+	bool          is_primary;
+} __attribute__((packed)) esp_gatt_srvc_id_t;
+
+typedef uint8_t  esp_gatt_if_t;
+typedef uint8_t  esp_gatt_char_prop_t;
+typedef uint16_t esp_gatt_perm_t;
+
+#define ESP_GATT_IF_NONE         0xff
+#define ESP_GATT_MAX_ATTR_LEN    600
+#define ESP_GATT_ATTR_HANDLE_MAX 100
+
+#define ESP_GATT_PERM_READ           (1 << 0)
+#define ESP_GATT_PERM_READ_ENCRYPTED (1 << 1)
+#define ESP_GATT_PERM_READ_ENC_MITM  (1 << 2)
+#define ESP_GATT_PERM_WRITE          (1 << 4)
+#define ESP_GATT_PERM_WRITE_ENCRYPTED (1 << 5)
+#define ESP_GATT_PERM_WRITE_ENC_MITM (1 << 6)
+
+#define ESP_GATT_CHAR_PROP_BIT_BROADCAST (1 << 0)
+#define ESP_GATT_CHAR_PROP_BIT_READ      (1 << 1)
+#define ESP_GATT_CHAR_PROP_BIT_WRITE_NR  (1 << 2)
+#define ESP_GATT_CHAR_PROP_BIT_WRITE     (1 << 3)
+#define ESP_GATT_CHAR_PROP_BIT_NOTIFY    (1 << 4)
+#define ESP_GATT_CHAR_PROP_BIT_INDICATE  (1 << 5)
+#define ESP_GATT_CHAR_PROP_BIT_AUTH      (1 << 6)
+#define ESP_GATT_CHAR_PROP_BIT_EXT_PROP  (1 << 7)
+
+#define ESP_GATT_RSP_BY_APP 0
+#define ESP_GATT_AUTO_RSP   1
+
+#define ESP_GATT_PREP_WRITE_CANCEL 0
+#define ESP_GATT_PREP_WRITE_EXEC   1
+
+#define ESP_GATT_UUID_PRI_SERVICE  0x2800
+#define ESP_GATT_UUID_CHAR_DECLARE 0x2803
+
+typedef enum {
+	ESP_GATT_OK             = 0x00,
+	ESP_GATT_INVALID_HANDLE = 0x01,
+	ESP_GATT_INVALID_OFFSET = 0x07,
+	ESP_GATT_NO_RESOURCES   = 0x80,
+	ESP_GATT_BUSY           = 0x84,
+	ESP_GATT_ERROR          = 0x85,
+	ESP_GATT_NOT_FOUND      = 0x8b,
+	ESP_GATT_CONGESTED      = 0x8f,
+	ESP_GATT_OUT_OF_RANGE   = 0x93
+} esp_gatt_status_t;
+
+typedef enum {
+	ESP_GATT_CONN_UNKNOWN = 0
+} esp_gatt_conn_reason_t;
+
+typedef enum {
+	ESP_GATT_AUTH_REQ_NONE = 0
+} esp_gatt_auth_req_t;
+
+typedef enum {
+	ESP_GATT_WRITE_TYPE_NO_RSP = 1,
+	ESP_GATT_WRITE_TYPE_RSP
+} esp_gatt_write_type_t;
+
+typedef struct {
+	uint16_t attr_max_len;
+	uint16_t attr_len;
+	uint8_t* attr_value;
+} esp_attr_value_t;
+
+typedef struct {
+	uint8_t auto_rsp;
+} esp_attr_control_t;
+
+typedef struct {
+	uint8_t  value[ESP_GATT_MAX_ATTR_LEN];
+	uint16_t handle;
+	uint16_t offset;
+	uint16_t len;
+	uint8_t  auth_req;
+} esp_gatt_value_t;
+
+typedef union {
+	esp_gatt_value_t attr_value;
+	uint16_t         handle;
+} esp_gatt_rsp_t;
+#endif /* _HOST_ESP_GATT_DEFS_H_ */
@@ -0,0 +1,35 @@
+/*
+ * esp_gattc_api.h
+ *
+ *  Host replacement for the ESP-IDF GATT client types.  The host tests do not run a client, so the
+ *  event parameters are left incomplete.
+ */
+#ifndef _HOST_ESP_GATTC_API_H_
+#define _HOST_ESP_GATTC_API_H_
+#include <stdint.h>
+#include "esp_gatt_defs.h"
+
+typedef enum {
+	ESP_GATTC_REG_EVT = 0
+} esp_gattc_cb_event_t;
+
+typedef union esp_ble_gattc_cb_param_t esp_ble_gattc_cb_param_t;
+
+typedef struct {
+	bool          is_primary;
+	uint16_t      start_handle;
+	uint16_t      end_handle;
+	esp_bt_uuid_t uuid;
+} esp_gattc_service_elem_t;
+
+typedef struct {
+	uint16_t             char_handle;
+	esp_gatt_char_prop_t properties;
+	esp_bt_uuid_t        uuid;
+} esp_gattc_char_elem_t;
+
+typedef struct {
+	uint16_t      handle;
+	esp_bt_uuid_t uuid;
+} esp_gattc_descr_elem_t;
+#endif /* _HOST_ESP_GATTC_API_H_ */
@@ -0,0 +1,170 @@
+/*
+ * esp_gatts_api.h
+ *
+ *  Host replacement for the ESP-IDF GATT server API.  Every call succeeds and no event is ever raised.
+ */
+#ifndef _HOST_ESP_GATTS_API_H_
+#define _HOST_ESP_GATTS_API_H_
+#include <stdint.h>
+#include "esp_gatt_defs.h"
+
+typedef enum {
+	ESP_GATTS_REG_EVT = 0,
+	ESP_GATTS_READ_EVT,
+	ESP_GATTS_WRITE_EVT,
+	ESP_GATTS_EXEC_WRITE_EVT,
+	ESP_GATTS_MTU_EVT,
+	ESP_GATTS_CONF_EVT,
+	ESP_GATTS_UNREG_EVT,
+	ESP_GATTS_CREATE_EVT,
+	ESP_GATTS_ADD_INCL_SRVC_EVT,
+	ESP_GATTS_ADD_CHAR_EVT,
+	ESP_GATTS_ADD_CHAR_DESCR_EVT,
+	ESP_GATTS_DELETE_EVT,
+	ESP_GATTS_START_EVT,
+	ESP_GATTS_STOP_EVT,
+	ESP_GATTS_CONNECT_EVT,
+	ESP_GATTS_DISCONNECT_EVT,
+	ESP_GATTS_OPEN_EVT,
+	ESP_GATTS_CANCEL_OPEN_EVT,
+	ESP_GATTS_CLOSE_EVT,
+	ESP_GATTS_LISTEN_EVT,
+	ESP_GATTS_CONGEST_EVT,
+	ESP_GATTS_RESPONSE_EVT,
+	ESP_GATTS_CREAT_ATTR_TAB_EVT,
+	ESP_GATTS_SET_ATTR_VAL_EVT
+} esp_gatts_cb_event_t;
+
+typedef union {
+	struct {
+		esp_gatt_status_t status;
+		uint16_t          app_id;
+	} reg;
+	struct {
+		uint16_t      conn_id;
+		uint32_t      trans_id;
+		esp_bd_addr_t bda;
+		uint16_t      handle;
+		uint16_t      offset;
+		bool          is_long;
+		bool          need_rsp;
+	} read;
+	struct {
+		uint16_t      conn_id;
+		uint32_t      trans_id;
+		esp_bd_addr_t bda;
+		uint16_t      handle;
+		uint16_t      offset;
+		bool          need_rsp;
+		bool          is_prep;
+		uint16_t      len;
+		uint8_t*      value;
+	} write;
+	struct {
+		uint16_t      conn_id;
+		uint32_t      trans_id;
+		esp_bd_addr_t bda;
+		uint8_t       exec_write_flag;
+	} exec_write;
+	struct {
+		uint16_t conn_id;
+		uint16_t mtu;
+	} mtu;
+	struct {
+		esp_gatt_status_t status;
+		uint16_t          conn_id;
+		uint16_t          handle;
+		uint16_t          len;
+		uint8_t*          value;
+	} conf;
+	struct {
+		esp_gatt_status_t  status;
+		uint16_t           service_handle;
+		esp_gatt_srvc_id_t service_id;
+	} create;
+	struct {
+		esp_gatt_status_t status;
+		uint16_t          attr_handle;
+		uint16_t          service_handle;
+		esp_bt_uuid_t     char_uuid;
+	} add_char;
+	struct {
+		esp_gatt_status_t status;
+		uint16_t          attr_handle;
+		uint16_t          service_handle;
+		esp_bt_uuid_t     descr_uuid;
+	} add_char_descr;
+	struct {
+		esp_gatt_status_t status;
+		uint16_t          service_handle;
+	} del, start, stop;
+	struct {
+		uint16_t      conn_id;
+		uint8_t       link_role;
+		esp_bd_addr_t remote_bda;
+		struct {
+			uint16_t interval;
+			uint16_t latency;
+			uint16_t timeout;
+		} conn_params;
+	} connect;
+	struct {
+		uint16_t      conn_id;
+		esp_bd_addr_t remote_bda;
+		int           reason;
+	} disconnect;
+	struct {
+		esp_gatt_status_t status;
+	} open;
+	struct {
+		esp_gatt_status_t status;
+		uint16_t          conn_id;
+	} close;
+	struct {
+		uint16_t conn_id;
+		bool     congested;
+	} congest;
+	struct {
+		esp_gatt_status_t status;
+		uint16_t          handle;
+	} rsp;
+	struct {
+		esp_gatt_status_t status;
+		esp_bt_uuid_t     svc_uuid;
+		uint8_t           svc_inst_id;
+		uint16_t          num_handle;
+		uint16_t*         handles;
+	} add_attr_tab;
+} esp_ble_gatts_cb_param_t;
+
+typedef struct {
+	uint16_t uuid_length;
+	uint8_t* uuid_p;
+	uint16_t perm;
+	uint16_t max_length;
+	uint16_t length;
+	uint8_t* value;
+} esp_attr_desc_t;
+
+typedef struct {
+	esp_attr_control_t attr_control;
+	esp_attr_desc_t    att_desc;
+} esp_gatts_attr_db_t;
+
+typedef void (*esp_gatts_cb_t)(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t* param);
+
+static inline esp_err_t esp_ble_gatts_register_callback(esp_gatts_cb_t callback) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_app_register(uint16_t appId) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_app_unregister(esp_gatt_if_t gatts_if) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_create_service(esp_gatt_if_t gatts_if, esp_gatt_srvc_id_t* pServiceId, uint16_t numHandles) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_create_attr_tab(const esp_gatts_attr_db_t* pTable, esp_gatt_if_t gatts_if, uint8_t count, uint8_t instId) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_add_char(uint16_t serviceHandle, esp_bt_uuid_t* pUUID, esp_gatt_perm_t perm, esp_gatt_char_prop_t properties, esp_attr_value_t* pValue, esp_attr_control_t* pControl) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_add_char_descr(uint16_t serviceHandle, esp_bt_uuid_t* pUUID, esp_gatt_perm_t perm, esp_attr_value_t* pValue, esp_attr_control_t* pControl) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_delete_service(uint16_t serviceHandle) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_start_service(uint16_t serviceHandle) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_stop_service(uint16_t serviceHandle) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_send_indicate(esp_gatt_if_t gatts_if, uint16_t connId, uint16_t handle, uint16_t length, uint8_t* pValue, bool confirm) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_send_response(esp_gatt_if_t gatts_if, uint16_t connId, uint32_t transId, esp_gatt_status_t status, esp_gatt_rsp_t* pRsp) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_open(esp_gatt_if_t gatts_if, esp_bd_addr_t address, bool direct) { return ESP_OK; }
+static inline esp_err_t esp_ble_gatts_close(esp_gatt_if_t gatts_if, uint16_t connId) { return ESP_OK; }
+#endif /* _HOST_ESP_GATTS_API_H_ */
@@ -0,0 +1,11 @@
+/*
+ * esp_heap_caps.h
+ *
+ *  Host replacement for the ESP-IDF heap capabilities.
+ */
+#ifndef _HOST_ESP_HEAP_CAPS_H_
+#define _HOST_ESP_HEAP_CAPS_H_
+#include <stddef.h>
+#define MALLOC_CAP_8BIT 4
+static inline size_t heap_caps_get_free_size(uint32_t caps) { return 0; }
+#endif /* _HOST_ESP_HEAP_CAPS_H_ */
@@ -0,0 +1,14 @@
+/*
+ * esp_log.h
+ *
+ *  Host replacement for the ESP-IDF logging macros: errors and warnings go to stderr.
+ */
+#ifndef _HOST_ESP_LOG_H_
+#define _HOST_ESP_LOG_H_
+#include <stdio.h>
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)
+#define ESP_LOGD(tag, format, ...)
+#define ESP_LOGV(tag, format, ...)
+#endif /* _HOST_ESP_LOG_H_ */
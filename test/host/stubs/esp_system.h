@@ -0,0 +1,18 @@
+/*
+ * esp_system.h
+ *
+ *  Host replacement for the ESP-IDF system information calls.
+ */
+#ifndef _HOST_ESP_SYSTEM_H_
+#define _HOST_ESP_SYSTEM_H_
+#include <string.h>
+#include "esp_err.h"
+typedef struct {
+	int model;
+	int features;
+	int cores;
+	int revision;
+} esp_chip_info_t;
+static inline void esp_chip_info(esp_chip_info_t* pInfo) { memset(pInfo, 0, sizeof(*pInfo)); }
+static inline const char* esp_get_idf_version() { return "host"; }
+#endif /* _HOST_ESP_SYSTEM_H_ */
@@ -0,0 +1,13 @@
+/*
+ * esp_timer.h
+ *
+ *  Host replacement for the ESP-IDF high resolution timer.
+ */
+#ifndef _HOST_ESP_TIMER_H_
+#define _HOST_ESP_TIMER_H_
+#include <stdint.h>
+#include <chrono>
+static inline int64_t esp_timer_get_time() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif /* _HOST_ESP_TIMER_H_ */
@@ -0,0 +1,9 @@
+/*
+ * esp_wifi.h
+ *
+ *  Host replacement for the WiFi reason codes.
+ */
+#ifndef _HOST_ESP_WIFI_H_
+#define _HOST_ESP_WIFI_H_
+typedef int wifi_err_reason_t;
+#endif /* _HOST_ESP_WIFI_H_ */
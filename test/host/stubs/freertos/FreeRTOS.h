@@ -0,0 +1,31 @@
+/*
+ * freertos/FreeRTOS.h
+ *
+ *  Host replacement for the FreeRTOS types.  The host tests are single threaded, so critical sections
+ *  do nothing.
+ */
+#ifndef _HOST_FREERTOS_H_
+#define _HOST_FREERTOS_H_
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>   // Pulled in by FreeRTOSConfig.h on the ESP32.
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+#define pdTRUE             1
+#define pdFALSE            0
+#define pdPASS             1
+#define pdFAIL             0
+#define portMAX_DELAY      0xffffffff
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms)  (ms)
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(pMux) (void) (pMux)
+#define portEXIT_CRITICAL(pMux)  (void) (pMux)
+
+typedef struct {
+	uint8_t storage[80];
+} StaticSemaphore_t;
+#endif /* _HOST_FREERTOS_H_ */
@@ -0,0 +1,20 @@
+/*
+ * freertos/ringbuf.h
+ *
+ *  Host replacement for the ESP-IDF ring buffer API.  Ring buffers cannot be created on the host.
+ */
+#ifndef _HOST_FREERTOS_RINGBUF_H_
+#define _HOST_FREERTOS_RINGBUF_H_
+#include "FreeRTOS.h"
+typedef void* RingbufHandle_t;
+typedef enum {
+	RINGBUF_TYPE_NOSPLIT,
+	RINGBUF_TYPE_ALLOWSPLIT,
+	RINGBUF_TYPE_BYTEBUF
+} ringbuf_type_t;
+static inline RingbufHandle_t xRingbufferCreate(size_t length, ringbuf_type_t type) { return nullptr; }
+static inline void vRingbufferDelete(RingbufHandle_t ringbuf) {}
+static inline BaseType_t xRingbufferSend(RingbufHandle_t ringbuf, const void* pItem, size_t length, TickType_t wait) { return pdFALSE; }
+static inline void* xRingbufferReceive(RingbufHandle_t ringbuf, size_t* pLength, TickType_t wait) { return nullptr; }
+static inline void vRingbufferReturnItem(RingbufHandle_t ringbuf, void* pItem) {}
+#endif /* _HOST_FREERTOS_RINGBUF_H_ */
@@ -0,0 +1,15 @@
+/*
+ * freertos/semphr.h
+ *
+ *  Host replacement for the FreeRTOS semaphore API.  Semaphores are always available.
+ */
+#ifndef _HOST_FREERTOS_SEMPHR_H_
+#define _HOST_FREERTOS_SEMPHR_H_
+#include "FreeRTOS.h"
+typedef void* SemaphoreHandle_t;
+static inline SemaphoreHandle_t xSemaphoreCreateMutex() { static int mutex; return &mutex; }
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait) { return pdTRUE; }
+static inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) { return pdTRUE; }
+static inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* pWoken) { return pdTRUE; }
+static inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) {}
+#endif /* _HOST_FREERTOS_SEMPHR_H_ */
@@ -0,0 +1,17 @@
+/*
+ * freertos/task.h
+ *
+ *  Host replacement for the FreeRTOS task API.
+ */
+#ifndef _HOST_FREERTOS_TASK_H_
+#define _HOST_FREERTOS_TASK_H_
+#include "FreeRTOS.h"
+typedef void* TaskHandle_t;
+static inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+static inline void vTaskDelay(TickType_t ticks) {}
+static inline void vTaskDelete(TaskHandle_t task) {}
+static inline TickType_t xTaskGetTickCount() { return 0; }
+static inline BaseType_t xTaskCreate(void (*task)(void*), const char* name, uint32_t stackSize, void* param, UBaseType_t priority, TaskHandle_t* pTask) {
+	return pdFAIL;   // No tasks on the host.
+}
+#endif /* _HOST_FREERTOS_TASK_H_ */
@@ -0,0 +1,18 @@
+/*
+ * freertos/timers.h
+ *
+ *  Host replacement for the FreeRTOS software timer API.  Timers are created but never fire.
+ */
+#ifndef _HOST_FREERTOS_TIMERS_H_
+#define _HOST_FREERTOS_TIMERS_H_
+#include "FreeRTOS.h"
+typedef void* TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+static inline TimerHandle_t xTimerCreate(const char* name, TickType_t period, UBaseType_t autoReload, void* pId, TimerCallbackFunction_t callback) { return pId; }
+static inline void* pvTimerGetTimerID(TimerHandle_t timer) { return timer; }
+static inline BaseType_t xTimerStart(TimerHandle_t timer, TickType_t wait) { return pdPASS; }
+static inline BaseType_t xTimerStop(TimerHandle_t timer, TickType_t wait) { return pdPASS; }
+static inline BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t wait) { return pdPASS; }
+static inline BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t wait) { return pdPASS; }
+static inline BaseType_t xTimerIsTimerActive(TimerHandle_t timer) { return pdFALSE; }
+#endif /* _HOST_FREERTOS_TIMERS_H_ */
@@ -0,0 +1,8 @@
+/*
+ * nvs.h
+ *
+ *  Host replacement for the NVS API; nothing of it is used on the host.
+ */
+#ifndef _HOST_NVS_H_
+#define _HOST_NVS_H_
+#endif /* _HOST_NVS_H_ */
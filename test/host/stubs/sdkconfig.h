@@ -0,0 +1,9 @@
+/*
+ * sdkconfig.h
+ *
+ *  Host build configuration for the library tests.
+ */
+#ifndef _HOST_SDKCONFIG_H_
+#define _HOST_SDKCONFIG_H_
+#define CONFIG_BT_ENABLED 1
+#endif /* _HOST_SDKCONFIG_H_ */